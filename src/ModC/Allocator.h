@@ -4,10 +4,40 @@
 /* Docs
 Define `ALLOCATOR_NO_CANARY` to disable canary checks
 
+Arena allocators always allocate from the tip arena in the chain. Use `Allocator_Mark()` to save 
+the tip position and `Allocator_Rewind()` to roll back everything allocated after it in O(1). 
+`Allocator_Reset()` rolls back everything. These are no-op for heap allocators.
+
+Thread arena allocators are for allocating from multiple threads. Create one `ThreadArenaPool` 
+with `CreateThreadArenaPool()` and then one thread arena allocator per thread with 
+`CreateThreadArenaAllocator()`. Each thread arena bump allocates from its own chunk and takes new 
+chunks from the pool without locking. Destroying a thread arena returns its chunks to the pool and 
+destroying the pool frees all chunks. Requires GCC/Clang `__atomic` builtins.
+
+Custom allocators forward to the functions in an `AllocatorVTable`. Fill in a `CustomAllocator` 
+which must outlive the allocator and pass it to `CreateCustomAllocator()`. Only custom allocators 
+go through the function pointers, the built-in ones are still dispatched inline.
+
+Virtual arena allocators reserve one large address range up front with `CreateVirtualArenaAllocator()` 
+and commit pages as they are used, so they never chain and the latest allocation can always be 
+reallocated in place. Pass `true` for `hugePages` to align and commit in 2MB steps and hint 
+transparent huge pages. Requires `mmap()` with `MAP_ANONYMOUS`, which glibc only declares with 
+`_DEFAULT_SOURCE` or `_GNU_SOURCE`. Otherwise, or with `ALLOCATOR_NO_VIRTUAL_ARENA` defined, creating 
+one returns an invalid allocator.
+
+`Allocator_MallocAligned()` works with any allocator and returns memory aligned to a power of 2, 
+followed by `ALLOCATOR_ALIGNED_TAIL_PADDING` zeroed bytes so vector loads can read past the end. 
+Use `Allocator_ReallocAligned()` and `Allocator_FreeAligned()` with it.
+
+Define `ALLOCATOR_PROFILE` to 1 to record allocation stats, see AllocatorProfile.h.
+Define `ALLOCATOR_TRACE` to 1 to record every allocator call into a log, see AllocatorTrace.h.
+
 Just read the code
 */
 
 #include "ModC/Assert.h"
+#include "ModC/AllocatorProfile.h"
+#include "ModC/AllocatorTrace.h"
 
 #include "static_assert.h/assert.h"
 #include "arena-allocator/arena.h"
@@ -19,13 +49,39 @@ Just read the code
 #include <string.h>
 #include <stdbool.h>
 
+#if !defined(ALLOCATOR_NO_VIRTUAL_ARENA) && (defined(__unix__) || defined(__APPLE__))
+    #include <sys/mman.h>
+    #include <unistd.h>
+    
+    #if defined(MAP_ANONYMOUS) || defined(MAP_ANON)
+        #define INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA 1
+        
+        #if !defined(MAP_ANONYMOUS)
+            #define MAP_ANONYMOUS MAP_ANON
+        #endif
+        #if !defined(MAP_NORESERVE)
+            #define MAP_NORESERVE 0
+        #endif
+    #endif
+#endif
+
+#ifndef INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA
+    #define INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA 0
+#endif
+
 typedef enum AllocatorType
 {
     AllocatorType_Invalid,
     AllocatorType_Heap,
     AllocatorType_SharedArena,
     AllocatorType_OwnedArena,
-    AllocatorType_Count,   //4
+    AllocatorType_SharedThreadArena,
+    AllocatorType_OwnedThreadArena,
+    AllocatorType_SharedCustom,
+    AllocatorType_OwnedCustom,
+    AllocatorType_SharedVirtualArena,
+    AllocatorType_OwnedVirtualArena,
+    AllocatorType_Count,   //10
 } AllocatorType;
 
 typedef struct Allocator
@@ -34,6 +90,20 @@ typedef struct Allocator
     void* Allocator;
 } Allocator;
 
+typedef struct AllocatorVTable
+{
+    void* (*Malloc)(void* userData, uint64_t size);
+    void* (*Realloc)(void* userData, void* data, uint64_t size);
+    void (*Free)(void* userData, void* data);
+    void (*Destroy)(void* userData);                    //Optional
+} AllocatorVTable;
+
+typedef struct CustomAllocator
+{
+    const AllocatorVTable* VTable;
+    void* UserData;
+} CustomAllocator;
+
 struct ArenaWrapper;
 
 typedef struct ArenaWrapper
@@ -41,8 +111,74 @@ typedef struct ArenaWrapper
     Arena* CurrentArena;
     struct ArenaWrapper* NextArena;
     struct ArenaWrapper* PrevArena;
+    
+    //Only used by the first arena wrapper. The arena wrapper we are allocating from, NULL if first.
+    struct ArenaWrapper* TipArena;
+    
+    #if ALLOCATOR_PROFILE
+        AllocatorStats* Stats;                  //Only used by the first arena wrapper
+    #endif
 } ArenaWrapper;
 
+struct ThreadArenaChunk;
+
+typedef struct ThreadArenaChunk
+{
+    struct ThreadArenaChunk* NextAllocated;     //All chunks allocated by the pool, push only
+    struct ThreadArenaChunk* Next;              //Next chunk in the pool or in a thread arena
+    uint64_t Size;                              //Usable bytes after this header
+    uint64_t Index;
+} ThreadArenaChunk;
+
+typedef struct ThreadArenaPool
+{
+    uint64_t ChunkSize;
+    ThreadArenaChunk* FreeChunks;               //Atomic
+    ThreadArenaChunk* AllocatedChunks;          //Atomic
+} ThreadArenaPool;
+
+//Lives at the start of its first chunk, only accessed by the owning thread
+typedef struct ThreadArena
+{
+    ThreadArenaPool* Pool;
+    ThreadArenaChunk* FirstChunk;
+    ThreadArenaChunk* CurrentChunk;             //Chunks in use, linked from the latest to the first
+    ThreadArenaChunk* SpareChunks;
+    
+    #if ALLOCATOR_PROFILE
+        AllocatorStats* Stats;
+    #endif
+} ThreadArena;
+
+//Lives at the start of its own reserved range
+typedef struct VirtualArena
+{
+    char* Region;
+    uint64_t ReservedSize;
+    uint64_t CommittedSize;                     //Always a multiple of `CommitGranularity`
+    uint64_t CommitGranularity;
+    uint64_t Index;
+    
+    #if ALLOCATOR_PROFILE
+        AllocatorStats* Stats;
+    #endif
+} VirtualArena;
+
+typedef struct AllocatorMark
+{
+    ArenaWrapper* TipArena;
+    ThreadArenaChunk* TipChunk;
+    uint64_t TipIndex;
+    
+    #if ALLOCATOR_PROFILE
+        uint64_t UsedBytes;
+    #endif
+    
+    #if ALLOCATOR_TRACE
+        uint64_t TraceMark;                     //0 if not recorded
+    #endif
+} AllocatorMark;
+
 
 
 
@@ -78,7 +214,8 @@ typedef union
 } PtrOrSize;
 
 #if ALLOCATOR_NO_CANARY
-    #define FrontCanarySize() 0
+    //Only the allocation size is stored in front
+    #define FrontCanarySize() sizeof(uint64_t)
     #define BackCanarySize() 0
 #else
     #define FrontCanarySize() ((sizeof("cana") - 1) + sizeof(uint64_t) + (sizeof("ries") - 1))
@@ -93,7 +230,7 @@ static inline PtrOrSize SetupCanariesAndSize(void* allocPtr, uint64_t allocSize)
     {
         if(!allocPtr)
             return (PtrOrSize){ .Size = allocSize + sizeof(uint64_t) };
-    
+        
         static_assert(sizeof(char) == 1, "");
         memcpy(allocPtr, &allocSize, sizeof(allocSize));
         allocPtr = (char*)allocPtr + 8;
@@ -136,6 +273,7 @@ static inline PtrOrSize SetupCanariesAndSize(void* allocPtr, uint64_t allocSize)
 static inline bool CheckFrontCanary(void* allocPtr)
 {
     #if ALLOCATOR_NO_CANARY
+        (void)allocPtr;
         return true;
     #else
         char* canaryPtr = allocPtr;
@@ -150,7 +288,11 @@ static inline bool CheckFrontCanary(void* allocPtr)
 
 static inline uint64_t GetAllocSize(void* allocPtr)
 {
-    allocPtr = (char*)allocPtr - (sizeof("ries") - 1) - sizeof(uint64_t);
+    #if ALLOCATOR_NO_CANARY
+        allocPtr = (char*)allocPtr - sizeof(uint64_t);
+    #else
+        allocPtr = (char*)allocPtr - (sizeof("ries") - 1) - sizeof(uint64_t);
+    #endif
     uint64_t retSize = 0;
     memcpy(&retSize, allocPtr, sizeof(uint64_t));
     return retSize;
@@ -159,6 +301,8 @@ static inline uint64_t GetAllocSize(void* allocPtr)
 static inline bool CheckBackCanary(void* allocPtr, uint64_t allocSize)
 {
     #if ALLOCATOR_NO_CANARY
+        (void)allocPtr;
+        (void)allocSize;
         return true;
     #else
         char* canaryPtr = allocPtr;
@@ -169,18 +313,307 @@ static inline bool CheckBackCanary(void* allocPtr, uint64_t allocSize)
 
 static inline Allocator CreateArenaAllocator(uint64_t allocateSize);
 
-static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
+//Arena wrappers are always allocated at the start of their own arena, so the usable space begins 
+//right after it.
+static inline uint64_t ArenaWrapper_EmptyIndex(const ArenaWrapper* this)
+{
+    return (uint64_t)((const char*)this + sizeof(ArenaWrapper) - this->CurrentArena->region);
+}
+
+#define THREAD_ARENA_ALIGNMENT 16
+
+static inline void* ThreadArenaChunk_Alloc(ThreadArenaChunk* this, uint64_t size)
+{
+    static_assert(sizeof(ThreadArenaChunk) % THREAD_ARENA_ALIGNMENT == 0, "");
+    if(!this)
+        return NULL;
+    
+    uint64_t alignedIndex = (this->Index + THREAD_ARENA_ALIGNMENT - 1) & 
+                            ~(uint64_t)(THREAD_ARENA_ALIGNMENT - 1);
+    if(alignedIndex > this->Size || this->Size - alignedIndex < size)
+        return NULL;
+    
+    this->Index = alignedIndex + size;
+    return (char*)(this + 1) + alignedIndex;
+}
+
+//Pushes the linked chunks from `firstChunk` to `lastChunk` back to the pool
+static inline void ThreadArenaPool_ReleaseChunks(   ThreadArenaPool* this, 
+                                                    ThreadArenaChunk* firstChunk, 
+                                                    ThreadArenaChunk* lastChunk)
+{
+    if(!this || !firstChunk || !lastChunk)
+        return;
+    
+    lastChunk->Next = __atomic_load_n(&this->FreeChunks, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n( &this->FreeChunks, 
+                                        &lastChunk->Next, 
+                                        firstChunk, 
+                                        true, 
+                                        __ATOMIC_RELEASE, 
+                                        __ATOMIC_RELAXED))
+    {
+    }
+}
+
+//Unlinks and returns the first chunk with at least `minSize` usable bytes from `inOutChunks`
+static inline ThreadArenaChunk* ThreadArenaPool_InternTakeChunk(ThreadArenaChunk** inOutChunks, 
+                                                                uint64_t minSize)
+{
+    ThreadArenaChunk** prevNext = inOutChunks;
+    for(ThreadArenaChunk* chunk = *inOutChunks; chunk; chunk = chunk->Next)
+    {
+        if(chunk->Size >= minSize)
+        {
+            *prevNext = chunk->Next;
+            chunk->Next = NULL;
+            chunk->Index = 0;
+            return chunk;
+        }
+        prevNext = &chunk->Next;
+    }
+    return NULL;
+}
+
+//Gets a chunk with at least `minSize` usable bytes from `inOutSpareChunks`, then the pool, 
+//then the heap
+static inline ThreadArenaChunk* ThreadArenaPool_AcquireChunk(   ThreadArenaPool* this, 
+                                                                ThreadArenaChunk** inOutSpareChunks,
+                                                                uint64_t minSize)
+{
+    if(!this || !inOutSpareChunks)
+        return NULL;
+    
+    ThreadArenaChunk* spareChunk = ThreadArenaPool_InternTakeChunk(inOutSpareChunks, minSize);
+    if(spareChunk)
+        return spareChunk;
+    
+    //Take all the free chunks in the pool at once since popping single chunks is prone to ABA, 
+    //then push back the ones we don't need so other threads can still use them
+    ThreadArenaChunk* freeChunks = __atomic_exchange_n(&this->FreeChunks, NULL, __ATOMIC_ACQUIRE);
+    ThreadArenaChunk* freeChunk = ThreadArenaPool_InternTakeChunk(&freeChunks, minSize);
+    if(freeChunks)
+    {
+        ThreadArenaChunk* lastFreeChunk = freeChunks;
+        while(lastFreeChunk->Next)
+            lastFreeChunk = lastFreeChunk->Next;
+        ThreadArenaPool_ReleaseChunks(this, freeChunks, lastFreeChunk);
+    }
+    if(freeChunk)
+        return freeChunk;
+    
+    uint64_t chunkSize = minSize > this->ChunkSize ? minSize : this->ChunkSize;
+    if(UINT64_MAX - sizeof(ThreadArenaChunk) < chunkSize)
+        return NULL;
+    
+    ThreadArenaChunk* chunk = malloc(sizeof(ThreadArenaChunk) + chunkSize);
+    if(!chunk)
+        return NULL;
+    
+    *chunk = (ThreadArenaChunk){ .Size = chunkSize };
+    INTERN_PRINT_PRINT_TRACE("Created chunk %p with size %" PRIu64 "\n", (void*)chunk, chunkSize);
+    
+    chunk->NextAllocated = __atomic_load_n(&this->AllocatedChunks, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n( &this->AllocatedChunks, 
+                                        &chunk->NextAllocated, 
+                                        chunk, 
+                                        true, 
+                                        __ATOMIC_RELEASE, 
+                                        __ATOMIC_RELAXED))
+    {
+    }
+    return chunk;
+}
+
+#define VIRTUAL_ARENA_ALIGNMENT 16
+#define VIRTUAL_ARENA_HUGE_PAGE_SIZE ((uint64_t)2 * 1024 * 1024)
+
+static inline uint64_t VirtualArena_EmptyIndex(void)
+{
+    return  ((uint64_t)sizeof(VirtualArena) + VIRTUAL_ARENA_ALIGNMENT - 1) & 
+            ~(uint64_t)(VIRTUAL_ARENA_ALIGNMENT - 1);
+}
+
+//Makes sure everything before `endIndex` is committed
+static inline bool VirtualArena_Commit(VirtualArena* this, uint64_t endIndex)
+{
+    if(endIndex <= this->CommittedSize)
+        return true;
+    if(endIndex > this->ReservedSize)
+        return false;
+    
+    uint64_t newCommittedSize = (endIndex + this->CommitGranularity - 1) / this->CommitGranularity * 
+                                this->CommitGranularity;
+    if(newCommittedSize > this->ReservedSize)
+        newCommittedSize = this->ReservedSize;
+    
+    #if INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA
+        if(mprotect(this->Region + this->CommittedSize, 
+                    newCommittedSize - this->CommittedSize, 
+                    PROT_READ | PROT_WRITE) != 0)
+        {
+            INTERN_PRINT_PRINT_TRACE("Failed to commit %" PRIu64 " bytes\n", newCommittedSize);
+            return false;
+        }
+    #else
+        return false;
+    #endif
+    
+    #if ALLOCATOR_PROFILE
+        AllocatorStats_OnCommit(this->Stats, newCommittedSize - this->CommittedSize);
+    #endif
+    this->CommittedSize = newCommittedSize;
+    return true;
+}
+
+static inline void* VirtualArena_Alloc(VirtualArena* this, uint64_t size)
+{
+    uint64_t alignedIndex = (this->Index + VIRTUAL_ARENA_ALIGNMENT - 1) & 
+                            ~(uint64_t)(VIRTUAL_ARENA_ALIGNMENT - 1);
+    if( alignedIndex > this->ReservedSize || 
+        this->ReservedSize - alignedIndex < size ||
+        !VirtualArena_Commit(this, alignedIndex + size))
+    {
+        return NULL;
+    }
+    
+    this->Index = alignedIndex + size;
+    return this->Region + alignedIndex;
+}
+
+#if ALLOCATOR_PROFILE
+    //Heap allocations are prefixed with their size so that we can track the used bytes
+    #define INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE 16
+#endif
+
+//Returns NULL if profiling is disabled. Arenas are registered on first use so that the child arenas 
+//don't get their own records.
+static inline AllocatorStats* Allocator_InternGetStats(const Allocator* this)
+{
+    #if ALLOCATOR_PROFILE
+        if(!this)
+            return NULL;
+        
+        static_assert((int)AllocatorType_Count == 10, "");
+        switch(this->Type)
+        {
+            case AllocatorType_Heap:
+                return &AllocatorProfile_HeapRecord;
+            case AllocatorType_SharedArena:
+            case AllocatorType_OwnedArena:
+            {
+                ArenaWrapper* headWrapper = this->Allocator;
+                if(!headWrapper)
+                    return NULL;
+                if(!headWrapper->Stats)
+                {
+                    headWrapper->Stats = AllocatorProfile_CreateRecord(NULL);
+                    for(ArenaWrapper* wrapper = headWrapper; wrapper; wrapper = wrapper->NextArena)
+                        AllocatorStats_OnNewChain(headWrapper->Stats, wrapper->CurrentArena->size);
+                }
+                return headWrapper->Stats;
+            }
+            case AllocatorType_SharedThreadArena:
+            case AllocatorType_OwnedThreadArena:
+                return this->Allocator ? ((ThreadArena*)this->Allocator)->Stats : NULL;
+            case AllocatorType_SharedCustom:
+            case AllocatorType_OwnedCustom:
+                return &AllocatorProfile_CustomRecord;
+            case AllocatorType_SharedVirtualArena:
+            case AllocatorType_OwnedVirtualArena:
+                return this->Allocator ? ((VirtualArena*)this->Allocator)->Stats : NULL;
+            default:
+                return NULL;
+        }
+    #else
+        (void)this;
+        return NULL;
+    #endif
+}
+
+//Records a call to this allocator if built with `ALLOCATOR_TRACE` and recording. `value` is the 
+//size or the mark number, see `AllocatorTrace_Record()`. Returns the mark number for Mark.
+static inline uint64_t Allocator_InternTrace(   const Allocator* this, 
+                                                AllocatorTraceKind kind, 
+                                                uint64_t value, 
+                                                const void* address, 
+                                                const void* newAddress)
+{
+    #if ALLOCATOR_TRACE
+        if(!this || !AllocatorTrace_IsRecording())
+            return 0;
+        
+        //What a similar allocator would be created with when replaying
+        uint64_t configSize = 0;
+        static_assert((int)AllocatorType_Count == 10, "");
+        switch(this->Type)
+        {
+            case AllocatorType_SharedArena:
+            case AllocatorType_OwnedArena:
+            {
+                ArenaWrapper* headWrapper = this->Allocator;
+                if(headWrapper && headWrapper->CurrentArena)
+                {
+                    configSize =    headWrapper->CurrentArena->size - 
+                                    ArenaWrapper_EmptyIndex(headWrapper);
+                }
+                break;
+            }
+            case AllocatorType_SharedThreadArena:
+            case AllocatorType_OwnedThreadArena:
+                configSize = this->Allocator ? ((ThreadArena*)this->Allocator)->Pool->ChunkSize : 0;
+                break;
+            case AllocatorType_SharedVirtualArena:
+            case AllocatorType_OwnedVirtualArena:
+                configSize = this->Allocator ? ((VirtualArena*)this->Allocator)->ReservedSize : 0;
+                break;
+            default:
+                break;
+        }
+        
+        return AllocatorTrace_Record(   kind, 
+                                        this->Allocator, 
+                                        (uint32_t)this->Type, 
+                                        configSize, 
+                                        value, 
+                                        address, 
+                                        newAddress);
+    #else
+        (void)this;
+        (void)kind;
+        (void)value;
+        (void)address;
+        (void)newAddress;
+        return 0;
+    #endif
+}
+
+//Not counted as an allocation or traced, `Allocator_Realloc()` uses it for its new allocation
+static inline void* Allocator_InternMalloc(const Allocator* this, uint64_t size)
 {
     void* retPtr = NULL;
     if(!this)
         goto ret;
     
-    static_assert((int)AllocatorType_Count == 4, "");
+    static_assert((int)AllocatorType_Count == 10, "");
     switch(this->Type)
     {
         case AllocatorType_Heap:
-            retPtr = malloc(size);
+        {
+            #if ALLOCATOR_PROFILE
+                if(UINT64_MAX - INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE < size)
+                    break;
+                uint64_t* header = malloc(size + INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE);
+                if(!header)
+                    break;
+                *header = size;
+                retPtr = (char*)header + INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE;
+                AllocatorStats_AddUsedBytes(&AllocatorProfile_HeapRecord, (int64_t)size);
+            #else
+                retPtr = malloc(size);
+            #endif
             break;
+        }
         case AllocatorType_SharedArena:
         case AllocatorType_OwnedArena:
         {
@@ -190,22 +623,28 @@ static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
                 goto ret;
             }
             
-            ArenaWrapper* arenaWrapper = this->Allocator;
+            ArenaWrapper* headWrapper = this->Allocator;
+            ArenaWrapper* arenaWrapper = headWrapper->TipArena ? headWrapper->TipArena : headWrapper;
             if(!arenaWrapper->CurrentArena)
             {
                 INTERN_PRINT_PRINT_TRACE("Trying to allocate with NULL arena\n");
                 goto ret;
             }
             
+            AllocatorStats* stats = Allocator_InternGetStats(this);
+            
             uint64_t minRequiredSize = SetupCanariesAndSize(NULL, size).Size;
             retPtr = arena_alloc(arenaWrapper->CurrentArena, minRequiredSize);
             
             //If we failed to allocate in the current arena, use/create next arena
             while(!retPtr)
             {
-                //Go to next arena
+                //Go to next arena. Anything after the tip arena is rewound, so reuse it as empty.
                 if(arenaWrapper->NextArena)
+                {
                     arenaWrapper = arenaWrapper->NextArena;
+                    arenaWrapper->CurrentArena->index = ArenaWrapper_EmptyIndex(arenaWrapper);
+                }
                 //Try create next arena
                 else
                 {
@@ -228,6 +667,8 @@ static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
                     if(!arenaWrapper->NextArena)
                         goto ret;
                     
+                    AllocatorStats_OnNewChain(stats, arenaWrapper->NextArena->CurrentArena->size);
+                    
                     //Set the previous arena entry for the next arena to this, and go to it
                     arenaWrapper->NextArena->PrevArena = arenaWrapper;
                     arenaWrapper = arenaWrapper->NextArena;
@@ -240,8 +681,70 @@ static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
                 retPtr = arena_alloc(arenaWrapper->CurrentArena, minRequiredSize);
             }
             
+            headWrapper->TipArena = arenaWrapper;
             retPtr = SetupCanariesAndSize(retPtr, size).Ptr;
+            AllocatorStats_AddUsedBytes(stats, (int64_t)minRequiredSize);
+            break;
         } //case AllocatorType_OwnedArena:
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
+        {
+            if(!this->Allocator)
+            {
+                INTERN_PRINT_PRINT_TRACE("Trying to allocate with NULL thread arena\n");
+                goto ret;
+            }
+            
+            ThreadArena* threadArena = this->Allocator;
+            uint64_t minRequiredSize = SetupCanariesAndSize(NULL, size).Size;
+            retPtr = ThreadArenaChunk_Alloc(threadArena->CurrentChunk, minRequiredSize);
+            
+            //Current chunk is full, get another one
+            if(!retPtr)
+            {
+                ThreadArenaChunk* newChunk = ThreadArenaPool_AcquireChunk( threadArena->Pool, 
+                                                                            &threadArena->SpareChunks,
+                                                                            minRequiredSize);
+                if(!newChunk)
+                    goto ret;
+                
+                newChunk->Next = threadArena->CurrentChunk;
+                threadArena->CurrentChunk = newChunk;
+                retPtr = ThreadArenaChunk_Alloc(newChunk, minRequiredSize);
+                ASSERT(retPtr);
+                AllocatorStats_OnNewChain(Allocator_InternGetStats(this), newChunk->Size);
+            }
+            
+            retPtr = SetupCanariesAndSize(retPtr, size).Ptr;
+            AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), (int64_t)minRequiredSize);
+            break;
+        }
+        case AllocatorType_SharedCustom:
+        case AllocatorType_OwnedCustom:
+        {
+            const CustomAllocator* customAllocator = this->Allocator;
+            ASSERT(customAllocator && customAllocator->VTable && customAllocator->VTable->Malloc);
+            retPtr = customAllocator->VTable->Malloc(customAllocator->UserData, size);
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+        {
+            if(!this->Allocator)
+            {
+                INTERN_PRINT_PRINT_TRACE("Trying to allocate with NULL virtual arena\n");
+                goto ret;
+            }
+            
+            uint64_t minRequiredSize = SetupCanariesAndSize(NULL, size).Size;
+            retPtr = VirtualArena_Alloc(this->Allocator, minRequiredSize);
+            if(!retPtr)
+                goto ret;
+            
+            retPtr = SetupCanariesAndSize(retPtr, size).Ptr;
+            AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), (int64_t)minRequiredSize);
+            break;
+        }
         default:
             break;
     } //switch(this->Type)
@@ -253,34 +756,135 @@ static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
                                     "with size %" PRIu64 "\n", this->Allocator, size);
     }
     else
+    {
         INTERN_PRINT_PRINT_TRACE("retPtr: %p, %" PRIu64 "\n", retPtr, size);
+    }
+    return retPtr;
+}
+
+static inline void* Allocator_Malloc(const Allocator* this, uint64_t size)
+{
+    void* retPtr = Allocator_InternMalloc(this, size);
+    if(retPtr)
+    {
+        AllocatorStats_OnAlloc(Allocator_InternGetStats(this), size);
+        Allocator_InternTrace(this, AllocatorTraceKind_Malloc, size, retPtr, NULL);
+    }
     return retPtr;
 }
 
-#define Allocator_Malloc(...) INTERN_PRINT_CALL(Allocator_Malloc, __VA_ARGS__)
+#if ALLOCATOR_PROFILE_CALL_SITES
+    static inline void* Allocator_MallocAt(const char* file, 
+                                            int32_t line, 
+                                            const Allocator* this, 
+                                            uint64_t size)
+    {
+        AllocatorProfile_RecordCallSite(file, line, size, false);
+        return Allocator_Malloc(this, size);
+    }
+    
+    #define Allocator_Malloc(...) INTERN_PRINT_CALL(Allocator_MallocAt, __FILE__, __LINE__, __VA_ARGS__)
+#else
+    #define Allocator_Malloc(...) INTERN_PRINT_CALL(Allocator_Malloc, __VA_ARGS__)
+#endif
 
 static inline void* Allocator_Realloc(const Allocator* this, void* data, uint64_t size)
 {
     void* retPtr = NULL;
+    uint64_t copiedSize = 0;
+    (void)copiedSize;
     if(!this)
         goto ret;
     
-    static_assert((int)AllocatorType_Count == 4, "");
+    static_assert((int)AllocatorType_Count == 10, "");
     switch(this->Type)
     {
         case AllocatorType_Heap:
-            retPtr = realloc(data, size);
+        {
+            #if ALLOCATOR_PROFILE
+                if(UINT64_MAX - INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE < size)
+                    break;
+                uint64_t* header = data ? 
+                                    (void*)((char*)data - INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE) : 
+                                    NULL;
+                uint64_t origSize = header ? *header : 0;
+                uintptr_t origAddress = (uintptr_t)header;
+                uint64_t* newHeader = realloc(header, size + INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE);
+                if(!newHeader)
+                    break;
+                
+                *newHeader = size;
+                retPtr = (char*)newHeader + INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE;
+                if((uintptr_t)newHeader != origAddress)
+                    copiedSize = origSize < size ? origSize : size;
+                AllocatorStats_AddUsedBytes(&AllocatorProfile_HeapRecord, 
+                                            (int64_t)size - (int64_t)origSize);
+            #else
+                retPtr = realloc(data, size);
+            #endif
             break;
+        }
         case AllocatorType_SharedArena:
         case AllocatorType_OwnedArena:
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
         {
             ASSERT( CheckFrontCanary(data) && 
                     CheckBackCanary(data, GetAllocSize(data)) &&
                     "Canary check broken, out-of-bound write detected");
             
             uint64_t origSize = GetAllocSize(data);
-            retPtr = Allocator_Malloc(this, size);
-            memcpy(retPtr, data, origSize);
+            //Bypass the macro, the alloc count and the trace so the call site stays the caller's 
+            //and this is recorded as one realloc
+            retPtr = Allocator_InternMalloc(this, size);
+            if(!retPtr)
+                goto ret;
+            copiedSize = origSize < size ? origSize : size;
+            memcpy(retPtr, data, copiedSize);
+            break;
+        }
+        case AllocatorType_SharedCustom:
+        case AllocatorType_OwnedCustom:
+        {
+            const CustomAllocator* customAllocator = this->Allocator;
+            ASSERT(customAllocator && customAllocator->VTable && customAllocator->VTable->Realloc);
+            retPtr = customAllocator->VTable->Realloc(customAllocator->UserData, data, size);
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+        {
+            ASSERT( CheckFrontCanary(data) && 
+                    CheckBackCanary(data, GetAllocSize(data)) &&
+                    "Canary check broken, out-of-bound write detected");
+            
+            VirtualArena* virtualArena = this->Allocator;
+            uint64_t origSize = GetAllocSize(data);
+            char* byteDataPtr = data;
+            
+            //The range is contiguous so the latest allocation can always grow in place
+            if(virtualArena->Region + virtualArena->Index == byteDataPtr + origSize + BackCanarySize())
+            {
+                uint64_t startIndex = (uint64_t)(byteDataPtr - FrontCanarySize() - virtualArena->Region);
+                uint64_t minRequiredSize = SetupCanariesAndSize(NULL, size).Size;
+                if( virtualArena->ReservedSize - startIndex < minRequiredSize ||
+                    !VirtualArena_Commit(virtualArena, startIndex + minRequiredSize))
+                {
+                    goto ret;
+                }
+                
+                virtualArena->Index = startIndex + minRequiredSize;
+                retPtr = SetupCanariesAndSize(virtualArena->Region + startIndex, size).Ptr;
+                AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), 
+                                            (int64_t)size - (int64_t)origSize);
+                break;
+            }
+            
+            retPtr = Allocator_InternMalloc(this, size);
+            if(!retPtr)
+                goto ret;
+            copiedSize = origSize < size ? origSize : size;
+            memcpy(retPtr, data, copiedSize);
             break;
         }
         default:
@@ -294,22 +898,51 @@ static inline void* Allocator_Realloc(const Allocator* this, void* data, uint64_
                                     "with size %" PRIu64 "\n", this->Allocator, size);
     }
     else
+    {
         INTERN_PRINT_PRINT_TRACE("retPtr: %p, %" PRIu64 "\n", retPtr, size);
+        AllocatorStats_OnRealloc(Allocator_InternGetStats(this), copiedSize);
+        Allocator_InternTrace(this, AllocatorTraceKind_Realloc, size, data, retPtr);
+    }
     return retPtr;
 }
 
-#define Allocator_Realloc(...) INTERN_PRINT_CALL(Allocator_Realloc, __VA_ARGS__)
+#if ALLOCATOR_PROFILE_CALL_SITES
+    static inline void* Allocator_ReallocAt(const char* file, 
+                                            int32_t line, 
+                                            const Allocator* this, 
+                                            void* data, 
+                                            uint64_t size)
+    {
+        AllocatorProfile_RecordCallSite(file, line, size, true);
+        return Allocator_Realloc(this, data, size);
+    }
+    
+    #define Allocator_Realloc(...) \
+        INTERN_PRINT_CALL(Allocator_ReallocAt, __FILE__, __LINE__, __VA_ARGS__)
+#else
+    #define Allocator_Realloc(...) INTERN_PRINT_CALL(Allocator_Realloc, __VA_ARGS__)
+#endif
 
 static inline void Allocator_Free(const Allocator* this, void* data)
 {
     if(!this)
         return;
     
-    static_assert((int)AllocatorType_Count == 4, "");
+    if(data)
+        Allocator_InternTrace(this, AllocatorTraceKind_Free, 0, data, NULL);
+    
+    static_assert((int)AllocatorType_Count == 10, "");
     switch(this->Type)
     {
         case AllocatorType_Heap:
             INTERN_PRINT_PRINT_TRACE("Free: %p\n", data);
+            #if ALLOCATOR_PROFILE
+                if(!data)
+                    return;
+                data = (char*)data - INTERN_ALLOC_PROFILE_HEAP_HEADER_SIZE;
+                AllocatorStats_AddUsedBytes(&AllocatorProfile_HeapRecord, -(int64_t)*(uint64_t*)data);
+                AllocatorStats_OnFree(&AllocatorProfile_HeapRecord, 0);
+            #endif
             free(data);
             break;
         case AllocatorType_SharedArena:
@@ -338,17 +971,78 @@ static inline void Allocator_Free(const Allocator* this, void* data)
             ASSERT(currentNode->CurrentArena);
             
             //TODO: Use walkable allocation list
+            uint64_t allocFullSize = FrontCanarySize() + GetAllocSize(data) + BackCanarySize();
             if( currentNode->CurrentArena->region + currentNode->CurrentArena->index ==
                 byteDataPtr + GetAllocSize(data) + BackCanarySize())
             {
-                currentNode->CurrentArena->index -= (FrontCanarySize() + 
-                                                    GetAllocSize(data) + 
-                                                    BackCanarySize());
+                currentNode->CurrentArena->index -= allocFullSize;
                 ASSERT( currentNode->CurrentArena->region + 
                         currentNode->CurrentArena->index + 
                         FrontCanarySize() == byteDataPtr);
+                AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), -(int64_t)allocFullSize);
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), 0);
             }
+            else
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), allocFullSize);
+            
+            break;
+        }
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
+        {
+            ASSERT( CheckFrontCanary(data) && 
+                    CheckBackCanary(data, GetAllocSize(data)) &&
+                    "Canary check broken, out-of-bound write detected");
+            
+            //Only the latest allocation in the current chunk can be freed
+            ThreadArenaChunk* currentChunk = ((ThreadArena*)this->Allocator)->CurrentChunk;
+            ASSERT(currentChunk);
+            char* byteDataPtr = data;
+            uint64_t allocFullSize = FrontCanarySize() + GetAllocSize(data) + BackCanarySize();
+            if( (char*)(currentChunk + 1) + currentChunk->Index == 
+                byteDataPtr + GetAllocSize(data) + BackCanarySize())
+            {
+                currentChunk->Index -= allocFullSize;
+                AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), -(int64_t)allocFullSize);
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), 0);
+            }
+            else
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), allocFullSize);
+            break;
+        }
+        case AllocatorType_SharedCustom:
+        case AllocatorType_OwnedCustom:
+        {
+            const CustomAllocator* customAllocator = this->Allocator;
+            ASSERT(customAllocator && customAllocator->VTable && customAllocator->VTable->Free);
+            customAllocator->VTable->Free(customAllocator->UserData, data);
+            AllocatorStats_OnFree(Allocator_InternGetStats(this), 0);
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+        {
+            ASSERT( CheckFrontCanary(data) && 
+                    CheckBackCanary(data, GetAllocSize(data)) &&
+                    "Canary check broken, out-of-bound write detected");
             
+            VirtualArena* virtualArena = this->Allocator;
+            char* byteDataPtr = data;
+            ASSERT( byteDataPtr >= virtualArena->Region && 
+                    byteDataPtr < virtualArena->Region + virtualArena->Index &&
+                    "Freeing data that does not belong to this allocator");
+            
+            //Only the latest allocation can be freed
+            uint64_t allocFullSize = FrontCanarySize() + GetAllocSize(data) + BackCanarySize();
+            if( virtualArena->Region + virtualArena->Index == 
+                byteDataPtr + GetAllocSize(data) + BackCanarySize())
+            {
+                virtualArena->Index -= allocFullSize;
+                AllocatorStats_AddUsedBytes(Allocator_InternGetStats(this), -(int64_t)allocFullSize);
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), 0);
+            }
+            else
+                AllocatorStats_OnFree(Allocator_InternGetStats(this), allocFullSize);
             break;
         }
         default:
@@ -358,14 +1052,320 @@ static inline void Allocator_Free(const Allocator* this, void* data)
 
 #define Allocator_Free(...) INTERN_PRINT_CALL(Allocator_Free, __VA_ARGS__)
 
-//TODO: Allocator_Reset
+#ifndef ALLOCATOR_ALIGNED_TAIL_PADDING
+    #define ALLOCATOR_ALIGNED_TAIL_PADDING 64
+#endif
+
+//Stored right before the aligned pointer
+typedef struct AlignedAllocHeader
+{
+    uint64_t Size;
+    uint64_t Offset;                            //From the start of the underlying allocation
+} AlignedAllocHeader;
+
+static inline uint64_t AlignedAllocHeader_FullSize(uint64_t size, uint64_t alignment)
+{
+    if(UINT64_MAX - sizeof(AlignedAllocHeader) - ALLOCATOR_ALIGNED_TAIL_PADDING - alignment < size)
+        return 0;
+    return sizeof(AlignedAllocHeader) + alignment - 1 + size + ALLOCATOR_ALIGNED_TAIL_PADDING;
+}
+
+//Places the header and zeroes the tail padding, `dataOffset` is where the data currently is
+static inline void* AlignedAllocHeader_Setup(   void* allocPtr, 
+                                                uint64_t dataOffset, 
+                                                uint64_t dataSize, 
+                                                uint64_t size, 
+                                                uint64_t alignment)
+{
+    uintptr_t allocAddress = (uintptr_t)allocPtr;
+    uintptr_t alignedAddress =  (allocAddress + sizeof(AlignedAllocHeader) + alignment - 1) & 
+                                ~(uintptr_t)(alignment - 1);
+    char* alignedPtr = (char*)allocPtr + (alignedAddress - allocAddress);
+    uint64_t offset = (uint64_t)(alignedAddress - allocAddress);
+    
+    if(dataSize > 0 && dataOffset != offset)
+        memmove(alignedPtr, (char*)allocPtr + dataOffset, dataSize);
+    
+    AlignedAllocHeader header = { .Size = size, .Offset = offset };
+    memcpy(alignedPtr - sizeof(AlignedAllocHeader), &header, sizeof(header));
+    memset(alignedPtr + size, 0, ALLOCATOR_ALIGNED_TAIL_PADDING);
+    return alignedPtr;
+}
+
+static inline AlignedAllocHeader AlignedAllocHeader_Get(void* alignedPtr)
+{
+    AlignedAllocHeader header;
+    memcpy(&header, (char*)alignedPtr - sizeof(AlignedAllocHeader), sizeof(header));
+    return header;
+}
+
+//`alignment` must be a power of 2, at least 16 is used
+static inline void* Allocator_MallocAligned(const Allocator* this, uint64_t size, uint64_t alignment)
+{
+    ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of 2");
+    alignment = alignment < sizeof(AlignedAllocHeader) ? sizeof(AlignedAllocHeader) : alignment;
+    
+    uint64_t fullSize = AlignedAllocHeader_FullSize(size, alignment);
+    if(fullSize == 0)
+        return NULL;
+    
+    void* allocPtr = Allocator_Malloc(this, fullSize);
+    if(!allocPtr)
+        return NULL;
+    
+    return AlignedAllocHeader_Setup(allocPtr, 0, 0, size, alignment);
+}
+
+#define Allocator_MallocAligned(...) INTERN_PRINT_CALL(Allocator_MallocAligned, __VA_ARGS__)
+
+//`data` must be from `Allocator_MallocAligned()` with the same `alignment`.
+//Reallocates in place when the underlying allocator can.
+static inline void* Allocator_ReallocAligned(   const Allocator* this, 
+                                                void* data, 
+                                                uint64_t size, 
+                                                uint64_t alignment)
+{
+    if(!data)
+        return Allocator_MallocAligned(this, size, alignment);
+    
+    ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of 2");
+    alignment = alignment < sizeof(AlignedAllocHeader) ? sizeof(AlignedAllocHeader) : alignment;
+    
+    uint64_t fullSize = AlignedAllocHeader_FullSize(size, alignment);
+    if(fullSize == 0)
+        return NULL;
+    
+    AlignedAllocHeader header = AlignedAllocHeader_Get(data);
+    void* allocPtr = Allocator_Realloc(this, (char*)data - header.Offset, fullSize);
+    if(!allocPtr)
+        return NULL;
+    
+    //The new allocation might not have the same alignment, so the data might need to be moved
+    return AlignedAllocHeader_Setup(allocPtr, 
+                                    header.Offset, 
+                                    header.Size < size ? header.Size : size, 
+                                    size, 
+                                    alignment);
+}
+
+#define Allocator_ReallocAligned(...) INTERN_PRINT_CALL(Allocator_ReallocAligned, __VA_ARGS__)
+
+static inline void Allocator_FreeAligned(const Allocator* this, void* data)
+{
+    if(!data)
+        return;
+    Allocator_Free(this, (char*)data - AlignedAllocHeader_Get(data).Offset);
+}
+
+#define Allocator_FreeAligned(...) INTERN_PRINT_CALL(Allocator_FreeAligned, __VA_ARGS__)
+
+static inline AllocatorMark Allocator_Mark(const Allocator* this)
+{
+    if(!this || !this->Allocator)
+        return (AllocatorMark){0};
+    
+    static_assert((int)AllocatorType_Count == 10, "");
+    switch(this->Type)
+    {
+        case AllocatorType_SharedArena:
+        case AllocatorType_OwnedArena:
+        {
+            ArenaWrapper* headWrapper = this->Allocator;
+            ArenaWrapper* tipWrapper = headWrapper->TipArena ? headWrapper->TipArena : headWrapper;
+            ASSERT(tipWrapper->CurrentArena);
+            AllocatorMark retMark = 
+            {
+                .TipArena = tipWrapper,
+                .TipIndex = tipWrapper->CurrentArena->index
+            };
+            #if ALLOCATOR_PROFILE
+                retMark.UsedBytes = headWrapper->Stats ? headWrapper->Stats->UsedBytes : 0;
+            #endif
+            #if ALLOCATOR_TRACE
+                retMark.TraceMark = 
+                    Allocator_InternTrace(this, AllocatorTraceKind_Mark, 0, NULL, NULL);
+            #endif
+            return retMark;
+        }
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
+        {
+            ThreadArenaChunk* currentChunk = ((ThreadArena*)this->Allocator)->CurrentChunk;
+            ASSERT(currentChunk);
+            AllocatorMark retMark = { .TipChunk = currentChunk, .TipIndex = currentChunk->Index };
+            #if ALLOCATOR_PROFILE
+                retMark.UsedBytes = ((ThreadArena*)this->Allocator)->Stats->UsedBytes;
+            #endif
+            #if ALLOCATOR_TRACE
+                retMark.TraceMark = 
+                    Allocator_InternTrace(this, AllocatorTraceKind_Mark, 0, NULL, NULL);
+            #endif
+            return retMark;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+        {
+            AllocatorMark retMark = { .TipIndex = ((VirtualArena*)this->Allocator)->Index };
+            #if ALLOCATOR_PROFILE
+                retMark.UsedBytes = ((VirtualArena*)this->Allocator)->Stats->UsedBytes;
+            #endif
+            #if ALLOCATOR_TRACE
+                retMark.TraceMark = 
+                    Allocator_InternTrace(this, AllocatorTraceKind_Mark, 0, NULL, NULL);
+            #endif
+            return retMark;
+        }
+        case AllocatorType_Heap:
+        default:
+            return (AllocatorMark){0};
+    }
+}
+
+#define Allocator_Mark(...) INTERN_PRINT_CALL(Allocator_Mark, __VA_ARGS__)
+
+//Frees everything allocated after `mark`. Marks must be rewound in LIFO order.
+static inline void Allocator_Rewind(const Allocator* this, AllocatorMark mark)
+{
+    if(!this || !this->Allocator)
+        return;
+    
+    #if ALLOCATOR_TRACE
+        if(mark.TraceMark != 0)
+            Allocator_InternTrace(this, AllocatorTraceKind_Rewind, mark.TraceMark, NULL, NULL);
+    #endif
+    
+    static_assert((int)AllocatorType_Count == 10, "");
+    switch(this->Type)
+    {
+        case AllocatorType_SharedArena:
+        case AllocatorType_OwnedArena:
+        {
+            if(!mark.TipArena)
+                break;
+            
+            ArenaWrapper* headWrapper = this->Allocator;
+            ASSERT(mark.TipArena->CurrentArena);
+            ASSERT(mark.TipIndex >= ArenaWrapper_EmptyIndex(mark.TipArena));
+            ASSERT(mark.TipIndex <= mark.TipArena->CurrentArena->size);
+            
+            INTERN_PRINT_PRINT_TRACE(   "Rewinding %p to %p at %" PRIu64 "\n", 
+                                        this->Allocator, 
+                                        (void*)mark.TipArena, 
+                                        mark.TipIndex);
+            
+            //Arenas after the tip are reset lazily when we allocate into them again
+            mark.TipArena->CurrentArena->index = mark.TipIndex;
+            headWrapper->TipArena = mark.TipArena;
+            #if ALLOCATOR_PROFILE
+                AllocatorStats_SetUsedBytes(headWrapper->Stats, mark.UsedBytes);
+            #endif
+            break;
+        }
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
+        {
+            if(!mark.TipChunk)
+                break;
+            
+            ThreadArena* threadArena = this->Allocator;
+            
+            //Keep the chunks acquired after the mark for reuse
+            while(threadArena->CurrentChunk && threadArena->CurrentChunk != mark.TipChunk)
+            {
+                ThreadArenaChunk* spareChunk = threadArena->CurrentChunk;
+                threadArena->CurrentChunk = spareChunk->Next;
+                spareChunk->Next = threadArena->SpareChunks;
+                threadArena->SpareChunks = spareChunk;
+                AllocatorStats_OnReleaseChain(Allocator_InternGetStats(this), spareChunk->Size);
+            }
+            
+            ASSERT(threadArena->CurrentChunk && "Mark does not belong to this allocator");
+            if(threadArena->CurrentChunk)
+                threadArena->CurrentChunk->Index = mark.TipIndex;
+            #if ALLOCATOR_PROFILE
+                AllocatorStats_SetUsedBytes(threadArena->Stats, mark.UsedBytes);
+            #endif
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+        {
+            VirtualArena* virtualArena = this->Allocator;
+            if(mark.TipIndex < VirtualArena_EmptyIndex())
+                break;
+            
+            //Pages stay committed for reuse
+            ASSERT(mark.TipIndex <= virtualArena->Index && "Marks must be rewound in LIFO order");
+            virtualArena->Index = mark.TipIndex;
+            #if ALLOCATOR_PROFILE
+                AllocatorStats_SetUsedBytes(virtualArena->Stats, mark.UsedBytes);
+            #endif
+            break;
+        }
+        case AllocatorType_Heap:
+        default:
+            break;
+    }
+}
+
+#define Allocator_Rewind(...) INTERN_PRINT_CALL(Allocator_Rewind, __VA_ARGS__)
+
+//Frees everything allocated but keeps the chained arenas for reuse
+static inline void Allocator_Reset(const Allocator* this)
+{
+    if(!this || !this->Allocator)
+        return;
+    
+    //Recorded as a rewind to mark 0, custom allocators don't reset
+    if(this->Type != AllocatorType_SharedCustom && this->Type != AllocatorType_OwnedCustom)
+        Allocator_InternTrace(this, AllocatorTraceKind_Rewind, 0, NULL, NULL);
+    
+    static_assert((int)AllocatorType_Count == 10, "");
+    switch(this->Type)
+    {
+        case AllocatorType_SharedArena:
+        case AllocatorType_OwnedArena:
+        {
+            ArenaWrapper* headWrapper = this->Allocator;
+            ASSERT(headWrapper->CurrentArena);
+            Allocator_Rewind(   this, 
+                                (AllocatorMark)
+                                {
+                                    .TipArena = headWrapper,
+                                    .TipIndex = ArenaWrapper_EmptyIndex(headWrapper)
+                                });
+            break;
+        }
+        case AllocatorType_SharedThreadArena:
+        case AllocatorType_OwnedThreadArena:
+        {
+            ThreadArena* threadArena = this->Allocator;
+            Allocator_Rewind(   this, 
+                                (AllocatorMark)
+                                {
+                                    .TipChunk = threadArena->FirstChunk,
+                                    .TipIndex = sizeof(ThreadArena)
+                                });
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+        case AllocatorType_OwnedVirtualArena:
+            Allocator_Rewind(this, (AllocatorMark){ .TipIndex = VirtualArena_EmptyIndex() });
+            break;
+        case AllocatorType_Heap:
+        default:
+            break;
+    }
+}
+
+#define Allocator_Reset(...) INTERN_PRINT_CALL(Allocator_Reset, __VA_ARGS__)
 
 static inline void Allocator_Destroy(Allocator* this)
 {
     if(!this)
         return;
     
-    static_assert((int)AllocatorType_Count == 4, "");
+    static_assert((int)AllocatorType_Count == 10, "");
     switch(this->Type)
     {
         case AllocatorType_Heap:
@@ -376,6 +1376,11 @@ static inline void Allocator_Destroy(Allocator* this)
             if(!this->Allocator)
                 return;
             
+            Allocator_InternTrace(this, AllocatorTraceKind_Destroy, 0, NULL, NULL);
+            #if ALLOCATOR_PROFILE
+                AllocatorStats_OnDestroy(((ArenaWrapper*)this->Allocator)->Stats);
+            #endif
+            
             //Find the last linked arena wrapper
             ArenaWrapper* currentNode = this->Allocator;
             while(currentNode->NextArena)
@@ -401,6 +1406,71 @@ static inline void Allocator_Destroy(Allocator* this)
             arena_destroy(currentNode->CurrentArena);
             break;
         }
+        case AllocatorType_SharedThreadArena:
+            break;
+        case AllocatorType_OwnedThreadArena:
+        {
+            if(!this->Allocator)
+                return;
+            
+            Allocator_InternTrace(this, AllocatorTraceKind_Destroy, 0, NULL, NULL);
+            
+            //Return all the chunks to the pool. `threadArena` lives in the first chunk, so we can't 
+            //access it after releasing.
+            ThreadArena* threadArena = this->Allocator;
+            ThreadArenaPool* pool = threadArena->Pool;
+            ThreadArenaChunk* spareChunks = threadArena->SpareChunks;
+            ThreadArenaChunk* firstChunk = threadArena->CurrentChunk;
+            ASSERT(firstChunk);
+            AllocatorStats_OnDestroy(Allocator_InternGetStats(this));
+            
+            ThreadArenaChunk* lastChunk = firstChunk;
+            while(lastChunk->Next)
+                lastChunk = lastChunk->Next;
+            lastChunk->Next = spareChunks;
+            while(lastChunk->Next)
+                lastChunk = lastChunk->Next;
+            
+            INTERN_PRINT_PRINT_TRACE("Releasing thread arena: %p\n", this->Allocator);
+            ThreadArenaPool_ReleaseChunks(pool, firstChunk, lastChunk);
+            break;
+        }
+        case AllocatorType_SharedCustom:
+            break;
+        case AllocatorType_OwnedCustom:
+        {
+            Allocator_InternTrace(this, AllocatorTraceKind_Destroy, 0, NULL, NULL);
+            const CustomAllocator* customAllocator = this->Allocator;
+            if(customAllocator && customAllocator->VTable && customAllocator->VTable->Destroy)
+                customAllocator->VTable->Destroy(customAllocator->UserData);
+            break;
+        }
+        case AllocatorType_SharedVirtualArena:
+            break;
+        case AllocatorType_OwnedVirtualArena:
+        {
+            if(!this->Allocator)
+                return;
+            
+            Allocator_InternTrace(this, AllocatorTraceKind_Destroy, 0, NULL, NULL);
+            
+            //`virtualArena` lives in the range we are unmapping
+            VirtualArena* virtualArena = this->Allocator;
+            char* region = virtualArena->Region;
+            uint64_t reservedSize = virtualArena->ReservedSize;
+            AllocatorStats_OnDestroy(Allocator_InternGetStats(this));
+            
+            INTERN_PRINT_PRINT_TRACE("Unmapping virtual arena: %p\n", this->Allocator);
+            #if INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA
+                int unmapResult = munmap(region, reservedSize);
+                ASSERT(unmapResult == 0);
+                (void)unmapResult;
+            #else
+                (void)region;
+                (void)reservedSize;
+            #endif
+            break;
+        }
         default:
             break;
     }
@@ -416,7 +1486,7 @@ static inline Allocator Allocator_Share(Allocator* this)
     
     //INTERN_PRINT_PRINT_TRACE(this);
     
-    static_assert((int)AllocatorType_Count == 4, "");
+    static_assert((int)AllocatorType_Count == 10, "");
     switch(this->Type)
     {
         case AllocatorType_Heap:
@@ -429,6 +1499,30 @@ static inline Allocator Allocator_Share(Allocator* this)
             retAlloc.Type = AllocatorType_SharedArena;
             return retAlloc;
         }
+        case AllocatorType_SharedThreadArena:
+            return *this;
+        case AllocatorType_OwnedThreadArena:
+        {
+            Allocator retAlloc = *this;
+            retAlloc.Type = AllocatorType_SharedThreadArena;
+            return retAlloc;
+        }
+        case AllocatorType_SharedCustom:
+            return *this;
+        case AllocatorType_OwnedCustom:
+        {
+            Allocator retAlloc = *this;
+            retAlloc.Type = AllocatorType_SharedCustom;
+            return retAlloc;
+        }
+        case AllocatorType_SharedVirtualArena:
+            return *this;
+        case AllocatorType_OwnedVirtualArena:
+        {
+            Allocator retAlloc = *this;
+            retAlloc.Type = AllocatorType_SharedVirtualArena;
+            return retAlloc;
+        }
         default:
             return (Allocator){0};
     }
@@ -526,4 +1620,192 @@ static inline Allocator CreateHeapAllocator(void)
 
 #define CreateHeapAllocator(...) INTERN_PRINT_CALL(CreateHeapAllocator, __VA_ARGS__)
 
+//`customAllocator` is not copied and must outlive the returned allocator
+static inline Allocator CreateCustomAllocator(const CustomAllocator* customAllocator)
+{
+    if(!customAllocator || !customAllocator->VTable)
+        return (Allocator){0};
+    
+    return  (Allocator)
+            {
+                .Type = AllocatorType_OwnedCustom,
+                .Allocator = (void*)customAllocator,
+            };
+}
+
+#define CreateCustomAllocator(...) INTERN_PRINT_CALL(CreateCustomAllocator, __VA_ARGS__)
+
+static inline ThreadArenaPool* CreateThreadArenaPool(uint64_t chunkSize)
+{
+    ThreadArenaPool* retPool = malloc(sizeof(ThreadArenaPool));
+    if(!retPool)
+        return NULL;
+    
+    *retPool = (ThreadArenaPool){ .ChunkSize = chunkSize };
+    INTERN_PRINT_PRINT_TRACE("retPool: %p with chunk size %" PRIu64 "\n", (void*)retPool, chunkSize);
+    return retPool;
+}
+
+#define CreateThreadArenaPool(...) INTERN_PRINT_CALL(CreateThreadArenaPool, __VA_ARGS__)
+
+//Frees all the chunks, including the ones still used by thread arenas. 
+//No thread arena of this pool can be used after this.
+static inline void ThreadArenaPool_Destroy(ThreadArenaPool* this)
+{
+    if(!this)
+        return;
+    
+    ThreadArenaChunk* currentChunk = __atomic_exchange_n(&this->AllocatedChunks, NULL, __ATOMIC_ACQUIRE);
+    while(currentChunk)
+    {
+        ThreadArenaChunk* nextChunk = currentChunk->NextAllocated;
+        INTERN_PRINT_PRINT_TRACE("Destroying chunk: %p\n", (void*)currentChunk);
+        free(currentChunk);
+        currentChunk = nextChunk;
+    }
+    free(this);
+}
+
+#define ThreadArenaPool_Destroy(...) INTERN_PRINT_CALL(ThreadArenaPool_Destroy, __VA_ARGS__)
+
+//Creates an allocator for the calling thread. Only one thread can use it at a time.
+static inline Allocator CreateThreadArenaAllocator(ThreadArenaPool* pool)
+{
+    if(!pool)
+        return (Allocator){0};
+    
+    ThreadArenaChunk* spareChunks = NULL;
+    ThreadArenaChunk* firstChunk = ThreadArenaPool_AcquireChunk(pool, 
+                                                                &spareChunks, 
+                                                                sizeof(ThreadArena));
+    if(!firstChunk)
+        return (Allocator){0};
+    
+    ThreadArena* threadArena = ThreadArenaChunk_Alloc(firstChunk, sizeof(ThreadArena));
+    ASSERT(threadArena);
+    *threadArena =  (ThreadArena)
+                    {
+                        .Pool = pool,
+                        .FirstChunk = firstChunk,
+                        .CurrentChunk = firstChunk
+                    };
+    
+    #if ALLOCATOR_PROFILE
+        threadArena->Stats = AllocatorProfile_CreateRecord(NULL);
+        AllocatorStats_OnNewChain(threadArena->Stats, firstChunk->Size);
+    #endif
+    
+    INTERN_PRINT_PRINT_TRACE("retAlloc.Allocator: %p\n", (void*)threadArena);
+    return (Allocator){ .Type = AllocatorType_OwnedThreadArena, .Allocator = threadArena };
+}
+
+#define CreateThreadArenaAllocator(...) INTERN_PRINT_CALL(CreateThreadArenaAllocator, __VA_ARGS__)
+
+//Reserves `reserveSize` bytes of address space but only commits what is used. Returns an invalid 
+//allocator if virtual arenas are not supported.
+static inline Allocator CreateVirtualArenaAllocator(uint64_t reserveSize, bool hugePages)
+{
+    #if INTERN_ALLOCATOR_HAS_VIRTUAL_ARENA
+        long pageSize = sysconf(_SC_PAGESIZE);
+        uint64_t commitGranularity = hugePages ? VIRTUAL_ARENA_HUGE_PAGE_SIZE : (uint64_t)pageSize;
+        if(pageSize <= 0 || commitGranularity % (uint64_t)pageSize != 0)
+            return (Allocator){0};
+        
+        //Huge pages need an aligned range, so reserve one extra huge page to align within
+        uint64_t alignPadding = hugePages ? VIRTUAL_ARENA_HUGE_PAGE_SIZE : 0;
+        if(reserveSize < VirtualArena_EmptyIndex() + 1)
+            reserveSize = VirtualArena_EmptyIndex() + 1;
+        if(UINT64_MAX - commitGranularity - alignPadding < reserveSize || SIZE_MAX < reserveSize)
+            return (Allocator){0};
+        reserveSize = (reserveSize + commitGranularity - 1) / commitGranularity * commitGranularity;
+        
+        void* mapped = mmap(NULL, 
+                            reserveSize + alignPadding, 
+                            PROT_NONE, 
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, 
+                            -1, 
+                            0);
+        if(mapped == MAP_FAILED)
+            return (Allocator){0};
+        
+        char* region = mapped;
+        if(hugePages)
+        {
+            uint64_t headPadding = (VIRTUAL_ARENA_HUGE_PAGE_SIZE - 
+                                    (uint64_t)(uintptr_t)region % VIRTUAL_ARENA_HUGE_PAGE_SIZE) % 
+                                    VIRTUAL_ARENA_HUGE_PAGE_SIZE;
+            if(headPadding != 0)
+                munmap(region, headPadding);
+            if(alignPadding - headPadding != 0)
+                munmap(region + headPadding + reserveSize, alignPadding - headPadding);
+            region += headPadding;
+            
+            #if defined(MADV_HUGEPAGE)
+                //Only a hint, nothing to do if transparent huge pages are disabled
+                (void)madvise(region, reserveSize, MADV_HUGEPAGE);
+            #endif
+        }
+        
+        VirtualArena bootstrapArena =
+        {
+            .Region = region,
+            .ReservedSize = reserveSize,
+            .CommittedSize = 0,
+            .CommitGranularity = commitGranularity,
+            .Index = 0,
+        };
+        
+        if(!VirtualArena_Commit(&bootstrapArena, VirtualArena_EmptyIndex()))
+        {
+            munmap(region, reserveSize);
+            return (Allocator){0};
+        }
+        
+        VirtualArena* virtualArena = (VirtualArena*)region;
+        *virtualArena = bootstrapArena;
+        virtualArena->Index = VirtualArena_EmptyIndex();
+        
+        #if ALLOCATOR_PROFILE
+            virtualArena->Stats = AllocatorProfile_CreateRecord(NULL);
+            AllocatorStats_OnNewChain(virtualArena->Stats, 0);
+            AllocatorStats_OnCommit(virtualArena->Stats, virtualArena->CommittedSize);
+        #endif
+        
+        INTERN_PRINT_PRINT_TRACE(   "retAlloc.Allocator: %p reserving %" PRIu64 "\n", 
+                                    (void*)virtualArena, 
+                                    reserveSize);
+        return (Allocator){ .Type = AllocatorType_OwnedVirtualArena, .Allocator = virtualArena };
+    #else
+        (void)reserveSize;
+        (void)hugePages;
+        return (Allocator){0};
+    #endif
+}
+
+#define CreateVirtualArenaAllocator(...) INTERN_PRINT_CALL(CreateVirtualArenaAllocator, __VA_ARGS__)
+
+//`name` is not copied and must outlive the program. Heap and custom allocators share one record each.
+static inline void Allocator_SetProfileName(const Allocator* this, const char* name)
+{
+    #if ALLOCATOR_PROFILE
+        AllocatorStats* stats = Allocator_InternGetStats(this);
+        if(stats && stats != &AllocatorProfile_HeapRecord && stats != &AllocatorProfile_CustomRecord)
+            stats->Name = name;
+    #else
+        (void)this;
+        (void)name;
+    #endif
+}
+
+#define Allocator_SetProfileName(...) INTERN_PRINT_CALL(Allocator_SetProfileName, __VA_ARGS__)
+
+//Returns a copy of the stats so far, all zeros if profiling is disabled
+static inline AllocatorStats Allocator_GetStats(const Allocator* this)
+{
+    AllocatorStats* stats = Allocator_InternGetStats(this);
+    return stats ? *stats : (AllocatorStats){0};
+}
+
+#define Allocator_GetStats(...) INTERN_PRINT_CALL(Allocator_GetStats, __VA_ARGS__)
+
 #endif
@@ -0,0 +1,384 @@
+#ifndef MODC_ALLOCATOR_PROFILE_H
+#define MODC_ALLOCATOR_PROFILE_H
+
+/* Docs
+Allocation profiling for Allocator.h, disabled by default.
+
+Define `ALLOCATOR_PROFILE` to 1 to count allocations for each allocator.
+Define `ALLOCATOR_PROFILE_CALL_SITES` to 1 as well to count allocations for each `__FILE__`/`__LINE__`
+which calls `Allocator_Malloc()` or `Allocator_Realloc()`.
+Define `ALLOCATOR_PROFILE_MAX_ALLOCATORS` and `ALLOCATOR_PROFILE_MAX_CALL_SITES` to change the number
+of allocators and call sites that can be recorded.
+
+Records are kept until exit, even after the allocator is destroyed. Heap allocators share one record
+and so do custom allocators. Arena and thread arena allocators get their own records, which can be
+named with `Allocator_SetProfileName()`.
+
+`AllocatorProfile_Totals()` sums the counters of all records, PhaseStats.h uses it for the 
+allocations of each compiler phase.
+
+Use `AllocatorProfile_WriteJson()` to write all records or `AllocatorProfile_WriteJsonAtExit()` to
+write them to a file at exit.
+
+When disabled, all the functions are no-op.
+*/
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef ALLOCATOR_PROFILE
+    #define ALLOCATOR_PROFILE 0
+#endif
+
+#ifndef ALLOCATOR_PROFILE_CALL_SITES
+    #define ALLOCATOR_PROFILE_CALL_SITES 0
+#endif
+
+#ifndef ALLOCATOR_PROFILE_MAX_ALLOCATORS
+    #define ALLOCATOR_PROFILE_MAX_ALLOCATORS 256
+#endif
+
+#ifndef ALLOCATOR_PROFILE_MAX_CALL_SITES
+    #define ALLOCATOR_PROFILE_MAX_CALL_SITES 1024
+#endif
+
+typedef struct AllocatorStats
+{
+    const char* Name;
+    uint64_t AllocCount;
+    uint64_t AllocBytes;            //Requested bytes
+    uint64_t ReallocCount;
+    uint64_t ReallocCopyBytes;      //Bytes copied because the allocation can't grow in place
+    uint64_t FreeCount;
+    uint64_t WastedFreeBytes;       //Bytes freed that can't be reused, not at the tip of an arena
+    uint64_t UsedBytes;             //Including size headers, canaries and alignment
+    uint64_t HighWaterBytes;        //Peak of `UsedBytes`
+    uint64_t ReservedBytes;         //Bytes of the arenas, chunks or committed pages, 0 for heap/custom
+    uint64_t ChainLength;           //Number of arenas or chunks in use
+    bool Destroyed;
+} AllocatorStats;
+
+typedef struct AllocatorCallSite
+{
+    uint64_t Key;                   //0 if the slot is empty
+    const char* File;
+    int32_t Line;
+    uint64_t AllocCount;
+    uint64_t AllocBytes;
+    uint64_t ReallocCount;
+} AllocatorCallSite;
+
+#if ALLOCATOR_PROFILE
+    static AllocatorStats AllocatorProfile_Records[ALLOCATOR_PROFILE_MAX_ALLOCATORS];
+    static uint32_t AllocatorProfile_RecordsCount = 0;
+    
+    //Shared by all heap allocators, custom allocators and arenas that don't fit in the records
+    static AllocatorStats AllocatorProfile_HeapRecord = { .Name = "Heap" };
+    static AllocatorStats AllocatorProfile_CustomRecord = { .Name = "Custom" };
+    static AllocatorStats AllocatorProfile_OverflowRecord = { .Name = "Overflow" };
+    
+    #if ALLOCATOR_PROFILE_CALL_SITES
+        static AllocatorCallSite AllocatorProfile_CallSites[ALLOCATOR_PROFILE_MAX_CALL_SITES];
+    #endif
+    
+    static const char* AllocatorProfile_ExitPath = NULL;
+#endif
+
+//Counters can be updated from multiple threads for shared records, so all updates are atomic
+#define INTERN_ALLOC_PROFILE_ADD(fieldPtr, value) \
+    (void)__atomic_fetch_add((fieldPtr), (value), __ATOMIC_RELAXED)
+
+static inline AllocatorStats* AllocatorProfile_CreateRecord(const char* name)
+{
+    #if ALLOCATOR_PROFILE
+        uint32_t recordIndex = __atomic_fetch_add(&AllocatorProfile_RecordsCount, 1, __ATOMIC_RELAXED);
+        if(recordIndex >= ALLOCATOR_PROFILE_MAX_ALLOCATORS)
+            return &AllocatorProfile_OverflowRecord;
+        
+        AllocatorStats* record = &AllocatorProfile_Records[recordIndex];
+        *record = (AllocatorStats){ .Name = name };
+        return record;
+    #else
+        (void)name;
+        return NULL;
+    #endif
+}
+
+//Only raises HighWaterBytes, UsedBytes is left to the caller
+static inline void AllocatorStats_InternRaiseHighWater(AllocatorStats* this, uint64_t usedBytes)
+{
+    uint64_t highWater = __atomic_load_n(&this->HighWaterBytes, __ATOMIC_RELAXED);
+    while(  usedBytes > highWater &&
+            !__atomic_compare_exchange_n(   &this->HighWaterBytes,
+                                            &highWater,
+                                            usedBytes,
+                                            true,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+    {
+    }
+}
+
+static inline void AllocatorStats_SetUsedBytes(AllocatorStats* this, uint64_t usedBytes)
+{
+    if(!this)
+        return;
+    
+    __atomic_store_n(&this->UsedBytes, usedBytes, __ATOMIC_RELAXED);
+    AllocatorStats_InternRaiseHighWater(this, usedBytes);
+}
+
+static inline void AllocatorStats_AddUsedBytes(AllocatorStats* this, int64_t deltaBytes)
+{
+    if(!this)
+        return;
+    
+    uint64_t usedBytes = __atomic_add_fetch(&this->UsedBytes, (uint64_t)deltaBytes, __ATOMIC_RELAXED);
+    if(deltaBytes > 0)
+        AllocatorStats_InternRaiseHighWater(this, usedBytes);
+}
+
+static inline void AllocatorStats_OnAlloc(AllocatorStats* this, uint64_t size)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->AllocCount, 1);
+    INTERN_ALLOC_PROFILE_ADD(&this->AllocBytes, size);
+}
+
+static inline void AllocatorStats_OnRealloc(AllocatorStats* this, uint64_t copiedBytes)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->ReallocCount, 1);
+    INTERN_ALLOC_PROFILE_ADD(&this->ReallocCopyBytes, copiedBytes);
+}
+
+static inline void AllocatorStats_OnFree(AllocatorStats* this, uint64_t wastedBytes)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->FreeCount, 1);
+    INTERN_ALLOC_PROFILE_ADD(&this->WastedFreeBytes, wastedBytes);
+}
+
+static inline void AllocatorStats_OnNewChain(AllocatorStats* this, uint64_t reservedBytes)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->ChainLength, 1);
+    INTERN_ALLOC_PROFILE_ADD(&this->ReservedBytes, reservedBytes);
+}
+
+static inline void AllocatorStats_OnReleaseChain(AllocatorStats* this, uint64_t reservedBytes)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->ChainLength, (uint64_t)-1);
+    INTERN_ALLOC_PROFILE_ADD(&this->ReservedBytes, (uint64_t)0 - reservedBytes);
+}
+
+static inline void AllocatorStats_OnCommit(AllocatorStats* this, uint64_t committedBytes)
+{
+    if(!this)
+        return;
+    INTERN_ALLOC_PROFILE_ADD(&this->ReservedBytes, committedBytes);
+}
+
+static inline void AllocatorStats_OnDestroy(AllocatorStats* this)
+{
+    if(!this)
+        return;
+    __atomic_store_n(&this->UsedBytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&this->Destroyed, true, __ATOMIC_RELAXED);
+}
+
+static inline void AllocatorProfile_RecordCallSite(const char* file, int32_t line, uint64_t size, bool realloc)
+{
+    #if ALLOCATOR_PROFILE && ALLOCATOR_PROFILE_CALL_SITES
+        //`__FILE__` is a literal so its address identifies the file
+        uint64_t key = ((uint64_t)(uintptr_t)file * 31) ^ (uint64_t)line;
+        key = key == 0 ? 1 : key;
+        uint64_t slotIndex = (key ^ (key >> 29)) * 0xbf58476d1ce4e5b9ull;
+        
+        for(uint32_t i = 0; i < ALLOCATOR_PROFILE_MAX_CALL_SITES; ++i)
+        {
+            AllocatorCallSite* callSite =
+                &AllocatorProfile_CallSites[(slotIndex + i) % ALLOCATOR_PROFILE_MAX_CALL_SITES];
+            uint64_t slotKey = __atomic_load_n(&callSite->Key, __ATOMIC_ACQUIRE);
+            if(slotKey == 0)
+            {
+                uint64_t expectedKey = 0;
+                if(__atomic_compare_exchange_n( &callSite->Key,
+                                                &expectedKey,
+                                                key,
+                                                false,
+                                                __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE))
+                {
+                    callSite->File = file;
+                    callSite->Line = line;
+                    slotKey = key;
+                }
+                else
+                    slotKey = expectedKey;
+            }
+            
+            if(slotKey != key)
+                continue;
+            
+            if(realloc)
+                INTERN_ALLOC_PROFILE_ADD(&callSite->ReallocCount, 1);
+            else
+                INTERN_ALLOC_PROFILE_ADD(&callSite->AllocCount, 1);
+            INTERN_ALLOC_PROFILE_ADD(&callSite->AllocBytes, size);
+            return;
+        }
+    #else
+        (void)file;
+        (void)line;
+        (void)size;
+        (void)realloc;
+    #endif
+}
+
+//Sums the counters of all records, all 0 when disabled. Compare two totals to see what was 
+//allocated in between
+static inline AllocatorStats AllocatorProfile_Totals(void)
+{
+    AllocatorStats retTotals = { .Name = "Total" };
+    #if ALLOCATOR_PROFILE
+        const AllocatorStats* sharedRecords[] = 
+        {
+            &AllocatorProfile_HeapRecord, 
+            &AllocatorProfile_CustomRecord, 
+            &AllocatorProfile_OverflowRecord 
+        };
+        
+        uint32_t recordsCount = __atomic_load_n(&AllocatorProfile_RecordsCount, __ATOMIC_ACQUIRE);
+        if(recordsCount > ALLOCATOR_PROFILE_MAX_ALLOCATORS)
+            recordsCount = ALLOCATOR_PROFILE_MAX_ALLOCATORS;
+        for(uint32_t i = 0; i < recordsCount + 3; ++i)
+        {
+            const AllocatorStats* record = i < 3 ? 
+                                            sharedRecords[i] : 
+                                            &AllocatorProfile_Records[i - 3];
+            retTotals.AllocCount += record->AllocCount;
+            retTotals.AllocBytes += record->AllocBytes;
+            retTotals.ReallocCount += record->ReallocCount;
+            retTotals.ReallocCopyBytes += record->ReallocCopyBytes;
+            retTotals.FreeCount += record->FreeCount;
+            retTotals.WastedFreeBytes += record->WastedFreeBytes;
+            retTotals.UsedBytes += record->UsedBytes;
+            retTotals.HighWaterBytes += record->HighWaterBytes;
+            retTotals.ReservedBytes += record->ReservedBytes;
+            retTotals.ChainLength += record->ChainLength;
+        }
+    #endif
+    return retTotals;
+}
+
+static inline void AllocatorStats_WriteJson(const AllocatorStats* this, FILE* file)
+{
+    fprintf(file,
+            "    {\"name\": \"%s\", \"allocCount\": %" PRIu64 ", \"allocBytes\": %" PRIu64 ", "
+            "\"reallocCount\": %" PRIu64 ", \"reallocCopyBytes\": %" PRIu64 ", "
+            "\"freeCount\": %" PRIu64 ", \"wastedFreeBytes\": %" PRIu64 ", "
+            "\"usedBytes\": %" PRIu64 ", \"highWaterBytes\": %" PRIu64 ", "
+            "\"reservedBytes\": %" PRIu64 ", \"chainLength\": %" PRIu64 ", \"destroyed\": %s}",
+            this->Name ? this->Name : "",
+            this->AllocCount,
+            this->AllocBytes,
+            this->ReallocCount,
+            this->ReallocCopyBytes,
+            this->FreeCount,
+            this->WastedFreeBytes,
+            this->UsedBytes,
+            this->HighWaterBytes,
+            this->ReservedBytes,
+            this->ChainLength,
+            this->Destroyed ? "true" : "false");
+}
+
+static inline void AllocatorProfile_WriteJson(FILE* file)
+{
+    #if ALLOCATOR_PROFILE
+        if(!file)
+            return;
+        
+        fprintf(file, "{\n  \"allocators\":\n  [\n");
+        AllocatorStats_WriteJson(&AllocatorProfile_HeapRecord, file);
+        fprintf(file, ",\n");
+        AllocatorStats_WriteJson(&AllocatorProfile_CustomRecord, file);
+        fprintf(file, ",\n");
+        AllocatorStats_WriteJson(&AllocatorProfile_OverflowRecord, file);
+        
+        uint32_t recordsCount = __atomic_load_n(&AllocatorProfile_RecordsCount, __ATOMIC_ACQUIRE);
+        if(recordsCount > ALLOCATOR_PROFILE_MAX_ALLOCATORS)
+            recordsCount = ALLOCATOR_PROFILE_MAX_ALLOCATORS;
+        for(uint32_t i = 0; i < recordsCount; ++i)
+        {
+            fprintf(file, ",\n");
+            AllocatorStats_WriteJson(&AllocatorProfile_Records[i], file);
+        }
+        fprintf(file, "\n  ],\n  \"callSites\":\n  [");
+        
+        #if ALLOCATOR_PROFILE_CALL_SITES
+            bool first = true;
+            for(uint32_t i = 0; i < ALLOCATOR_PROFILE_MAX_CALL_SITES; ++i)
+            {
+                const AllocatorCallSite* callSite = &AllocatorProfile_CallSites[i];
+                if(__atomic_load_n(&callSite->Key, __ATOMIC_ACQUIRE) == 0 || !callSite->File)
+                    continue;
+                
+                fprintf(file,
+                        "%s\n    {\"file\": \"%s\", \"line\": %" PRIi32 ", "
+                        "\"allocCount\": %" PRIu64 ", \"reallocCount\": %" PRIu64 ", "
+                        "\"allocBytes\": %" PRIu64 "}",
+                        first ? "" : ",",
+                        callSite->File,
+                        callSite->Line,
+                        callSite->AllocCount,
+                        callSite->ReallocCount,
+                        callSite->AllocBytes);
+                first = false;
+            }
+        #endif
+        
+        fprintf(file, "\n  ]\n}\n");
+    #else
+        (void)file;
+    #endif
+}
+
+static inline void AllocatorProfile_InternWriteJsonAtExit(void)
+{
+    #if ALLOCATOR_PROFILE
+        FILE* file = fopen(AllocatorProfile_ExitPath, "w");
+        if(!file)
+            return;
+        AllocatorProfile_WriteJson(file);
+        fclose(file);
+    #endif
+}
+
+//`path` must outlive the program
+static inline void AllocatorProfile_WriteJsonAtExit(const char* path)
+{
+    #if ALLOCATOR_PROFILE
+        if(!path)
+            return;
+        
+        bool registered = AllocatorProfile_ExitPath != NULL;
+        AllocatorProfile_ExitPath = path;
+        if(!registered)
+            atexit(AllocatorProfile_InternWriteJsonAtExit);
+    #else
+        (void)path;
+    #endif
+}
+
+#endif
@@ -0,0 +1,345 @@
+#ifndef MODC_ALLOCATOR_TRACE_H
+#define MODC_ALLOCATOR_TRACE_H
+
+/* Docs
+Allocation trace recording for Allocator.h, disabled by default. Requires GCC/Clang `__atomic`
+builtins.
+
+Define `ALLOCATOR_TRACE` to 1 to record every malloc, realloc, free, mark, rewind and destroy of
+every allocator into a compact binary log. Benchmarks/AllocReplay.c replays the log against other
+allocators and settings.
+
+Recording starts with `AllocatorTrace_Start()` and the log is flushed and closed with
+`AllocatorTrace_Stop()` or at exit. Allocators are registered on their first recorded call, so
+ones created before recording started are recorded as well. Calls from multiple threads are
+serialized with a spin lock, which changes the timing of threaded compiles but not what they
+allocate.
+
+Define `ALLOCATOR_TRACE_MAX_ALLOCATORS` to change how many allocators can be recorded at once.
+Calls to allocators past that are not recorded.
+
+The log starts with `ALLOCATOR_TRACE_MAGIC` and the `ALLOCATOR_TRACE_VERSION` byte, followed by one
+record per call. Each record is an `AllocatorTraceKind` byte followed by unsigned LEB128 fields:
+- Create:   allocator id, `AllocatorType`, arena/chunk/reserve size (0 for heap and custom)
+- Malloc:   allocator id, ns since last record, size, address
+- Realloc:  allocator id, ns since last record, old address, size, new address
+- Free:     allocator id, ns since last record, address
+- Mark:     allocator id, ns since last record
+- Rewind:   allocator id, ns since last record, mark number (1 for the first mark, 0 for reset)
+- Destroy:  allocator id, ns since last record
+
+Addresses are zigzag encoded differences from the previous address in the log. A Create record
+comes before the first use of an id, and ids are reused after Destroy.
+
+When disabled, all the functions are no-op.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef ALLOCATOR_TRACE
+    #define ALLOCATOR_TRACE 0
+#endif
+
+#ifndef ALLOCATOR_TRACE_MAX_ALLOCATORS
+    #define ALLOCATOR_TRACE_MAX_ALLOCATORS 1024
+#endif
+
+#ifndef ALLOCATOR_TRACE_BUFFER_SIZE
+    #define ALLOCATOR_TRACE_BUFFER_SIZE (64 * 1024)
+#endif
+
+#define ALLOCATOR_TRACE_MAGIC "MCAT"
+#define ALLOCATOR_TRACE_VERSION 1
+
+//Largest record, the kind and 5 fields of at most 10 bytes
+#define ALLOCATOR_TRACE_MAX_RECORD_SIZE 64
+
+typedef enum AllocatorTraceKind
+{
+    AllocatorTraceKind_Create,
+    AllocatorTraceKind_Malloc,
+    AllocatorTraceKind_Realloc,
+    AllocatorTraceKind_Free,
+    AllocatorTraceKind_Mark,
+    AllocatorTraceKind_Rewind,
+    AllocatorTraceKind_Destroy,
+    AllocatorTraceKind_Count
+} AllocatorTraceKind;
+
+#if ALLOCATOR_TRACE
+    typedef struct AllocatorTraceEntry
+    {
+        const void* Identity;       //What the allocator points to, NULL for heap
+        bool Used;
+    } AllocatorTraceEntry;
+    
+    //Everything below is only accessed with the lock held, except `AllocatorTrace_File`
+    static bool AllocatorTrace_Locked = false;
+    static FILE* AllocatorTrace_File = NULL;                    //Atomic
+    static bool AllocatorTrace_ExitRegistered = false;
+    static uint8_t AllocatorTrace_Buffer[ALLOCATOR_TRACE_BUFFER_SIZE];
+    static uint32_t AllocatorTrace_BufferLength = 0;
+    static AllocatorTraceEntry AllocatorTrace_Allocators[ALLOCATOR_TRACE_MAX_ALLOCATORS];
+    static uint32_t AllocatorTrace_AllocatorsEnd = 0;          //One past the last used entry
+    static uint32_t AllocatorTrace_LastId = 0;
+    static uint64_t AllocatorTrace_LastNs = 0;
+    static uint64_t AllocatorTrace_LastAddress = 0;
+    static uint64_t AllocatorTrace_MarksCount = 0;
+#endif
+
+static inline uint64_t AllocatorTrace_NowNs(void)
+{
+    #if defined(CLOCK_MONOTONIC)
+        struct timespec currentTime;
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        return (uint64_t)currentTime.tv_sec * 1000000000ull + (uint64_t)currentTime.tv_nsec;
+    #else
+        return (uint64_t)((double)clock() * (1000000000.0 / (double)CLOCKS_PER_SEC));
+    #endif
+}
+
+static inline bool AllocatorTrace_IsRecording(void)
+{
+    #if ALLOCATOR_TRACE
+        return __atomic_load_n(&AllocatorTrace_File, __ATOMIC_RELAXED) != NULL;
+    #else
+        return false;
+    #endif
+}
+
+#if ALLOCATOR_TRACE
+    static inline void AllocatorTrace_InternLock(void)
+    {
+        while(__atomic_test_and_set(&AllocatorTrace_Locked, __ATOMIC_ACQUIRE))
+        {
+        }
+    }
+    
+    static inline void AllocatorTrace_InternUnlock(void)
+    {
+        __atomic_clear(&AllocatorTrace_Locked, __ATOMIC_RELEASE);
+    }
+    
+    static inline void AllocatorTrace_InternFlush(void)
+    {
+        fwrite(AllocatorTrace_Buffer, 1, AllocatorTrace_BufferLength, AllocatorTrace_File);
+        AllocatorTrace_BufferLength = 0;
+    }
+    
+    static inline void AllocatorTrace_InternWriteByte(uint8_t value)
+    {
+        AllocatorTrace_Buffer[AllocatorTrace_BufferLength++] = value;
+    }
+    
+    static inline void AllocatorTrace_InternWriteVarint(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            AllocatorTrace_InternWriteByte((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        AllocatorTrace_InternWriteByte((uint8_t)value);
+    }
+    
+    static inline void AllocatorTrace_InternWriteAddress(const void* address)
+    {
+        uint64_t currentAddress = (uint64_t)(uintptr_t)address;
+        uint64_t delta = currentAddress - AllocatorTrace_LastAddress;
+        AllocatorTrace_InternWriteVarint((delta << 1) ^ ((uint64_t)0 - (delta >> 63)));
+        AllocatorTrace_LastAddress = currentAddress;
+    }
+    
+    //Starts a record of `kind` for allocator `id`
+    static inline void AllocatorTrace_InternBeginRecord(AllocatorTraceKind kind, uint32_t id)
+    {
+        //Room for this record and the one after it, a Create is followed by the call it is for
+        if( AllocatorTrace_BufferLength + 2 * ALLOCATOR_TRACE_MAX_RECORD_SIZE >
+            ALLOCATOR_TRACE_BUFFER_SIZE)
+        {
+            AllocatorTrace_InternFlush();
+        }
+        
+        AllocatorTrace_InternWriteByte((uint8_t)kind);
+        AllocatorTrace_InternWriteVarint(id);
+        if(kind == AllocatorTraceKind_Create)
+            return;
+        
+        uint64_t nowNs = AllocatorTrace_NowNs();
+        AllocatorTrace_InternWriteVarint(nowNs - AllocatorTrace_LastNs);
+        AllocatorTrace_LastNs = nowNs;
+    }
+    
+    //Returns `ALLOCATOR_TRACE_MAX_ALLOCATORS` if there's no entry left. Writes a Create record for
+    //new allocators.
+    static inline uint32_t AllocatorTrace_InternGetId(  const void* identity,
+                                                        uint32_t type,
+                                                        uint64_t configSize)
+    {
+        AllocatorTraceEntry* lastEntry = &AllocatorTrace_Allocators[AllocatorTrace_LastId];
+        if(lastEntry->Used && lastEntry->Identity == identity)
+            return AllocatorTrace_LastId;
+        
+        uint32_t freeId = ALLOCATOR_TRACE_MAX_ALLOCATORS;
+        for(uint32_t i = 0; i < AllocatorTrace_AllocatorsEnd; ++i)
+        {
+            if(!AllocatorTrace_Allocators[i].Used)
+            {
+                freeId = freeId == ALLOCATOR_TRACE_MAX_ALLOCATORS ? i : freeId;
+                continue;
+            }
+            
+            if(AllocatorTrace_Allocators[i].Identity == identity)
+            {
+                AllocatorTrace_LastId = i;
+                return i;
+            }
+        }
+        
+        if(freeId == ALLOCATOR_TRACE_MAX_ALLOCATORS)
+        {
+            if(AllocatorTrace_AllocatorsEnd == ALLOCATOR_TRACE_MAX_ALLOCATORS)
+                return ALLOCATOR_TRACE_MAX_ALLOCATORS;
+            freeId = AllocatorTrace_AllocatorsEnd++;
+        }
+        
+        AllocatorTrace_Allocators[freeId] = 
+            (AllocatorTraceEntry){ .Identity = identity, .Used = true };
+        AllocatorTrace_LastId = freeId;
+        
+        AllocatorTrace_InternBeginRecord(AllocatorTraceKind_Create, freeId);
+        AllocatorTrace_InternWriteVarint(type);
+        AllocatorTrace_InternWriteVarint(configSize);
+        return freeId;
+    }
+#endif
+
+//Records a call to the allocator `identity` of `AllocatorType` `type`, see Allocator.h for the
+//`configSize`. `value` is the size for Malloc and Realloc and the mark number for Rewind.
+//Returns the mark number for Mark, 0 otherwise or if not recorded.
+static inline uint64_t AllocatorTrace_Record(   AllocatorTraceKind kind,
+                                                const void* identity,
+                                                uint32_t type,
+                                                uint64_t configSize,
+                                                uint64_t value,
+                                                const void* address,
+                                                const void* newAddress)
+{
+    #if ALLOCATOR_TRACE
+        if(!AllocatorTrace_IsRecording())
+            return 0;
+        
+        uint64_t retMarkNumber = 0;
+        AllocatorTrace_InternLock();
+        
+        //Stopped while we were waiting for the lock
+        if(!AllocatorTrace_File)
+            goto unlock;
+        
+        uint32_t id = AllocatorTrace_InternGetId(identity, type, configSize);
+        if(id == ALLOCATOR_TRACE_MAX_ALLOCATORS)
+            goto unlock;
+        
+        AllocatorTrace_InternBeginRecord(kind, id);
+        switch(kind)
+        {
+            case AllocatorTraceKind_Malloc:
+                AllocatorTrace_InternWriteVarint(value);
+                AllocatorTrace_InternWriteAddress(address);
+                break;
+            case AllocatorTraceKind_Realloc:
+                AllocatorTrace_InternWriteAddress(address);
+                AllocatorTrace_InternWriteVarint(value);
+                AllocatorTrace_InternWriteAddress(newAddress);
+                break;
+            case AllocatorTraceKind_Free:
+                AllocatorTrace_InternWriteAddress(address);
+                break;
+            case AllocatorTraceKind_Mark:
+                retMarkNumber = ++AllocatorTrace_MarksCount;
+                break;
+            case AllocatorTraceKind_Rewind:
+                AllocatorTrace_InternWriteVarint(value);
+                break;
+            case AllocatorTraceKind_Destroy:
+                AllocatorTrace_Allocators[id].Used = false;
+                break;
+            default:
+                break;
+        }
+        
+        unlock:;
+        AllocatorTrace_InternUnlock();
+        return retMarkNumber;
+    #else
+        (void)kind;
+        (void)identity;
+        (void)type;
+        (void)configSize;
+        (void)value;
+        (void)address;
+        (void)newAddress;
+        return 0;
+    #endif
+}
+
+//Flushes and closes the log. Calls after this are not recorded.
+static inline void AllocatorTrace_Stop(void)
+{
+    #if ALLOCATOR_TRACE
+        AllocatorTrace_InternLock();
+        if(AllocatorTrace_File)
+        {
+            AllocatorTrace_InternFlush();
+            fclose(AllocatorTrace_File);
+            __atomic_store_n(&AllocatorTrace_File, NULL, __ATOMIC_RELAXED);
+        }
+        AllocatorTrace_InternUnlock();
+    #endif
+}
+
+//Starts recording into a new log at `path`, which is closed at exit. Returns false if it can't be
+//opened or recording is disabled.
+static inline bool AllocatorTrace_Start(const char* path)
+{
+    #if ALLOCATOR_TRACE
+        if(!path)
+            return false;
+        
+        AllocatorTrace_Stop();
+        FILE* file = fopen(path, "wb");
+        if(!file)
+            return false;
+        
+        AllocatorTrace_InternLock();
+        for(uint32_t i = 0; i < AllocatorTrace_AllocatorsEnd; ++i)
+            AllocatorTrace_Allocators[i].Used = false;
+        AllocatorTrace_AllocatorsEnd = 0;
+        AllocatorTrace_LastId = 0;
+        AllocatorTrace_LastNs = AllocatorTrace_NowNs();
+        AllocatorTrace_LastAddress = 0;
+        AllocatorTrace_MarksCount = 0;
+        AllocatorTrace_BufferLength = 0;
+        
+        for(uint32_t i = 0; i < sizeof(ALLOCATOR_TRACE_MAGIC) - 1; ++i)
+            AllocatorTrace_InternWriteByte((uint8_t)ALLOCATOR_TRACE_MAGIC[i]);
+        AllocatorTrace_InternWriteByte(ALLOCATOR_TRACE_VERSION);
+        
+        __atomic_store_n(&AllocatorTrace_File, file, __ATOMIC_RELAXED);
+        bool registerExit = !AllocatorTrace_ExitRegistered;
+        AllocatorTrace_ExitRegistered = true;
+        AllocatorTrace_InternUnlock();
+        
+        if(registerExit)
+            atexit(AllocatorTrace_Stop);
+        return true;
+    #else
+        (void)path;
+        return false;
+    #endif
+}
+
+#endif
@@ -0,0 +1,1016 @@
+#define ARENA_IMPLEMENTATION
+
+//Footprints come from the profile records. Every replay creates new records, so keep plenty.
+#define ALLOCATOR_PROFILE 1
+#define ALLOCATOR_PROFILE_MAX_ALLOCATORS (1 << 16)
+
+#include "ModC/Allocator.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Replays an allocation trace recorded with `ALLOCATOR_TRACE` (see AllocatorTrace.h) against other
+allocators and settings, and reports the time, peak footprint and fragmentation of each. Build ModC
+with `-DALLOCATOR_TRACE=1` and run it on a file to get a ModCAllocatorTrace.bin. build.sh builds
+this with and without `ALLOCATOR_NO_CANARY`.
+
+Usage: AllocReplay [options] <trace path>
+
+--strategies=<list>     Comma separated strategies from below (default all of them)
+--arena-size=<bytes>    Arena size for `arena` and `freelist`, 0 for the recorded sizes (default 0)
+--repetitions=<n>       Timed replays per strategy (default 5)
+
+recorded    Each allocator is replayed as its recorded type and size, custom ones on the heap
+heap        Every allocator is the heap
+arena       Every allocator is a chained arena, `REPLAY_DEFAULT_ARENA_SIZE` for recorded heaps
+virtual     Every allocator is a virtual arena, `REPLAY_VIRTUAL_RESERVE_SIZE` if not recorded as one
+freelist    Every allocator is a chained arena with size class free lists on top, as a custom
+            allocator. Sizes past the largest class go to the heap.
+
+Calls are replayed in the recorded order on one thread, and the memory is not touched other than by
+the allocators themselves. Rewinds, resets and destroys of an arena drop everything allocated in it
+after the mark, allocators that can't rewind free those one by one instead. Calls on memory that
+was allocated before the trace started are skipped.
+
+Time is the median +- median absolute deviation of the timed replays. The footprint is the reserved
+bytes of the arenas plus the used bytes of the heap, and fragmentation is how much of the peak
+footprint was not holding live allocations at that point.
+*/
+
+#if ALLOCATOR_NO_CANARY
+    #define CANARY_NAME "off"
+#else
+    #define CANARY_NAME "on"
+#endif
+
+#define REPLAY_DEFAULT_ARENA_SIZE ((uint64_t)64 * 1024)
+#define REPLAY_VIRTUAL_RESERVE_SIZE ((uint64_t)1024 * 1024 * 1024)
+#define REPLAY_NO_SLOT UINT32_MAX
+
+typedef enum ReplayStrategy
+{
+    ReplayStrategy_Recorded,
+    ReplayStrategy_Heap,
+    ReplayStrategy_Arena,
+    ReplayStrategy_Virtual,
+    ReplayStrategy_FreeList,
+    ReplayStrategy_Count
+} ReplayStrategy;
+
+static const char* ReplayStrategyNames[ReplayStrategy_Count] =
+{
+    "recorded", "heap", "arena", "virtual", "freelist"
+};
+
+typedef struct ReplayAllocatorInfo
+{
+    AllocatorType Type;                         //Always the owned type
+    uint64_t ConfigSize;                        //0 if not recorded
+} ReplayAllocatorInfo;
+
+typedef struct ReplaySlot
+{
+    uint64_t Address;                           //Recorded address
+    uint64_t Size;
+    uint32_t Allocator;                         //Index in `ReplayTrace.Allocators`
+    bool Live;                                  //Only while decoding, and at the end of the trace
+} ReplaySlot;
+
+typedef struct ReplayEvent
+{
+    AllocatorTraceKind Kind;
+    uint32_t Allocator;                         //Index in `ReplayTrace.Allocators`
+    
+    //Allocation made by Malloc/Realloc or freed by Free, mark of Mark/Rewind (`REPLAY_NO_SLOT`
+    //for a reset)
+    uint32_t Slot;
+    uint32_t OldSlot;                           //Realloc, `REPLAY_NO_SLOT` acts as Malloc
+    uint64_t Size;
+    int64_t LiveBytesDelta;
+    
+    //Rewind/Destroy, range in `ReplayTrace.DroppedSlots` of the allocations they drop
+    uint32_t DroppedBegin;
+    uint32_t DroppedEnd;
+} ReplayEvent;
+
+typedef struct ReplayMarkInfo
+{
+    uint32_t Allocator;
+    uint32_t SlotsCount;                        //Slots that existed when marked
+} ReplayMarkInfo;
+
+#define LIST_NAME ReplayAllocatorInfoList
+#define VALUE_TYPE ReplayAllocatorInfo
+#include "ModC/List.h"
+
+#define LIST_NAME ReplaySlotList
+#define VALUE_TYPE ReplaySlot
+#include "ModC/List.h"
+
+#define LIST_NAME ReplayEventList
+#define VALUE_TYPE ReplayEvent
+#include "ModC/List.h"
+
+#define LIST_NAME ReplayMarkInfoList
+#define VALUE_TYPE ReplayMarkInfo
+#include "ModC/List.h"
+
+#define LIST_NAME ReplayUint32List
+#define VALUE_TYPE uint32_t
+#include "ModC/List.h"
+
+#define LIST_NAME ReplayUint32ListList
+#define VALUE_TYPE ReplayUint32List
+#define VALUE_FREE ReplayUint32List_Free
+#include "ModC/List.h"
+
+//Recorded address to its live slot
+#define MAP_NAME ReplayAddressMap
+#define KEY_TYPE uint64_t
+#define VALUE_TYPE uint32_t
+#define KEY_HASH(key) HashMap_Mix(*(key))
+#define KEY_EQUAL(keyA, keyB) (*(keyA) == *(keyB))
+#include "ModC/HashMap.h"
+
+typedef struct ReplayTrace
+{
+    ReplayAllocatorInfoList Allocators;
+    ReplaySlotList Slots;
+    ReplayEventList Events;
+    ReplayMarkInfoList Marks;
+    ReplayUint32List DroppedSlots;
+    uint64_t RecordedNs;
+    uint64_t PeakLiveBytes;
+} ReplayTrace;
+
+static void ReplayTrace_Free(ReplayTrace* this)
+{
+    ReplayAllocatorInfoList_Free(&this->Allocators);
+    ReplaySlotList_Free(&this->Slots);
+    ReplayEventList_Free(&this->Events);
+    ReplayMarkInfoList_Free(&this->Marks);
+    ReplayUint32List_Free(&this->DroppedSlots);
+}
+
+//=======================================================================================
+//Decoding
+//=======================================================================================
+
+typedef struct ReplayReader
+{
+    const uint8_t* Data;
+    uint64_t Length;
+    uint64_t Index;
+    bool Failed;
+} ReplayReader;
+
+static uint64_t ReplayReader_Varint(ReplayReader* this)
+{
+    uint64_t retValue = 0;
+    for(uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        if(this->Index >= this->Length)
+            break;
+        
+        uint8_t byte = this->Data[this->Index++];
+        retValue |= (uint64_t)(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+            return retValue;
+    }
+    
+    this->Failed = true;
+    return 0;
+}
+
+//Addresses are zigzag encoded differences from the previous one
+static uint64_t ReplayReader_Address(ReplayReader* this, uint64_t* inOutLastAddress)
+{
+    uint64_t zigzag = ReplayReader_Varint(this);
+    uint64_t delta = (zigzag >> 1) ^ ((uint64_t)0 - (zigzag & 1));
+    *inOutLastAddress += delta;
+    return *inOutLastAddress;
+}
+
+typedef struct ReplayDecoder
+{
+    ReplayTrace* Trace;
+    ReplayUint32List IdToAllocator;             //Trace id to allocator index, or `REPLAY_NO_SLOT`
+    ReplayUint32ListList LiveSlots;             //Per allocator, in allocation order, with dead ones
+    ReplayAddressMap AddressToSlot;
+    uint64_t LiveBytes;
+    bool Failed;
+} ReplayDecoder;
+
+static void ReplayDecoder_KillSlot(ReplayDecoder* this, uint32_t slot)
+{
+    ReplaySlot* replaySlot = &this->Trace->Slots.Data[slot];
+    replaySlot->Live = false;
+    ReplayAddressMap_Remove(&this->AddressToSlot, &replaySlot->Address);
+    this->LiveBytes -= replaySlot->Size;
+}
+
+//Returns `REPLAY_NO_SLOT` if we failed to allocate
+static uint32_t ReplayDecoder_AddSlot( ReplayDecoder* this, 
+                                        uint32_t allocator, 
+                                        uint64_t address, 
+                                        uint64_t size)
+{
+    ReplayTrace* trace = this->Trace;
+    uint32_t slot = (uint32_t)trace->Slots.Length;
+    ReplayUint32List* liveSlots = &this->LiveSlots.Data[allocator];
+    uint64_t oldLiveLength = liveSlots->Length;
+    
+    //A missed free, the old allocation is gone
+    uint32_t* oldSlot = ReplayAddressMap_Get(&this->AddressToSlot, &address);
+    if(oldSlot)
+        ReplayDecoder_KillSlot(this, *oldSlot);
+    
+    ReplaySlot newSlot =
+    {
+        .Address = address,
+        .Size = size,
+        .Allocator = allocator,
+        .Live = true
+    };
+    ReplaySlotList_AddValue(&trace->Slots, newSlot);
+    ReplayUint32List_AddValue(liveSlots, slot);
+    if( trace->Slots.Length != slot + 1u ||
+        liveSlots->Length != oldLiveLength + 1 ||
+        !ReplayAddressMap_Set(&this->AddressToSlot, address, slot))
+    {
+        return REPLAY_NO_SLOT;
+    }
+    
+    this->LiveBytes += size;
+    if(this->LiveBytes > trace->PeakLiveBytes)
+        trace->PeakLiveBytes = this->LiveBytes;
+    return slot;
+}
+
+//Returns the live slot at `address`, or `REPLAY_NO_SLOT` if it was allocated before the trace
+static uint32_t ReplayDecoder_FindSlot(ReplayDecoder* this, uint64_t address)
+{
+    uint32_t* slot = ReplayAddressMap_Get(&this->AddressToSlot, &address);
+    return slot ? *slot : REPLAY_NO_SLOT;
+}
+
+//Kills every live slot of `event->Allocator` from `firstSlot` and records them as dropped
+static void ReplayDecoder_DropSlots(ReplayDecoder* this, ReplayEvent* event, uint32_t firstSlot)
+{
+    ReplayTrace* trace = this->Trace;
+    ReplayUint32List* liveSlots = &this->LiveSlots.Data[event->Allocator];
+    event->DroppedBegin = (uint32_t)trace->DroppedSlots.Length;
+    
+    uint64_t liveLength = liveSlots->Length;
+    while(liveLength > 0 && liveSlots->Data[liveLength - 1] >= firstSlot)
+    {
+        uint32_t slot = liveSlots->Data[--liveLength];
+        if(!trace->Slots.Data[slot].Live)
+            continue;
+        
+        ReplayDecoder_KillSlot(this, slot);
+        uint64_t oldDroppedLength = trace->DroppedSlots.Length;
+        ReplayUint32List_AddValue(&trace->DroppedSlots, slot);
+        this->Failed |= trace->DroppedSlots.Length != oldDroppedLength + 1;
+    }
+    
+    ReplayUint32List_Resize(liveSlots, liveLength);
+    event->DroppedEnd = (uint32_t)trace->DroppedSlots.Length;
+}
+
+static void ReplayDecoder_AddEvent(ReplayDecoder* this, ReplayEvent event)
+{
+    ReplayEventList* events = &this->Trace->Events;
+    uint64_t oldLength = events->Length;
+    ReplayEventList_AddValue(events, event);
+    this->Failed |= events->Length != oldLength + 1;
+}
+
+//Decodes one record after its kind byte. Returns false if the record is malformed.
+static bool ReplayDecoder_Record(   ReplayDecoder* this,
+                                    ReplayReader* reader,
+                                    AllocatorTraceKind kind,
+                                    uint64_t* inOutLastAddress)
+{
+    ReplayTrace* trace = this->Trace;
+    uint64_t id = ReplayReader_Varint(reader);
+    if(id >= UINT32_MAX)
+        return false;
+    
+    if(kind == AllocatorTraceKind_Create)
+    {
+        uint64_t type = ReplayReader_Varint(reader);
+        uint64_t configSize = ReplayReader_Varint(reader);
+        if(reader->Failed || type >= AllocatorType_Count)
+            return false;
+        
+        //Shared copies are the same allocator
+        static_assert((int)AllocatorType_Count == 10, "");
+        switch(type)
+        {
+            case AllocatorType_SharedArena:
+                type = AllocatorType_OwnedArena;
+                break;
+            case AllocatorType_SharedThreadArena:
+                type = AllocatorType_OwnedThreadArena;
+                break;
+            case AllocatorType_SharedCustom:
+                type = AllocatorType_OwnedCustom;
+                break;
+            case AllocatorType_SharedVirtualArena:
+                type = AllocatorType_OwnedVirtualArena;
+                break;
+            default:
+                break;
+        }
+        
+        uint32_t allocator = (uint32_t)trace->Allocators.Length;
+        ReplayAllocatorInfo info = { .Type = (AllocatorType)type, .ConfigSize = configSize };
+        ReplayAllocatorInfoList_AddValue(&trace->Allocators, info);
+        ReplayUint32ListList_AddValue(  &this->LiveSlots,
+                                        ReplayUint32List_Create(CreateHeapAllocator(), 0));
+        while(this->IdToAllocator.Length <= id && !this->Failed)
+        {
+            uint64_t oldLength = this->IdToAllocator.Length;
+            ReplayUint32List_AddValue(&this->IdToAllocator, REPLAY_NO_SLOT);
+            this->Failed |= this->IdToAllocator.Length != oldLength + 1;
+        }
+        
+        this->Failed |= trace->Allocators.Length != allocator + 1u ||
+                        this->LiveSlots.Length != allocator + 1u;
+        if(this->Failed)
+            return true;
+        
+        this->IdToAllocator.Data[id] = allocator;
+        ReplayDecoder_AddEvent(this, (ReplayEvent){ .Kind = kind, .Allocator = allocator });
+        return true;
+    }
+    
+    trace->RecordedNs += ReplayReader_Varint(reader);
+    if(id >= this->IdToAllocator.Length || this->IdToAllocator.Data[id] == REPLAY_NO_SLOT)
+        return false;
+    
+    ReplayEvent event =
+    {
+        .Kind = kind,
+        .Allocator = this->IdToAllocator.Data[id],
+        .Slot = REPLAY_NO_SLOT,
+        .OldSlot = REPLAY_NO_SLOT
+    };
+    const uint64_t oldLiveBytes = this->LiveBytes;
+    
+    switch(kind)
+    {
+        case AllocatorTraceKind_Malloc:
+        {
+            event.Size = ReplayReader_Varint(reader);
+            uint64_t address = ReplayReader_Address(reader, inOutLastAddress);
+            if(reader->Failed)
+                return false;
+            
+            event.Slot = ReplayDecoder_AddSlot(this, event.Allocator, address, event.Size);
+            this->Failed |= event.Slot == REPLAY_NO_SLOT;
+            break;
+        }
+        case AllocatorTraceKind_Realloc:
+        {
+            uint64_t oldAddress = ReplayReader_Address(reader, inOutLastAddress);
+            event.Size = ReplayReader_Varint(reader);
+            uint64_t newAddress = ReplayReader_Address(reader, inOutLastAddress);
+            if(reader->Failed)
+                return false;
+            
+            event.OldSlot = oldAddress ? ReplayDecoder_FindSlot(this, oldAddress) : REPLAY_NO_SLOT;
+            if(event.OldSlot != REPLAY_NO_SLOT)
+                ReplayDecoder_KillSlot(this, event.OldSlot);
+            
+            event.Slot = ReplayDecoder_AddSlot(this, event.Allocator, newAddress, event.Size);
+            this->Failed |= event.Slot == REPLAY_NO_SLOT;
+            break;
+        }
+        case AllocatorTraceKind_Free:
+        {
+            uint64_t address = ReplayReader_Address(reader, inOutLastAddress);
+            if(reader->Failed)
+                return false;
+            
+            event.Slot = ReplayDecoder_FindSlot(this, address);
+            if(event.Slot == REPLAY_NO_SLOT)
+                return true;
+            
+            //Freed with the allocator that made it, in case a different copy was used
+            event.Allocator = trace->Slots.Data[event.Slot].Allocator;
+            ReplayDecoder_KillSlot(this, event.Slot);
+            break;
+        }
+        case AllocatorTraceKind_Mark:
+        {
+            event.Slot = (uint32_t)trace->Marks.Length;
+            ReplayMarkInfo markInfo =
+            {
+                .Allocator = event.Allocator,
+                .SlotsCount = (uint32_t)trace->Slots.Length
+            };
+            ReplayMarkInfoList_AddValue(&trace->Marks, markInfo);
+            this->Failed |= trace->Marks.Length != event.Slot + 1u;
+            break;
+        }
+        case AllocatorTraceKind_Rewind:
+        {
+            uint64_t markNumber = ReplayReader_Varint(reader);
+            if(reader->Failed)
+                return false;
+            
+            //Marks are numbered from 1, 0 is a reset
+            uint32_t firstSlot = 0;
+            if(markNumber != 0)
+            {
+                if( markNumber > trace->Marks.Length ||
+                    trace->Marks.Data[markNumber - 1].Allocator != event.Allocator)
+                {
+                    return true;
+                }
+                
+                event.Slot = (uint32_t)(markNumber - 1);
+                firstSlot = trace->Marks.Data[event.Slot].SlotsCount;
+            }
+            ReplayDecoder_DropSlots(this, &event, firstSlot);
+            break;
+        }
+        case AllocatorTraceKind_Destroy:
+            ReplayDecoder_DropSlots(this, &event, 0);
+            this->IdToAllocator.Data[id] = REPLAY_NO_SLOT;
+            break;
+        default:
+            return false;
+    }
+    
+    if(reader->Failed)
+        return false;
+    
+    event.LiveBytesDelta = (int64_t)(this->LiveBytes - oldLiveBytes);
+    ReplayDecoder_AddEvent(this, event);
+    return true;
+}
+
+//Returns false if the trace can't be read
+static bool ReplayTrace_Load(const char* path, ReplayTrace* outTrace)
+{
+    FILE* file = fopen(path, "rb");
+    if(!file)
+    {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+    
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    uint8_t* fileContent = fileSize > 0 ? malloc((size_t)fileSize) : NULL;
+    size_t readSize = fileContent ? fread(fileContent, 1, (size_t)fileSize, file) : 0;
+    fclose(file);
+    
+    const uint64_t headerSize = sizeof(ALLOCATOR_TRACE_MAGIC) - 1 + 1;
+    if( !fileContent ||
+        readSize != (size_t)fileSize ||
+        (uint64_t)fileSize < headerSize ||
+        memcmp(fileContent, ALLOCATOR_TRACE_MAGIC, sizeof(ALLOCATOR_TRACE_MAGIC) - 1) != 0 ||
+        fileContent[headerSize - 1] != ALLOCATOR_TRACE_VERSION)
+    {
+        printf("Failed to read %s, or it is not an allocation trace\n", path);
+        free(fileContent);
+        return false;
+    }
+    
+    *outTrace = (ReplayTrace)
+    {
+        .Allocators = ReplayAllocatorInfoList_Create(CreateHeapAllocator(), 16),
+        .Slots = ReplaySlotList_Create(CreateHeapAllocator(), (uint64_t)fileSize / 4),
+        .Events = ReplayEventList_Create(CreateHeapAllocator(), (uint64_t)fileSize / 4),
+        .Marks = ReplayMarkInfoList_Create(CreateHeapAllocator(), 16),
+        .DroppedSlots = ReplayUint32List_Create(CreateHeapAllocator(), 64)
+    };
+    
+    ReplayDecoder decoder =
+    {
+        .Trace = outTrace,
+        .IdToAllocator = ReplayUint32List_Create(CreateHeapAllocator(), 16),
+        .LiveSlots = ReplayUint32ListList_Create(CreateHeapAllocator(), 16),
+        .AddressToSlot = ReplayAddressMap_Create(CreateHeapAllocator(), 1024)
+    };
+    
+    ReplayReader reader =
+    {
+        .Data = fileContent,
+        .Length = (uint64_t)fileSize,
+        .Index = headerSize
+    };
+    uint64_t lastAddress = 0;
+    bool retSuccess = true;
+    while(reader.Index < reader.Length && !decoder.Failed)
+    {
+        uint64_t recordIndex = reader.Index;
+        AllocatorTraceKind kind = (AllocatorTraceKind)reader.Data[reader.Index++];
+        if( kind >= AllocatorTraceKind_Count ||
+            !ReplayDecoder_Record(&decoder, &reader, kind, &lastAddress))
+        {
+            //The end of a log that was not closed can be cut, keep what we have
+            printf( "Malformed record at byte %" PRIu64 " of %s, replaying up to there\n",
+                    recordIndex,
+                    path);
+            break;
+        }
+    }
+    
+    if(decoder.Failed)
+    {
+        printf("Failed to allocate while decoding %s\n", path);
+        retSuccess = false;
+    }
+    
+    ReplayAddressMap_Free(&decoder.AddressToSlot);
+    ReplayUint32ListList_Free(&decoder.LiveSlots);
+    ReplayUint32List_Free(&decoder.IdToAllocator);
+    free(fileContent);
+    if(!retSuccess)
+        ReplayTrace_Free(outTrace);
+    return retSuccess;
+}
+
+//=======================================================================================
+//Free list allocator
+//=======================================================================================
+
+#define FREE_LIST_MIN_SIZE 16
+#define FREE_LIST_CLASSES_COUNT 13              //16 bytes to 64KB
+#define FREE_LIST_LARGE_CLASS UINT64_MAX
+
+//Before every block, keeps the data 16 bytes aligned
+typedef struct FreeListHeader
+{
+    uint64_t Size;
+    uint64_t Class;
+} FreeListHeader;
+
+typedef struct ReplayFreeList
+{
+    Allocator Backing;
+    Allocator Heap;
+    void* Heads[FREE_LIST_CLASSES_COUNT];       //Free blocks, the next one is stored in the data
+    CustomAllocator Custom;
+} ReplayFreeList;
+
+static uint64_t FreeList_Class(uint64_t size)
+{
+    uint64_t retClass = 0;
+    while(((uint64_t)FREE_LIST_MIN_SIZE << retClass) < size)
+    {
+        if(++retClass == FREE_LIST_CLASSES_COUNT)
+            return FREE_LIST_LARGE_CLASS;
+    }
+    return retClass;
+}
+
+static void* FreeList_Malloc(void* userData, uint64_t size)
+{
+    ReplayFreeList* this = userData;
+    uint64_t sizeClass = FreeList_Class(size);
+    FreeListHeader* header = NULL;
+    if(sizeClass == FREE_LIST_LARGE_CLASS)
+        header = Allocator_Malloc(&this->Heap, sizeof(FreeListHeader) + size);
+    else if(this->Heads[sizeClass])
+    {
+        header = this->Heads[sizeClass];
+        memcpy(&this->Heads[sizeClass], header + 1, sizeof(void*));
+    }
+    else
+    {
+        header = Allocator_Malloc(  &this->Backing,
+                                    sizeof(FreeListHeader) + (FREE_LIST_MIN_SIZE << sizeClass));
+    }
+    
+    if(!header)
+        return NULL;
+    
+    *header = (FreeListHeader){ .Size = size, .Class = sizeClass };
+    return header + 1;
+}
+
+static void FreeList_Free(void* userData, void* data)
+{
+    ReplayFreeList* this = userData;
+    if(!data)
+        return;
+    
+    FreeListHeader* header = (FreeListHeader*)data - 1;
+    if(header->Class == FREE_LIST_LARGE_CLASS)
+    {
+        Allocator_Free(&this->Heap, header);
+        return;
+    }
+    
+    memcpy(data, &this->Heads[header->Class], sizeof(void*));
+    this->Heads[header->Class] = header;
+}
+
+static void* FreeList_Realloc(void* userData, void* data, uint64_t size)
+{
+    ReplayFreeList* this = userData;
+    if(!data)
+        return FreeList_Malloc(userData, size);
+    
+    FreeListHeader* header = (FreeListHeader*)data - 1;
+    uint64_t sizeClass = FreeList_Class(size);
+    if(header->Class == sizeClass && sizeClass != FREE_LIST_LARGE_CLASS)
+    {
+        header->Size = size;
+        return data;
+    }
+    
+    if(header->Class == FREE_LIST_LARGE_CLASS && sizeClass == FREE_LIST_LARGE_CLASS)
+    {
+        header = Allocator_Realloc(&this->Heap, header, sizeof(FreeListHeader) + size);
+        if(!header)
+            return NULL;
+        header->Size = size;
+        return header + 1;
+    }
+    
+    void* newData = FreeList_Malloc(userData, size);
+    if(!newData)
+        return NULL;
+    memcpy(newData, data, header->Size < size ? header->Size : size);
+    FreeList_Free(userData, data);
+    return newData;
+}
+
+static void FreeList_Destroy(void* userData)
+{
+    ReplayFreeList* this = userData;
+    Allocator_Destroy(&this->Backing);
+    free(this);
+}
+
+static const AllocatorVTable FreeListVTable =
+{
+    .Malloc = FreeList_Malloc,
+    .Realloc = FreeList_Realloc,
+    .Free = FreeList_Free,
+    .Destroy = FreeList_Destroy
+};
+
+//=======================================================================================
+//Replaying
+//=======================================================================================
+
+typedef struct ReplayAllocator
+{
+    Allocator Allocator;
+    ThreadArenaPool* Pool;                      //Thread arenas only
+    ReplayFreeList* FreeList;                   //Free lists only, destroyed with `Allocator`
+    bool CanRewind;
+    uint64_t FootprintBytes;                    //Last measured
+} ReplayAllocator;
+
+static bool ReplayAllocator_Create( ReplayAllocator* this,
+                                    const ReplayAllocatorInfo* info,
+                                    ReplayStrategy strategy,
+                                    uint64_t arenaSize)
+{
+    *this = (ReplayAllocator){0};
+    uint64_t recordedSize = info->ConfigSize ? info->ConfigSize : REPLAY_DEFAULT_ARENA_SIZE;
+    arenaSize = arenaSize ? arenaSize : recordedSize;
+    
+    switch(strategy)
+    {
+        case ReplayStrategy_Recorded:
+        {
+            if(info->Type == AllocatorType_OwnedArena)
+                this->Allocator = CreateArenaAllocator(recordedSize);
+            else if(info->Type == AllocatorType_OwnedThreadArena)
+            {
+                this->Pool = CreateThreadArenaPool(recordedSize);
+                this->Allocator = CreateThreadArenaAllocator(this->Pool);
+            }
+            else if(info->Type == AllocatorType_OwnedVirtualArena)
+                this->Allocator = CreateVirtualArenaAllocator(recordedSize, false);
+            else
+                this->Allocator = CreateHeapAllocator();
+            break;
+        }
+        case ReplayStrategy_Heap:
+            this->Allocator = CreateHeapAllocator();
+            break;
+        case ReplayStrategy_Arena:
+            this->Allocator = CreateArenaAllocator(arenaSize);
+            break;
+        case ReplayStrategy_Virtual:
+        {
+            uint64_t reserveSize =  info->Type == AllocatorType_OwnedVirtualArena ?
+                                    recordedSize :
+                                    REPLAY_VIRTUAL_RESERVE_SIZE;
+            this->Allocator = CreateVirtualArenaAllocator(reserveSize, false);
+            break;
+        }
+        case ReplayStrategy_FreeList:
+        {
+            this->FreeList = calloc(1, sizeof(ReplayFreeList));
+            if(!this->FreeList)
+                return false;
+            
+            this->FreeList->Backing = CreateArenaAllocator(arenaSize);
+            this->FreeList->Heap = CreateHeapAllocator();
+            this->FreeList->Custom = (CustomAllocator)
+            {
+                .VTable = &FreeListVTable,
+                .UserData = this->FreeList
+            };
+            if(!this->FreeList->Backing.Allocator)
+            {
+                free(this->FreeList);
+                return false;
+            }
+            this->Allocator = CreateCustomAllocator(&this->FreeList->Custom);
+            break;
+        }
+        default:
+            break;
+    }
+    
+    this->CanRewind =   this->Allocator.Type != AllocatorType_Heap &&
+                        this->Allocator.Type != AllocatorType_OwnedCustom;
+    return this->Allocator.Type != AllocatorType_Invalid &&
+           (this->Allocator.Type == AllocatorType_Heap || this->Allocator.Allocator);
+}
+
+static void ReplayAllocator_Destroy(ReplayAllocator* this)
+{
+    Allocator_Destroy(&this->Allocator);
+    ThreadArenaPool_Destroy(this->Pool);
+    *this = (ReplayAllocator){0};
+}
+
+//Reserved bytes, the heap is measured on its own
+static uint64_t ReplayAllocator_FootprintBytes(const ReplayAllocator* this)
+{
+    if(this->FreeList)
+        return Allocator_GetStats(&this->FreeList->Backing).ReservedBytes;
+    return Allocator_GetStats(&this->Allocator).ReservedBytes;
+}
+
+typedef struct ReplayMemory
+{
+    uint64_t PeakFootprintBytes;
+    uint64_t LiveBytesAtPeak;
+} ReplayMemory;
+
+//Replays the whole trace once. Measures the footprint after every call if `outMemory` is not NULL,
+//which makes it slower. Returns false if an allocator can't be created or allocation failed.
+static bool Replay( const ReplayTrace* trace,
+                    ReplayStrategy strategy,
+                    uint64_t arenaSize,
+                    uint64_t* outElapsedNs,
+                    ReplayMemory* outMemory)
+{
+    ReplayAllocator* allocators = calloc(trace->Allocators.Length + 1, sizeof(ReplayAllocator));
+    void** slotPtrs = calloc(trace->Slots.Length + 1, sizeof(void*));
+    AllocatorMark* marks = calloc(trace->Marks.Length + 1, sizeof(AllocatorMark));
+    bool retSuccess = allocators && slotPtrs && marks;
+    
+    Allocator heapAllocator = CreateHeapAllocator();
+    const uint64_t baseHeapBytes = Allocator_GetStats(&heapAllocator).UsedBytes;
+    uint64_t footprintBytes = 0;
+    uint64_t liveBytes = 0;
+    
+    const uint64_t startNs = Benchmark_NowNs();
+    for(uint64_t i = 0; i < trace->Events.Length && retSuccess; ++i)
+    {
+        const ReplayEvent* event = &trace->Events.Data[i];
+        ReplayAllocator* allocator = &allocators[event->Allocator];
+        const uint64_t oldFootprintBytes = allocator->FootprintBytes;
+        switch(event->Kind)
+        {
+            case AllocatorTraceKind_Create:
+                retSuccess = ReplayAllocator_Create(allocator,
+                                                    &trace->Allocators.Data[event->Allocator],
+                                                    strategy,
+                                                    arenaSize);
+                break;
+            case AllocatorTraceKind_Malloc:
+                slotPtrs[event->Slot] = Allocator_Malloc(&allocator->Allocator, event->Size);
+                retSuccess = slotPtrs[event->Slot] != NULL || event->Size == 0;
+                break;
+            case AllocatorTraceKind_Realloc:
+                if(event->OldSlot == REPLAY_NO_SLOT)
+                    slotPtrs[event->Slot] = Allocator_Malloc(&allocator->Allocator, event->Size);
+                else
+                {
+                    slotPtrs[event->Slot] = Allocator_Realloc(  &allocator->Allocator,
+                                                                slotPtrs[event->OldSlot],
+                                                                event->Size);
+                }
+                retSuccess = slotPtrs[event->Slot] != NULL || event->Size == 0;
+                break;
+            case AllocatorTraceKind_Free:
+                Allocator_Free(&allocator->Allocator, slotPtrs[event->Slot]);
+                break;
+            case AllocatorTraceKind_Mark:
+                marks[event->Slot] = Allocator_Mark(&allocator->Allocator);
+                break;
+            case AllocatorTraceKind_Rewind:
+            case AllocatorTraceKind_Destroy:
+            {
+                if(!allocator->CanRewind)
+                {
+                    for(uint32_t j = event->DroppedBegin; j < event->DroppedEnd; ++j)
+                    {
+                        uint32_t slot = trace->DroppedSlots.Data[j];
+                        Allocator_Free(&allocator->Allocator, slotPtrs[slot]);
+                    }
+                }
+                
+                if(event->Kind == AllocatorTraceKind_Destroy)
+                    ReplayAllocator_Destroy(allocator);
+                else if(!allocator->CanRewind)
+                    break;
+                else if(event->Slot == REPLAY_NO_SLOT)
+                    Allocator_Reset(&allocator->Allocator);
+                else
+                    Allocator_Rewind(&allocator->Allocator, marks[event->Slot]);
+                break;
+            }
+            default:
+                break;
+        }
+        
+        if(!outMemory || !retSuccess)
+            continue;
+        
+        liveBytes += (uint64_t)event->LiveBytesDelta;
+        const uint64_t allocatorFootprint = ReplayAllocator_FootprintBytes(allocator);
+        footprintBytes += allocatorFootprint - oldFootprintBytes;
+        allocator->FootprintBytes = allocatorFootprint;
+        
+        const uint64_t totalBytes = footprintBytes +
+                                    Allocator_GetStats(&heapAllocator).UsedBytes - baseHeapBytes;
+        if(totalBytes > outMemory->PeakFootprintBytes)
+        {
+            outMemory->PeakFootprintBytes = totalBytes;
+            outMemory->LiveBytesAtPeak = liveBytes;
+        }
+    }
+    *outElapsedNs = Benchmark_NowNs() - startNs;
+    
+    //Whatever is still alive at the end of the trace, not timed
+    for(uint64_t i = 0; i < trace->Slots.Length && allocators && slotPtrs; ++i)
+    {
+        const ReplaySlot* slot = &trace->Slots.Data[i];
+        ReplayAllocator* allocator = &allocators[slot->Allocator];
+        if(slot->Live && slotPtrs[i] && !allocator->CanRewind)
+            Allocator_Free(&allocator->Allocator, slotPtrs[i]);
+    }
+    for(uint64_t i = 0; i < trace->Allocators.Length && allocators; ++i)
+        ReplayAllocator_Destroy(&allocators[i]);
+    
+    free(marks);
+    free(slotPtrs);
+    free(allocators);
+    return retSuccess;
+}
+
+#define REPLAY_OPTION(arg, name) \
+    (strncmp(arg, name, sizeof(name) - 1) == 0 ? arg + sizeof(name) - 1 : NULL)
+
+//Returns false if `list` has an unknown strategy
+static bool ParseStrategies(const char* list, bool outEnabled[ReplayStrategy_Count])
+{
+    for(int i = 0; i < ReplayStrategy_Count; ++i)
+        outEnabled[i] = false;
+    
+    while(*list)
+    {
+        uint64_t nameLength = strcspn(list, ",");
+        bool found = false;
+        for(int i = 0; i < ReplayStrategy_Count; ++i)
+        {
+            if( strlen(ReplayStrategyNames[i]) == nameLength &&
+                strncmp(list, ReplayStrategyNames[i], nameLength) == 0)
+            {
+                outEnabled[i] = true;
+                found = true;
+            }
+        }
+        
+        if(!found)
+        {
+            printf("Unknown strategy %.*s\n", (int)nameLength, list);
+            return false;
+        }
+        list += nameLength + (list[nameLength] == ',');
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t repetitions = 5;
+    uint64_t arenaSize = 0;
+    const char* tracePath = NULL;
+    bool enabledStrategies[ReplayStrategy_Count] = { true, true, true, true, true };
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value = NULL;
+        if((value = REPLAY_OPTION(argv[i], "--strategies=")))
+        {
+            if(!ParseStrategies(value, enabledStrategies))
+                return 1;
+        }
+        else if((value = REPLAY_OPTION(argv[i], "--arena-size=")))
+            arenaSize = strtoull(value, NULL, 10);
+        else if((value = REPLAY_OPTION(argv[i], "--repetitions=")))
+            repetitions = strtoull(value, NULL, 10);
+        else if(argv[i][0] == '-')
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else
+            tracePath = argv[i];
+    }
+    
+    if(!tracePath || repetitions == 0)
+    {
+        printf( "Usage: %s [--strategies=recorded,heap,arena,virtual,freelist] "
+                "[--arena-size=<bytes>] [--repetitions=<n>] <trace path>\n",
+                argv[0]);
+        return 1;
+    }
+    
+    ReplayTrace trace;
+    if(!ReplayTrace_Load(tracePath, &trace))
+        return 1;
+    
+    printf( "%s: %" PRIu64 " calls, %" PRIu64 " allocators, %" PRIu64 " allocations, "
+            "peak live %.1f KB, recorded over %.2f ms\n",
+            tracePath,
+            trace.Events.Length,
+            trace.Allocators.Length,
+            trace.Slots.Length,
+            (double)trace.PeakLiveBytes / 1024.0,
+            (double)trace.RecordedNs / 1e6);
+    printf( "Canaries %s, median +- MAD of %" PRIu64 " replays\n", CANARY_NAME, repetitions);
+    printf( "%-10s %12s %12s %16s %14s %14s\n",
+            "Strategy", "Time ms", "+- ms", "Peak footprint", "Live at peak", "Fragmentation");
+    
+    uint64_t* samples = calloc(repetitions * 2, sizeof(uint64_t));
+    int exitCode = samples ? 0 : 1;
+    for(int strategy = 0; strategy < ReplayStrategy_Count && samples; ++strategy)
+    {
+        if(!enabledStrategies[strategy])
+            continue;
+        
+        //The measured replay is the warmup as well
+        ReplayMemory memory = {0};
+        uint64_t elapsedNs = 0;
+        bool success = Replay(&trace, (ReplayStrategy)strategy, arenaSize, &elapsedNs, &memory);
+        for(uint64_t i = 0; i < repetitions && success; ++i)
+            success = Replay(&trace, (ReplayStrategy)strategy, arenaSize, &samples[i], NULL);
+        
+        if(!success)
+        {
+            printf( "%-10s failed to create an allocator or to allocate\n", 
+                    ReplayStrategyNames[strategy]);
+            exitCode = 1;
+            continue;
+        }
+        
+        const BenchmarkStats stats = 
+            Benchmark_ComputeStats(samples, samples + repetitions, repetitions);
+        const double fragmentation =    memory.PeakFootprintBytes == 0 ?
+                                        0.0 :
+                                        100.0 * (1.0 - (double)memory.LiveBytesAtPeak /
+                                                        (double)memory.PeakFootprintBytes);
+        printf( "%-10s %12.3f %12.3f %13.1f KB %11.1f KB %13.1f%%\n",
+                ReplayStrategyNames[strategy],
+                (double)stats.MedianNs / 1e6,
+                (double)stats.MadNs / 1e6,
+                (double)memory.PeakFootprintBytes / 1024.0,
+                (double)memory.LiveBytesAtPeak / 1024.0,
+                fragmentation);
+    }
+    
+    if(AllocatorProfile_RecordsCount > ALLOCATOR_PROFILE_MAX_ALLOCATORS)
+        printf("Ran out of profile records, footprints are not accurate. Use fewer repetitions.\n");
+    
+    free(samples);
+    ReplayTrace_Free(&trace);
+    return exitCode;
+}
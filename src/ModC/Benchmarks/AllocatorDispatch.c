@@ -0,0 +1,110 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+Compares the built-in allocator kinds against the same allocators called through an 
+`AllocatorVTable`, to make sure adding custom allocators doesn't slow down the built-in ones.
+*/
+
+#define ITERATIONS 10000000
+
+static void* HeapVTable_Malloc(void* userData, uint64_t size)
+{
+    (void)userData;
+    return malloc(size);
+}
+
+static void* HeapVTable_Realloc(void* userData, void* data, uint64_t size)
+{
+    (void)userData;
+    return realloc(data, size);
+}
+
+static void HeapVTable_Free(void* userData, void* data)
+{
+    (void)userData;
+    free(data);
+}
+
+static void* ArenaVTable_Malloc(void* userData, uint64_t size)
+{
+    return Allocator_Malloc(userData, size);
+}
+
+static void* ArenaVTable_Realloc(void* userData, void* data, uint64_t size)
+{
+    return Allocator_Realloc(userData, data, size);
+}
+
+static void ArenaVTable_Free(void* userData, void* data)
+{
+    Allocator_Free(userData, data);
+}
+
+static void ArenaVTable_Destroy(void* userData)
+{
+    Allocator_Destroy(userData);
+}
+
+int main(void)
+{
+    Allocator heapAllocator = CreateHeapAllocator();
+    BENCHMARK_RUN(  "Heap: Malloc + Free", 
+                    ITERATIONS,
+                    void* ptr = Allocator_Malloc(&heapAllocator, 32);
+                    Benchmark_Sink(ptr);
+                    Allocator_Free(&heapAllocator, ptr));
+    
+    const AllocatorVTable heapVTable =
+    {
+        .Malloc = HeapVTable_Malloc,
+        .Realloc = HeapVTable_Realloc,
+        .Free = HeapVTable_Free,
+    };
+    CustomAllocator heapCustom = { .VTable = &heapVTable };
+    Allocator heapCustomAllocator = CreateCustomAllocator(&heapCustom);
+    BENCHMARK_RUN(  "Custom (heap): Malloc + Free", 
+                    ITERATIONS,
+                    void* ptr = Allocator_Malloc(&heapCustomAllocator, 32);
+                    Benchmark_Sink(ptr);
+                    Allocator_Free(&heapCustomAllocator, ptr));
+    Allocator_Destroy(&heapCustomAllocator);
+    
+    Allocator arenaAllocator = CreateArenaAllocator(4096);
+    BENCHMARK_RUN(  "Arena: Malloc + Free", 
+                    ITERATIONS,
+                    void* ptr = Allocator_Malloc(&arenaAllocator, 32);
+                    Benchmark_Sink(ptr);
+                    Allocator_Free(&arenaAllocator, ptr));
+    
+    BENCHMARK_RUN(  "Arena: Malloc + Reset every 64", 
+                    ITERATIONS,
+                    Benchmark_Sink(Allocator_Malloc(&arenaAllocator, 32));
+                    if(modcBenchIter % 64 == 63)
+                        Allocator_Reset(&arenaAllocator));
+    Allocator_Destroy(&arenaAllocator);
+    
+    const AllocatorVTable arenaVTable =
+    {
+        .Malloc = ArenaVTable_Malloc,
+        .Realloc = ArenaVTable_Realloc,
+        .Free = ArenaVTable_Free,
+        .Destroy = ArenaVTable_Destroy,
+    };
+    Allocator wrappedArena = CreateArenaAllocator(4096);
+    CustomAllocator arenaCustom = { .VTable = &arenaVTable, .UserData = &wrappedArena };
+    Allocator arenaCustomAllocator = CreateCustomAllocator(&arenaCustom);
+    BENCHMARK_RUN(  "Custom (arena): Malloc + Free", 
+                    ITERATIONS,
+                    void* ptr = Allocator_Malloc(&arenaCustomAllocator, 32);
+                    Benchmark_Sink(ptr);
+                    Allocator_Free(&arenaCustomAllocator, ptr));
+    Allocator_Destroy(&arenaCustomAllocator);
+    
+    return 0;
+}
@@ -0,0 +1,514 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Defer.h"
+#include "ModC/Tokenization.h"
+#include "ModC/Classification.h"
+#include "ModC/Strings/StringBuilder.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Times each phase of the compiler and the whole driver over a set of corpus files, and compares the
+results against a stored baseline. bench.sh builds it, generates the corpus set and runs it.
+
+Usage: BenchRunner [options] <corpus path>...
+
+--warmup=<n>            Untimed runs per corpus before the timed ones (default 3)
+--repetitions=<n>       Timed runs per corpus (default 15)
+--output=<path>         Writes the results as JSON
+--baseline=<path>       Compares against results written by an earlier `--output`
+--threshold=<percent>   Slowdown of the median that counts as a regression (default 5)
+
+"Driver" is everything main.c does for a file except reading it and writing the dump out, so it
+includes the arenas, the token dump and the statement dump. Phases after one that fails on a
+corpus are not reported for it, `actions.modc` for example only gets through statement building.
+
+A phase regresses if its median is more than the threshold slower than the baseline, and the
+difference is more than 3 times the combined median absolute deviations, so noisy phases don't
+flag on their own. Returns 2 if anything regressed.
+*/
+
+typedef enum BenchPhase
+{
+    BenchPhase_Tokenize,
+    BenchPhase_Statements,
+    BenchPhase_Classify,
+    BenchPhase_Driver,
+    BenchPhase_Count
+} BenchPhase;
+
+static const char* BenchPhaseNames[BenchPhase_Count] =
+{
+    "Tokenize", "Statements", "Classify", "Driver"
+};
+
+typedef struct BenchResult
+{
+    const char* Corpus;                         //Points into argv or the baseline file
+    BenchPhase Phase;
+    uint64_t Bytes;
+    BenchmarkStats Stats;
+} BenchResult;
+
+#define LIST_NAME BenchResultList
+#define VALUE_TYPE BenchResult
+#include "ModC/List.h"
+
+//Returns false if allocation failed
+static bool BenchResultList_Add(BenchResultList* list, BenchResult result)
+{
+    const uint64_t oldLength = list->Length;
+    return BenchResultList_AddValue(list, result)->Length == oldLength + 1;
+}
+
+//Runs what main.c does on `source` once. Returns how many phases finished, `BenchPhase_Count` if
+//all of them did
+static uint32_t RunDriver(ConstStringView source, uint64_t outPhaseNs[BenchPhase_Count])
+{
+    #undef ResultNameState
+    #define ResultNameState Result_Void
+    
+    uint32_t finishedPhases = 0;
+    const uint64_t driverStart = Benchmark_NowNs();
+    
+    Allocator mainArena = CreateVirtualArenaAllocator(source.Length * 64 + (64 << 20), false);
+    if(!mainArena.Allocator)
+        mainArena = CreateArenaAllocator(source.Length);
+    Allocator scratchArena = CreateArenaAllocator(4096);
+    Allocator statementListArena = {0};
+    StringBuilder printBuilder = StringBuilder_Create(Allocator_Share(&mainArena), 0);
+    
+    uint64_t phaseStart = Benchmark_NowNs();
+    Result_TokenList tokenListResult = Tokenization(source, Allocator_Share(&mainArena));
+    outPhaseNs[BenchPhase_Tokenize] = Benchmark_NowNs() - phaseStart;
+    if(tokenListResult.HasError)
+        goto exitPoint;
+    TokenList* tokenList = &tokenListResult.ValueOrError.Value;
+    ++finishedPhases;
+    
+    for(int i = 0; i < tokenList->Length; ++i)
+    {
+        StringBuilder_AppendLiteral(&printBuilder, "Token: \"");
+        StringBuilder_AppendView(&printBuilder, Token_TokenTextView(&tokenList->Data[i]));
+        StringBuilder_AppendLiteral(&printBuilder, "\", Token Type[");
+        StringBuilder_AppendInt(&printBuilder, i);
+        StringBuilder_AppendLiteral(&printBuilder, "]: ");
+        StringBuilder_AppendView(&printBuilder, TokenType_ToCStr(tokenList->Data[i].TokenType));
+        StringBuilder_AppendChar(&printBuilder, '\n');
+    }
+    
+    phaseStart = Benchmark_NowNs();
+    Result_StatementList statementListResult = CreateStatements(  tokenList,
+                                                                    source,
+                                                                    Allocator_Share(&mainArena),
+                                                                    &statementListArena);
+    outPhaseNs[BenchPhase_Statements] = Benchmark_NowNs() - phaseStart;
+    if(statementListResult.HasError)
+        goto freeTokens;
+    StatementList* statementList = &statementListResult.ValueOrError.Value;
+    ++finishedPhases;
+    
+    phaseStart = Benchmark_NowNs();
+    Result_Void voidResult =
+        CleanAndClassifyStatements( statementList,
+                                    Allocator_Share(&mainArena),
+                                    Allocator_Share(&statementListArena),
+                                    tokenList,
+                                    source,
+                                    Allocator_Share(&scratchArena));
+    outPhaseNs[BenchPhase_Classify] = Benchmark_NowNs() - phaseStart;
+    if(voidResult.HasError)
+        goto freeStatements;
+    ++finishedPhases;
+    
+    for(int i = 0; i < statementList->Length; ++i)
+    {
+        StringBuilder_AppendLiteral(&printBuilder, "statementList[");
+        StringBuilder_AppendInt(&printBuilder, i);
+        StringBuilder_AppendLiteral(&printBuilder, "]: ");
+        voidResult = Statement_ToString(StatementList_At(statementList, i),
+                                        tokenList,
+                                        &printBuilder);
+        if(voidResult.HasError)
+            goto freeStatements;
+        StringBuilder_AppendChar(&printBuilder, '\n');
+    }
+    ++finishedPhases;
+    Benchmark_Sink((void*)(uintptr_t)printBuilder.Length);
+    
+    freeStatements:;
+    Allocator_Destroy(&statementListArena);
+    freeTokens:;
+    TokenList_Free(tokenList);
+    exitPoint:;
+    //Errors are only counted, free them all at once
+    Result_ResetErrorArena();
+    Allocator_Destroy(&scratchArena);
+    Allocator_Destroy(&mainArena);
+    outPhaseNs[BenchPhase_Driver] = Benchmark_NowNs() - driverStart;
+    return finishedPhases;
+}
+
+static const char* BaseName(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+//Returns false if the file can't be read
+static bool BenchCorpus(const char* path,
+                        uint64_t warmupCount,
+                        uint64_t repetitions,
+                        BenchResultList* outResults)
+{
+    FILE* sourceFile = fopen(path, "rb");
+    if(!sourceFile)
+    {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+    
+    fseek(sourceFile, 0, SEEK_END);
+    long fileSize = ftell(sourceFile);
+    fseek(sourceFile, 0, SEEK_SET);
+    
+    Allocator heapAllocator = CreateHeapAllocator();
+    AlignedString fileContent = AlignedString_Create(Allocator_Share(&heapAllocator), fileSize);
+    AlignedString_Resize(&fileContent, fileSize);
+    size_t readSize = fread(fileContent.Data, 1, fileSize, sourceFile);
+    fclose(sourceFile);
+    
+    uint64_t* samples = calloc(repetitions * (BenchPhase_Count + 1), sizeof(uint64_t));
+    if(fileSize <= 0 || readSize != (size_t)fileSize || !samples)
+    {
+        printf("Failed to read %s\n", path);
+        free(samples);
+        AlignedString_Free(&fileContent);
+        return false;
+    }
+    
+    ConstStringView source = ConstStringView_Create(fileContent.Data, fileContent.Length);
+    uint64_t phaseNs[BenchPhase_Count];
+    for(uint64_t i = 0; i < warmupCount; ++i)
+        RunDriver(source, phaseNs);
+    
+    //Samples are laid out by phase, with room for the deviations after them
+    uint32_t finishedPhases = BenchPhase_Count;
+    for(uint64_t i = 0; i < repetitions; ++i)
+    {
+        const uint32_t finished = RunDriver(source, phaseNs);
+        finishedPhases = finished < finishedPhases ? finished : finishedPhases;
+        for(int phase = 0; phase < BenchPhase_Count; ++phase)
+            samples[phase * repetitions + i] = phaseNs[phase];
+    }
+    
+    if(finishedPhases < BenchPhase_Count)
+    {
+        printf( "%s: Stops after %s\n",
+                path,
+                finishedPhases > 0 ? BenchPhaseNames[finishedPhases - 1] : "reading");
+    }
+    
+    //The driver only counts if every phase finished
+    for(uint32_t phase = 0; phase < BenchPhase_Count; ++phase)
+    {
+        if(phase >= finishedPhases)
+            break;
+        
+        BenchResult result =
+        {
+            .Corpus = BaseName(path),
+            .Phase = (BenchPhase)phase,
+            .Bytes = (uint64_t)fileSize,
+            .Stats = Benchmark_ComputeStats(&samples[phase * repetitions],
+                                            &samples[BenchPhase_Count * repetitions],
+                                            repetitions)
+        };
+        if(!BenchResultList_Add(outResults, result))
+        {
+            free(samples);
+            AlignedString_Free(&fileContent);
+            return false;
+        }
+        
+        printf( "%-24s %-12s %12.3f ms  +- %9.3f ms  %8.2f MB/s\n",
+                result.Corpus,
+                BenchPhaseNames[phase],
+                (double)result.Stats.MedianNs / 1e6,
+                (double)result.Stats.MadNs / 1e6,
+                (double)result.Bytes / (double)result.Stats.MedianNs * 1e9 / (1024.0 * 1024.0));
+    }
+    
+    free(samples);
+    AlignedString_Free(&fileContent);
+    return true;
+}
+
+static void AppendJsonString(StringBuilder* builder, const char* str)
+{
+    StringBuilder_AppendChar(builder, '"');
+    for(; *str; ++str)
+    {
+        if(*str == '"' || *str == '\\')
+            StringBuilder_AppendChar(builder, '\\');
+        StringBuilder_AppendChar(builder, *str);
+    }
+    StringBuilder_AppendChar(builder, '"');
+}
+
+//One result per line, which is what `LoadBaseline()` reads back
+static bool WriteResults(   const char* path,
+                            const BenchResultList* results,
+                            uint64_t warmupCount,
+                            uint64_t repetitions)
+{
+    FILE* file = fopen(path, "wb");
+    if(!file)
+        return false;
+    
+    StringBuilder builder = StringBuilder_Create(CreateHeapAllocator(), 0);
+    StringBuilder_AppendLiteral(&builder, "{\"warmup\": ");
+    StringBuilder_AppendUInt(&builder, warmupCount);
+    StringBuilder_AppendLiteral(&builder, ", \"repetitions\": ");
+    StringBuilder_AppendUInt(&builder, repetitions);
+    StringBuilder_AppendLiteral(&builder, ", \"results\": [");
+    for(uint64_t i = 0; i < results->Length; ++i)
+    {
+        const BenchResult* result = &results->Data[i];
+        if(i > 0)
+            StringBuilder_AppendChar(&builder, ',');
+        StringBuilder_AppendLiteral(&builder, "\n{\"corpus\": ");
+        AppendJsonString(&builder, result->Corpus);
+        StringBuilder_AppendLiteral(&builder, ", \"phase\": ");
+        AppendJsonString(&builder, BenchPhaseNames[result->Phase]);
+        StringBuilder_AppendLiteral(&builder, ", \"bytes\": ");
+        StringBuilder_AppendUInt(&builder, result->Bytes);
+        StringBuilder_AppendLiteral(&builder, ", \"median_ns\": ");
+        StringBuilder_AppendUInt(&builder, result->Stats.MedianNs);
+        StringBuilder_AppendLiteral(&builder, ", \"mad_ns\": ");
+        StringBuilder_AppendUInt(&builder, result->Stats.MadNs);
+        StringBuilder_AppendLiteral(&builder, ", \"min_ns\": ");
+        StringBuilder_AppendUInt(&builder, result->Stats.MinNs);
+        StringBuilder_AppendChar(&builder, '}');
+    }
+    StringBuilder_AppendLiteral(&builder, "\n]}\n");
+    
+    bool succeeded = StringBuilder_WriteToFile(&builder, file);
+    StringBuilder_Free(&builder);
+    return fclose(file) == 0 && succeeded;
+}
+
+//Finds `"key": ` in `line` and returns what follows it, NULL if it's not there
+static char* FindJsonValue(char* line, const char* key)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    char* found = strstr(line, pattern);
+    return found ? found + strlen(pattern) : NULL;
+}
+
+//Reads the results written by `WriteResults()`. Corpus names point into `outFileContent`, which
+//the caller frees
+static bool LoadBaseline(const char* path, BenchResultList* outResults, char** outFileContent)
+{
+    FILE* file = fopen(path, "rb");
+    if(!file)
+        return false;
+    
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = fileSize > 0 ? malloc(fileSize + 1) : NULL;
+    bool succeeded = content && fread(content, 1, fileSize, file) == (size_t)fileSize;
+    fclose(file);
+    if(!succeeded)
+    {
+        free(content);
+        return false;
+    }
+    content[fileSize] = '\0';
+    *outFileContent = content;
+    
+    for(char* line = strtok(content, "\n"); line; line = strtok(NULL, "\n"))
+    {
+        char* corpus = FindJsonValue(line, "corpus");
+        char* phase = FindJsonValue(line, "phase");
+        char* bytes = FindJsonValue(line, "bytes");
+        char* median = FindJsonValue(line, "median_ns");
+        char* mad = FindJsonValue(line, "mad_ns");
+        char* min = FindJsonValue(line, "min_ns");
+        if(!corpus || !phase || !bytes || !median || !mad || !min)
+            continue;
+        
+        //Names are written without escapes by us, cut them at the closing quote
+        char* corpusEnd = strchr(corpus + 1, '"');
+        char* phaseEnd = strchr(phase + 1, '"');
+        if(*corpus != '"' || *phase != '"' || !corpusEnd || !phaseEnd)
+            continue;
+        *corpusEnd = '\0';
+        *phaseEnd = '\0';
+        
+        BenchResult result =
+        {
+            .Corpus = corpus + 1,
+            .Phase = BenchPhase_Count,
+            .Bytes = strtoull(bytes, NULL, 10),
+            .Stats =
+            {
+                .MedianNs = strtoull(median, NULL, 10),
+                .MadNs = strtoull(mad, NULL, 10),
+                .MinNs = strtoull(min, NULL, 10)
+            }
+        };
+        for(int i = 0; i < BenchPhase_Count; ++i)
+        {
+            if(strcmp(phase + 1, BenchPhaseNames[i]) == 0)
+                result.Phase = (BenchPhase)i;
+        }
+        if(result.Phase != BenchPhase_Count && !BenchResultList_Add(outResults, result))
+            return false;
+    }
+    return true;
+}
+
+//Returns the number of regressions
+static uint32_t CompareWithBaseline(const BenchResultList* results,
+                                    const BenchResultList* baseline,
+                                    double thresholdPercent)
+{
+    uint32_t regressionsCount = 0;
+    printf("\nCompared with the baseline:\n");
+    for(uint64_t i = 0; i < results->Length; ++i)
+    {
+        const BenchResult* current = &results->Data[i];
+        const BenchResult* base = NULL;
+        for(uint64_t j = 0; j < baseline->Length && !base; ++j)
+        {
+            if( baseline->Data[j].Phase == current->Phase &&
+                strcmp(baseline->Data[j].Corpus, current->Corpus) == 0)
+            {
+                base = &baseline->Data[j];
+            }
+        }
+        
+        if(!base || base->Stats.MedianNs == 0)
+        {
+            printf( "%-24s %-12s  not in the baseline\n",
+                    current->Corpus,
+                    BenchPhaseNames[current->Phase]);
+            continue;
+        }
+        
+        const double change =  ((double)current->Stats.MedianNs - (double)base->Stats.MedianNs) /
+                                (double)base->Stats.MedianNs * 100.0;
+        const double noise = 3.0 * (double)(current->Stats.MadNs + base->Stats.MadNs);
+        const bool regressed =
+            change > thresholdPercent &&
+            (double)current->Stats.MedianNs - (double)base->Stats.MedianNs > noise;
+        const bool sameInput = current->Bytes == base->Bytes;
+        
+        printf( "%-24s %-12s %+8.2f%%%s%s\n",
+                current->Corpus,
+                BenchPhaseNames[current->Phase],
+                change,
+                regressed ? "  REGRESSION" : "",
+                sameInput ? "" : "  (corpus size changed)");
+        regressionsCount += regressed;
+    }
+    return regressionsCount;
+}
+
+#define BENCH_OPTION(arg, name) \
+    (strncmp(arg, name, sizeof(name) - 1) == 0 ? arg + sizeof(name) - 1 : NULL)
+
+int main(int argc, char* argv[])
+{
+    uint64_t warmupCount = 3;
+    uint64_t repetitions = 15;
+    double thresholdPercent = 5.0;
+    const char* outputPath = NULL;
+    const char* baselinePath = NULL;
+    int corpusCount = 0;
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value = NULL;
+        if((value = BENCH_OPTION(argv[i], "--warmup=")))
+            warmupCount = strtoull(value, NULL, 10);
+        else if((value = BENCH_OPTION(argv[i], "--repetitions=")))
+            repetitions = strtoull(value, NULL, 10);
+        else if((value = BENCH_OPTION(argv[i], "--output=")))
+            outputPath = value;
+        else if((value = BENCH_OPTION(argv[i], "--baseline=")))
+            baselinePath = value;
+        else if((value = BENCH_OPTION(argv[i], "--threshold=")))
+            thresholdPercent = strtod(value, NULL);
+        else if(argv[i][0] == '-')
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else
+            ++corpusCount;
+    }
+    
+    if(corpusCount == 0 || repetitions == 0)
+    {
+        printf( "Usage: %s [--warmup=<n>] [--repetitions=<n>] [--output=<path>] "
+                "[--baseline=<path>] [--threshold=<percent>] <corpus path>...\n",
+                argv[0]);
+        return 1;
+    }
+    
+    printf( "%"PRIu64" warmup and %"PRIu64" timed runs per corpus, median +- MAD\n",
+            warmupCount,
+            repetitions);
+    
+    BenchResultList results = BenchResultList_Create(CreateHeapAllocator(), 64);
+    BenchResultList baseline = BenchResultList_Create(CreateHeapAllocator(), 64);
+    char* baselineContent = NULL;
+    int exitCode = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(argv[i][0] != '-' && !BenchCorpus(argv[i], warmupCount, repetitions, &results))
+            goto exitPoint;
+    }
+    
+    if(outputPath && !WriteResults(outputPath, &results, warmupCount, repetitions))
+    {
+        printf("Failed to write %s\n", outputPath);
+        goto exitPoint;
+    }
+    exitCode = 0;
+    
+    if(baselinePath)
+    {
+        if(!LoadBaseline(baselinePath, &baseline, &baselineContent))
+        {
+            printf("Failed to read baseline %s\n", baselinePath);
+            exitCode = 1;
+            goto exitPoint;
+        }
+        
+        const uint32_t regressionsCount = 
+            CompareWithBaseline(&results, &baseline, thresholdPercent);
+        if(regressionsCount > 0)
+        {
+            printf("%"PRIu32" regressions over %.1f%%\n", regressionsCount, thresholdPercent);
+            exitCode = 2;
+        }
+    }
+    
+    exitPoint:;
+    free(baselineContent);
+    BenchResultList_Free(&baseline);
+    BenchResultList_Free(&results);
+    return exitCode;
+}
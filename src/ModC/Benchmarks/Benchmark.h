@@ -0,0 +1,92 @@
+#ifndef MODC_BENCHMARKS_BENCHMARK_H
+#define MODC_BENCHMARKS_BENCHMARK_H
+
+/* Docs
+Helpers shared by the benchmarks.
+
+`BENCHMARK_RUN(name, iterations, statements)` runs `statements` `iterations` times and prints the 
+average time per iteration. Use `Benchmark_Sink` to stop the compiler from removing the work.
+
+`Benchmark_ComputeStats()` gives the median, median absolute deviation and minimum of a set of 
+timed samples, which hold up better against the odd slow run than the mean does.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct BenchmarkStats
+{
+    uint64_t MedianNs;
+    uint64_t MadNs;
+    uint64_t MinNs;
+} BenchmarkStats;
+
+static volatile uint64_t Benchmark_SinkValue = 0;
+
+static inline uint64_t Benchmark_NowNs(void)
+{
+    struct timespec currentTime;
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    return (uint64_t)currentTime.tv_sec * 1000000000ull + (uint64_t)currentTime.tv_nsec;
+}
+
+static inline void Benchmark_Sink(const void* ptr)
+{
+    Benchmark_SinkValue += (uint64_t)(uintptr_t)ptr;
+}
+
+static inline int Benchmark_InternCompareNs(const void* a, const void* b)
+{
+    const uint64_t valueA = *(const uint64_t*)a;
+    const uint64_t valueB = *(const uint64_t*)b;
+    return (valueA > valueB) - (valueA < valueB);
+}
+
+static inline uint64_t Benchmark_InternSortedMedian(const uint64_t* sorted, uint64_t count)
+{
+    if(count == 0)
+        return 0;
+    if(count % 2 == 1)
+        return sorted[count / 2];
+    return (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+}
+
+//Sorts `samples` and reuses `scratch` (same count) for the deviations
+static inline BenchmarkStats Benchmark_ComputeStats(uint64_t* samples, 
+                                                    uint64_t* scratch, 
+                                                    uint64_t count)
+{
+    if(count == 0)
+        return (BenchmarkStats){0};
+    
+    qsort(samples, count, sizeof(uint64_t), Benchmark_InternCompareNs);
+    const uint64_t median = Benchmark_InternSortedMedian(samples, count);
+    for(uint64_t i = 0; i < count; ++i)
+        scratch[i] = samples[i] > median ? samples[i] - median : median - samples[i];
+    qsort(scratch, count, sizeof(uint64_t), Benchmark_InternCompareNs);
+    
+    return (BenchmarkStats)
+    {
+        .MedianNs = median,
+        .MadNs = Benchmark_InternSortedMedian(scratch, count),
+        .MinNs = samples[0]
+    };
+}
+
+#define BENCHMARK_RUN(name, iterations, ... /* statements */) \
+    do \
+    { \
+        uint64_t modcBenchStart = Benchmark_NowNs(); \
+        for(uint64_t modcBenchIter = 0; modcBenchIter < (iterations); ++modcBenchIter) \
+        { \
+            __VA_ARGS__; \
+        } \
+        uint64_t modcBenchElapsed = Benchmark_NowNs() - modcBenchStart; \
+        printf( "%-48s %10.2f ns/iter\n", \
+                name, \
+                (double)modcBenchElapsed / (double)(iterations)); \
+    } while(0)
+
+#endif
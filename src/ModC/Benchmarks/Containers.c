@@ -0,0 +1,301 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Micro-benchmarks of the containers and allocators every phase is built on. build.sh builds it with
+and without `ALLOCATOR_NO_CANARY` so the cost of the canaries shows up in every number.
+
+List.h      `_AddValue`, `_Resize`, `_InsertRange` and `_Find`, on heap and arena backing
+View.h      `_Slice` and `_Find`
+TaggedUnion.h   Reading a mix of types, with the default tag and with a `uint8_t` tag placed last
+Allocator   LIFO, FIFO and random order frees, and a realloc that grows and shrinks, on heap,
+            arena and (where available) virtual arena allocators
+
+Timings are per iteration, and each iteration works on `BLOCKS_COUNT` elements or blocks.
+*/
+
+#if ALLOCATOR_NO_CANARY
+    #define CANARY_NAME "No canary"
+#else
+    #define CANARY_NAME "Canary"
+#endif
+
+#define BLOCKS_COUNT 1024
+#define ITERATIONS 20000
+
+#define LIST_NAME BenchUint32List
+#define VALUE_TYPE uint32_t
+#include "ModC/List.h"
+
+#define VIEW_NAME BenchUint32View
+#define CONST_VIEW_NAME BenchConstUint32View
+#define VALUE_TYPE uint32_t
+#include "ModC/View.h"
+
+typedef struct BenchPair
+{
+    uint32_t First;
+    uint32_t Second;
+} BenchPair;
+
+#define TU_NAME BenchUnion
+#define VALUE_TYPES uint32_t, double, BenchPair
+#include "ModC/TaggedUnion.h"
+
+#define TU_NAME BenchByteTagUnion
+#define VALUE_TYPES uint32_t, double, BenchPair
+#define TU_TAG_TYPE uint8_t
+#include "ModC/TaggedUnion.h"
+
+//xorshift32, the same sequence every run
+static uint32_t NextRandom(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void RunListBenchmarks(const char* allocatorName, Allocator allocator)
+{
+    char name[96];
+    uint32_t values[BLOCKS_COUNT];
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+        values[i] = i * 2654435761u;
+    
+    //Growth from empty, the common case when building token and statement lists
+    snprintf(name, sizeof(name), CANARY_NAME ", %s: List_AddValue from empty", allocatorName);
+    BENCHMARK_RUN(  name,
+                    ITERATIONS,
+                    BenchUint32List list = BenchUint32List_Create(allocator, 0);
+                    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+                        BenchUint32List_AddValue(&list, values[i]);
+                    Benchmark_Sink(list.Data);
+                    BenchUint32List_Free(&list);
+                    Allocator_Reset(&allocator));
+    
+    snprintf(name, sizeof(name), CANARY_NAME ", %s: List_Resize by 16", allocatorName);
+    BENCHMARK_RUN(  name,
+                    ITERATIONS,
+                    BenchUint32List list = BenchUint32List_Create(allocator, 0);
+                    for(uint32_t i = 16; i <= BLOCKS_COUNT; i += 16)
+                        BenchUint32List_Resize(&list, i);
+                    Benchmark_Sink(list.Data);
+                    BenchUint32List_Free(&list);
+                    Allocator_Reset(&allocator));
+    
+    //Inserting in the middle moves half the list each time
+    BenchUint32List list = BenchUint32List_Create(allocator, BLOCKS_COUNT + 16);
+    BenchUint32List_AddRange(&list, values, BLOCKS_COUNT);
+    snprintf(name, sizeof(name), CANARY_NAME ", %s: List_InsertRange 16 mid", allocatorName);
+    BENCHMARK_RUN(  name,
+                    ITERATIONS * 10,
+                    BenchUint32List_InsertRange(&list, BLOCKS_COUNT / 2, values, 16);
+                    BenchUint32List_RemoveRange(&list,
+                                                BLOCKS_COUNT / 2,
+                                                BLOCKS_COUNT / 2 + 16);
+                    Benchmark_Sink(list.Data));
+    
+    //Worst case, the value is last
+    const uint32_t lastValue = values[BLOCKS_COUNT - 1];
+    snprintf(name, sizeof(name), CANARY_NAME ", %s: List_Find last", allocatorName);
+    BENCHMARK_RUN(  name,
+                    ITERATIONS * 10,
+                    Benchmark_Sink((void*)(uintptr_t)BenchUint32List_Find(&list, &lastValue)));
+    BenchUint32List_Free(&list);
+    Allocator_Reset(&allocator);
+}
+
+static void RunViewBenchmarks(void)
+{
+    static uint32_t values[BLOCKS_COUNT];
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+        values[i] = i;
+    
+    BenchUint32View view = BenchUint32View_Create(values, BLOCKS_COUNT);
+    BENCHMARK_RUN(  CANARY_NAME ": View_Slice every offset",
+                    ITERATIONS,
+                    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+                    {
+                        BenchUint32View slice = BenchUint32View_Slice(&view, i, i + 8);
+                        Benchmark_Sink(slice.Data + slice.Length);
+                    });
+    
+    const uint32_t lastValue = BLOCKS_COUNT - 1;
+    BENCHMARK_RUN(  CANARY_NAME ": View_Find last",
+                    ITERATIONS * 10,
+                    Benchmark_Sink((void*)(uintptr_t)BenchUint32View_Find(&view, &lastValue)));
+}
+
+#define BENCH_UNION_SUM(unionName, unions, outSum) \
+    do \
+    { \
+        for(uint32_t i = 0; i < BLOCKS_COUNT; ++i) \
+        { \
+            switch(unions[i].Type) \
+            { \
+                case TU_TYPE(unionName, uint32_t): \
+                    outSum += unions[i].TU_DATA(unionName, uint32_t); \
+                    break; \
+                case TU_TYPE(unionName, double): \
+                    outSum += (uint64_t)unions[i].TU_DATA(unionName, double); \
+                    break; \
+                case TU_TYPE(unionName, BenchPair): \
+                    outSum += unions[i].TU_DATA(unionName, BenchPair).Second; \
+                    break; \
+                default: \
+                    break; \
+            } \
+        } \
+    } while(0)
+
+static void RunTaggedUnionBenchmarks(void)
+{
+    static BenchUnion unions[BLOCKS_COUNT];
+    static BenchByteTagUnion byteTagUnions[BLOCKS_COUNT];
+    uint32_t randomState = 2463534242u;
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+    {
+        switch(NextRandom(&randomState) % 3)
+        {
+            case 0:
+                unions[i] = TU_INIT(BenchUnion, uint32_t, i);
+                byteTagUnions[i] = TU_INIT(BenchByteTagUnion, uint32_t, i);
+                break;
+            case 1:
+                unions[i] = TU_INIT(BenchUnion, double, i * 0.5);
+                byteTagUnions[i] = TU_INIT(BenchByteTagUnion, double, i * 0.5);
+                break;
+            default:
+                unions[i] = TU_INIT(BenchUnion, BenchPair, { i, i + 1 });
+                byteTagUnions[i] = TU_INIT(BenchByteTagUnion, BenchPair, { i, i + 1 });
+                break;
+        }
+    }
+    
+    printf( "sizeof(BenchUnion) %zu, sizeof(BenchByteTagUnion) %zu\n",
+            sizeof(BenchUnion),
+            sizeof(BenchByteTagUnion));
+    
+    uint64_t sum = 0;
+    BENCHMARK_RUN(  CANARY_NAME ": TaggedUnion switch + TU_DATA",
+                    ITERATIONS,
+                    BENCH_UNION_SUM(BenchUnion, unions, sum);
+                    Benchmark_Sink((void*)(uintptr_t)sum));
+    
+    BENCHMARK_RUN(  CANARY_NAME ": TaggedUnion uint8_t tag",
+                    ITERATIONS,
+                    BENCH_UNION_SUM(BenchByteTagUnion, byteTagUnions, sum);
+                    Benchmark_Sink((void*)(uintptr_t)sum));
+}
+
+typedef enum FreeOrder
+{
+    FreeOrder_Lifo,
+    FreeOrder_Fifo,
+    FreeOrder_Random
+} FreeOrder;
+
+//Allocates `BLOCKS_COUNT` blocks of mixed sizes and frees them in `freeOrder`
+static void AllocateAndFree(Allocator* allocator,
+                            void** blocks,
+                            const uint32_t* sizes,
+                            const uint32_t* randomOrder,
+                            FreeOrder freeOrder)
+{
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+        blocks[i] = Allocator_Malloc(allocator, sizes[i]);
+    
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+    {
+        uint32_t index = i;
+        if(freeOrder == FreeOrder_Lifo)
+            index = BLOCKS_COUNT - 1 - i;
+        else if(freeOrder == FreeOrder_Random)
+            index = randomOrder[i];
+        Allocator_Free(allocator, blocks[index]);
+    }
+    Allocator_Reset(allocator);
+}
+
+//One block reallocated from 16 bytes to 64KB and back, like a list that fills and is trimmed
+static void GrowAndShrink(Allocator* allocator)
+{
+    void* block = Allocator_Malloc(allocator, 16);
+    for(uint64_t size = 32; size <= (64 << 10) && block; size *= 2)
+        block = Allocator_Realloc(allocator, block, size);
+    for(uint64_t size = 32 << 10; size >= 16 && block; size /= 2)
+        block = Allocator_Realloc(allocator, block, size);
+    Benchmark_Sink(block);
+    Allocator_Free(allocator, block);
+    Allocator_Reset(allocator);
+}
+
+static void RunAllocatorBenchmarks(const char* allocatorName, Allocator allocator)
+{
+    static void* blocks[BLOCKS_COUNT];
+    static uint32_t sizes[BLOCKS_COUNT];
+    static uint32_t randomOrder[BLOCKS_COUNT];
+    
+    //Mostly small blocks like tokens and statements, some larger like lists
+    uint32_t randomState = 88675123u;
+    for(uint32_t i = 0; i < BLOCKS_COUNT; ++i)
+    {
+        const uint32_t pick = NextRandom(&randomState) % 16;
+        sizes[i] = pick < 12 ? 8 + pick * 8 : 256 << (pick - 12);
+        randomOrder[i] = i;
+    }
+    for(uint32_t i = BLOCKS_COUNT - 1; i > 0; --i)
+    {
+        const uint32_t j = NextRandom(&randomState) % (i + 1);
+        const uint32_t temp = randomOrder[i];
+        randomOrder[i] = randomOrder[j];
+        randomOrder[j] = temp;
+    }
+    
+    static const char* orderNames[] = { "LIFO", "FIFO", "random" };
+    char name[96];
+    for(int order = FreeOrder_Lifo; order <= FreeOrder_Random; ++order)
+    {
+        snprintf(   name,
+                    sizeof(name),
+                    CANARY_NAME ", %s: Malloc all, free %s",
+                    allocatorName,
+                    orderNames[order]);
+        BENCHMARK_RUN(  name,
+                        ITERATIONS / 10,
+                        AllocateAndFree(&allocator, blocks, sizes, randomOrder, (FreeOrder)order));
+    }
+    
+    snprintf(name, sizeof(name), CANARY_NAME ", %s: Realloc grow + shrink", allocatorName);
+    BENCHMARK_RUN(name, ITERATIONS, GrowAndShrink(&allocator));
+}
+
+int main(void)
+{
+    Allocator heapAllocator = CreateHeapAllocator();
+    Allocator arenaAllocator = CreateArenaAllocator(64 << 10);
+    Allocator virtualArenaAllocator = CreateVirtualArenaAllocator(256 << 20, false);
+    
+    RunListBenchmarks("Heap", Allocator_Share(&heapAllocator));
+    RunListBenchmarks("Arena", Allocator_Share(&arenaAllocator));
+    RunViewBenchmarks();
+    RunTaggedUnionBenchmarks();
+    
+    RunAllocatorBenchmarks("Heap", Allocator_Share(&heapAllocator));
+    RunAllocatorBenchmarks("Arena", Allocator_Share(&arenaAllocator));
+    if(virtualArenaAllocator.Allocator)
+        RunAllocatorBenchmarks("Virtual arena", Allocator_Share(&virtualArenaAllocator));
+    
+    Allocator_Destroy(&virtualArenaAllocator);
+    Allocator_Destroy(&arenaAllocator);
+    Allocator_Destroy(&heapAllocator);
+    return 0;
+}
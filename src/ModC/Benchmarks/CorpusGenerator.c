@@ -0,0 +1,833 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Strings/StringBuilder.h"
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Writes a synthetic ModC source file for scaling benchmarks. The same options and seed always give
+the same bytes.
+
+Usage: CorpusGenerator [options] [output path]        (stdout without a path)
+
+--seed=<n>              Random seed (default 1)
+--size=<n>[K|M|G]       Target file size, overshoots by at most a few statements (default 64K)
+--functions=<n>         Function count, 0 picks one per 4K of `--size` (default 0)
+--depth=<n>             Max nesting of blocks inside a function body (default 3)
+--types=<n>             Enums and structs declared before the functions (default 8)
+--vocabulary=<n>        Distinct identifier words (default 256)
+--comments=<percent>    Chance of a comment before or after each statement (default 10)
+--continuations=<percent>   Chance of a `\<newline>` inside each expression (default 2)
+--mix=<kind>:<weight>,...   Statement weights, kinds are declare, assign, call, if, while,
+                            switch, block and return (default declare:5,assign:5,call:3,if:2,
+                            while:1,switch:1,block:1,return:1)
+
+Everything generated classifies without errors. `for` loops are left out because
+CreateStatements() splits their header at the semicolons.
+*/
+
+#define CORPUS_MAX_LOCALS 64
+#define CORPUS_MAX_PARAMS 3
+#define CORPUS_FLUSH_SIZE (1 << 20)
+
+typedef enum CorpusStatement
+{
+    CorpusStatement_Declare,
+    CorpusStatement_Assign,
+    CorpusStatement_Call,
+    CorpusStatement_If,
+    CorpusStatement_While,
+    CorpusStatement_Switch,
+    CorpusStatement_Block,
+    CorpusStatement_Return,
+    CorpusStatement_Count
+} CorpusStatement;
+
+static const char* CorpusStatementNames[CorpusStatement_Count] =
+{
+    "declare", "assign", "call", "if", "while", "switch", "block", "return"
+};
+
+typedef struct CorpusOptions
+{
+    uint64_t Seed;
+    uint64_t SizeBytes;
+    uint32_t FunctionsCount;
+    uint32_t MaxDepth;
+    uint32_t TypesCount;
+    uint32_t VocabularySize;
+    uint32_t CommentPercent;
+    uint32_t ContinuationPercent;
+    uint32_t MixWeights[CorpusStatement_Count];
+} CorpusOptions;
+
+typedef enum CorpusLocalType
+{
+    CorpusLocalType_Int,
+    CorpusLocalType_Enum,
+    CorpusLocalType_Struct
+} CorpusLocalType;
+
+typedef struct CorpusLocal
+{
+    uint32_t Word;
+    uint32_t Suffix;                            //0 if the word is not used by another local
+    CorpusLocalType Type;
+    uint32_t TypeIndex;
+} CorpusLocal;
+
+typedef struct CorpusGenerator
+{
+    CorpusOptions Options;
+    uint64_t RandomState;
+    StringBuilder Builder;
+    FILE* Output;
+    uint64_t FlushedBytes;
+    bool Failed;
+    
+    uint32_t* ParamCounts;                      //One per function generated
+    uint32_t FunctionIndex;
+    
+    CorpusLocal Locals[CORPUS_MAX_LOCALS];      //In scope at the current statement
+    uint32_t LocalsCount;
+    uint32_t IntLocalsCount;
+    uint32_t IntLocals[CORPUS_MAX_LOCALS];      //Indices into `Locals`
+    uint32_t NextSuffix;
+    
+    uint32_t Depth;
+    uint64_t FunctionEndBytes;                  //Nested statements stop growing past this
+    bool ContinuationPending;
+} CorpusGenerator;
+
+//splitmix64, so any seed including 0 gives a good sequence
+static uint64_t Corpus_Random(CorpusGenerator* gen)
+{
+    uint64_t z = (gen->RandomState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t Corpus_RandomBelow(CorpusGenerator* gen, uint32_t bound)
+{
+    return bound == 0 ? 0 : (uint32_t)(Corpus_Random(gen) % bound);
+}
+
+static bool Corpus_Chance(CorpusGenerator* gen, uint32_t percent)
+{
+    return Corpus_RandomBelow(gen, 100) < percent;
+}
+
+static uint64_t Corpus_WrittenBytes(const CorpusGenerator* gen)
+{
+    return gen->FlushedBytes + gen->Builder.Length;
+}
+
+static void Corpus_Flush(CorpusGenerator* gen)
+{
+    if(!StringBuilder_WriteToFile(&gen->Builder, gen->Output))
+        gen->Failed = true;
+    gen->FlushedBytes += gen->Builder.Length;
+    StringBuilder_Clear(&gen->Builder);
+}
+
+//Words are 2 or more consonant-vowel syllables, so they never collide with keywords
+static void Corpus_AppendWord(CorpusGenerator* gen, uint32_t word, bool capitalize)
+{
+    static const char syllables[16][2] =
+    {
+        {'k','a'}, {'l','o'}, {'m','i'}, {'n','e'}, {'r','u'}, {'s','a'}, {'t','i'}, {'v','o'},
+        {'z','e'}, {'p','a'}, {'d','o'}, {'g','u'}, {'f','e'}, {'b','i'}, {'h','o'}, {'y','a'}
+    };
+    
+    char text[32];
+    uint32_t length = 0;
+    for(uint64_t value = (uint64_t)word + 16; value != 0; value /= 16)
+    {
+        text[length++] = syllables[value % 16][0];
+        text[length++] = syllables[value % 16][1];
+    }
+    if(capitalize)
+        text[0] = (char)toupper((unsigned char)text[0]);
+    StringBuilder_AppendData(&gen->Builder, text, length);
+}
+
+static void Corpus_AppendCString(CorpusGenerator* gen, const char* str)
+{
+    StringBuilder_AppendData(&gen->Builder, str, strlen(str));
+}
+
+static void Corpus_AppendIndent(CorpusGenerator* gen, uint32_t depth)
+{
+    for(uint32_t i = 0; i < depth; ++i)
+        StringBuilder_AppendLiteral(&gen->Builder, "    ");
+}
+
+static void Corpus_AppendTypeName(CorpusGenerator* gen, uint32_t typeIndex)
+{
+    Corpus_AppendWord(gen, typeIndex * 7 + 3, true);
+    Corpus_AppendCString(gen, typeIndex % 2 == 0 ? "Kind" : "Data");
+}
+
+static void Corpus_AppendEnumValue(CorpusGenerator* gen, uint32_t typeIndex, uint32_t valueIndex)
+{
+    Corpus_AppendTypeName(gen, typeIndex);
+    StringBuilder_AppendChar(&gen->Builder, '_');
+    Corpus_AppendWord(gen, valueIndex, true);
+}
+
+static void Corpus_AppendFunctionName(CorpusGenerator* gen, uint32_t functionIndex)
+{
+    Corpus_AppendWord(gen, functionIndex % gen->Options.VocabularySize, true);
+    StringBuilder_AppendChar(&gen->Builder, '_');
+    StringBuilder_AppendUInt(&gen->Builder, functionIndex);
+}
+
+static void Corpus_AppendLocal(CorpusGenerator* gen, const CorpusLocal* local)
+{
+    Corpus_AppendWord(gen, local->Word, false);
+    if(local->Suffix)
+        StringBuilder_AppendUInt(&gen->Builder, local->Suffix);
+}
+
+static uint32_t Corpus_EnumsCount(const CorpusGenerator* gen)
+{
+    return (gen->Options.TypesCount + 1) / 2;
+}
+
+static uint32_t Corpus_EnumValuesCount(uint32_t typeIndex)
+{
+    return 2 + typeIndex % 5;
+}
+
+//Adds a local with an unused name, returns NULL if there is no room
+static CorpusLocal* Corpus_AddLocal(CorpusGenerator* gen, CorpusLocalType type, uint32_t typeIndex)
+{
+    if(gen->LocalsCount == CORPUS_MAX_LOCALS)
+        return NULL;
+    
+    CorpusLocal* local = &gen->Locals[gen->LocalsCount];
+    *local = (CorpusLocal)
+    {
+        .Word = Corpus_RandomBelow(gen, gen->Options.VocabularySize),
+        .Type = type,
+        .TypeIndex = typeIndex
+    };
+    for(uint32_t i = 0; i < gen->LocalsCount; ++i)
+    {
+        if(gen->Locals[i].Word == local->Word)
+        {
+            local->Suffix = ++gen->NextSuffix;
+            break;
+        }
+    }
+    
+    if(type == CorpusLocalType_Int)
+        gen->IntLocals[gen->IntLocalsCount++] = gen->LocalsCount;
+    ++gen->LocalsCount;
+    return local;
+}
+
+static void Corpus_AppendComment(CorpusGenerator* gen, uint32_t depth, bool trailing)
+{
+    const uint32_t wordsCount = 2 + Corpus_RandomBelow(gen, 8);
+    const bool block = !trailing && Corpus_Chance(gen, 30);
+    
+    if(trailing)
+        StringBuilder_AppendLiteral(&gen->Builder, " ");
+    else
+        Corpus_AppendIndent(gen, depth);
+    
+    Corpus_AppendCString(gen, block ? "/* " : "//");
+    for(uint32_t i = 0; i < wordsCount; ++i)
+    {
+        //Multi line block comments
+        if(block && i > 0 && Corpus_Chance(gen, 15))
+        {
+            StringBuilder_AppendChar(&gen->Builder, '\n');
+            Corpus_AppendIndent(gen, depth);
+            StringBuilder_AppendLiteral(&gen->Builder, "   ");
+        }
+        else if(i > 0 || block)
+            StringBuilder_AppendChar(&gen->Builder, ' ');
+        Corpus_AppendWord(gen, Corpus_RandomBelow(gen, gen->Options.VocabularySize), i == 0);
+    }
+    if(block)
+        StringBuilder_AppendLiteral(&gen->Builder, " */");
+    if(!trailing)
+        StringBuilder_AppendChar(&gen->Builder, '\n');
+}
+
+static void Corpus_AppendExpression(CorpusGenerator* gen, uint32_t depth, uint32_t maxTerms);
+
+static void Corpus_AppendCall(CorpusGenerator* gen, uint32_t depth)
+{
+    //printf or any function before this one
+    if(gen->FunctionIndex == 0 || Corpus_Chance(gen, 20))
+    {
+        StringBuilder_AppendLiteral(&gen->Builder, "printf(\"");
+        Corpus_AppendWord(gen, Corpus_RandomBelow(gen, gen->Options.VocabularySize), true);
+        StringBuilder_AppendLiteral(&gen->Builder, " %d\\n\", ");
+        Corpus_AppendExpression(gen, depth, 1);
+        StringBuilder_AppendChar(&gen->Builder, ')');
+        return;
+    }
+    
+    const uint32_t callee = Corpus_RandomBelow(gen, gen->FunctionIndex);
+    Corpus_AppendFunctionName(gen, callee);
+    StringBuilder_AppendChar(&gen->Builder, '(');
+    for(uint32_t i = 0; i < gen->ParamCounts[callee]; ++i)
+    {
+        if(i > 0)
+            StringBuilder_AppendLiteral(&gen->Builder, ", ");
+        Corpus_AppendExpression(gen, depth, 2);
+    }
+    StringBuilder_AppendChar(&gen->Builder, ')');
+}
+
+static void Corpus_AppendOperand(CorpusGenerator* gen, uint32_t depth)
+{
+    const uint32_t pick = Corpus_RandomBelow(gen, 10);
+    if(pick < 6 && gen->IntLocalsCount > 0)
+    {
+        const uint32_t localIndex = gen->IntLocals[Corpus_RandomBelow(gen, gen->IntLocalsCount)];
+        Corpus_AppendLocal(gen, &gen->Locals[localIndex]);
+    }
+    else if(pick == 6 && gen->FunctionIndex > 0)
+        Corpus_AppendCall(gen, depth);
+    else
+        StringBuilder_AppendUInt(&gen->Builder, Corpus_RandomBelow(gen, 1000));
+}
+
+static void Corpus_AppendExpression(CorpusGenerator* gen, uint32_t depth, uint32_t maxTerms)
+{
+    static const char* operators[] = { " + ", " - ", " * ", " / ", " % ", " & ", " | ", " ^ " };
+    
+    const uint32_t termsCount = 1 + Corpus_RandomBelow(gen, maxTerms);
+    for(uint32_t i = 0; i < termsCount; ++i)
+    {
+        if(i > 0)
+        {
+            const char* op = operators[Corpus_RandomBelow(gen, sizeof(operators) / sizeof(char*))];
+            if(gen->ContinuationPending)
+            {
+                //Keep the operator on this line so the continuation is the only change
+                StringBuilder_AppendData(&gen->Builder, op, strlen(op) - 1);
+                StringBuilder_AppendLiteral(&gen->Builder, " \\\n");
+                Corpus_AppendIndent(gen, depth + 1);
+                gen->ContinuationPending = false;
+            }
+            else
+                Corpus_AppendCString(gen, op);
+        }
+        
+        if(termsCount > 1 && Corpus_Chance(gen, 15))
+        {
+            StringBuilder_AppendChar(&gen->Builder, '(');
+            Corpus_AppendExpression(gen, depth, 2);
+            StringBuilder_AppendChar(&gen->Builder, ')');
+        }
+        else
+            Corpus_AppendOperand(gen, depth);
+    }
+}
+
+static void Corpus_AppendCondition(CorpusGenerator* gen, uint32_t depth)
+{
+    static const char* comparisons[] = { " < ", " > ", " <= ", " >= ", " == ", " != " };
+    
+    Corpus_AppendExpression(gen, depth, 2);
+    const char* comparison = comparisons[Corpus_RandomBelow(gen, 6)];
+    Corpus_AppendCString(gen, comparison);
+    Corpus_AppendExpression(gen, depth, 2);
+}
+
+static void Corpus_AppendStatement(CorpusGenerator* gen, uint32_t depth);
+
+//Body of if, else, while and blocks. Nested scopes drop their locals when they end
+static void Corpus_AppendBody(CorpusGenerator* gen, uint32_t depth, bool allowSingle)
+{
+    const uint32_t localsCount = gen->LocalsCount;
+    const uint32_t intLocalsCount = gen->IntLocalsCount;
+    
+    ++gen->Depth;
+    if(allowSingle && Corpus_Chance(gen, 30))
+        Corpus_AppendStatement(gen, depth + 1);
+    else
+    {
+        Corpus_AppendIndent(gen, depth);
+        StringBuilder_AppendLiteral(&gen->Builder, "{\n");
+        const uint32_t statementsCount = 1 + Corpus_RandomBelow(gen, 4);
+        for(uint32_t i = 0; i < statementsCount; ++i)
+        {
+            Corpus_AppendStatement(gen, depth + 1);
+            if(Corpus_WrittenBytes(gen) >= gen->FunctionEndBytes)
+                break;
+        }
+        Corpus_AppendIndent(gen, depth);
+        StringBuilder_AppendLiteral(&gen->Builder, "}\n");
+    }
+    --gen->Depth;
+    
+    gen->LocalsCount = localsCount;
+    gen->IntLocalsCount = intLocalsCount;
+}
+
+static CorpusStatement Corpus_PickStatement(CorpusGenerator* gen)
+{
+    uint32_t totalWeight = 0;
+    for(int i = 0; i < CorpusStatement_Count; ++i)
+        totalWeight += gen->Options.MixWeights[i];
+    
+    uint32_t pick = Corpus_RandomBelow(gen, totalWeight);
+    for(int i = 0; i < CorpusStatement_Count; ++i)
+    {
+        if(pick < gen->Options.MixWeights[i])
+            return (CorpusStatement)i;
+        pick -= gen->Options.MixWeights[i];
+    }
+    return CorpusStatement_Assign;
+}
+
+static void Corpus_AppendStatement(CorpusGenerator* gen, uint32_t depth)
+{
+    CorpusStatement kind = Corpus_PickStatement(gen);
+    
+    //Out of depth, size or nothing to assign to, fall back to simple statements
+    const bool nested = kind == CorpusStatement_If || kind == CorpusStatement_While ||
+                        kind == CorpusStatement_Switch || kind == CorpusStatement_Block;
+    if( nested && 
+        (gen->Depth >= gen->Options.MaxDepth || 
+        Corpus_WrittenBytes(gen) >= gen->FunctionEndBytes))
+        kind = Corpus_Chance(gen, 50) ? CorpusStatement_Assign : CorpusStatement_Call;
+    if(kind == CorpusStatement_Return && gen->Depth == 0)
+        kind = CorpusStatement_Assign;
+    if(kind == CorpusStatement_Declare && gen->LocalsCount == CORPUS_MAX_LOCALS)
+        kind = CorpusStatement_Assign;
+    if(kind == CorpusStatement_Assign && gen->IntLocalsCount == 0)
+    {
+        kind = gen->LocalsCount < CORPUS_MAX_LOCALS ?   CorpusStatement_Declare : 
+                                                        CorpusStatement_Call;
+    }
+    
+    const bool comment = Corpus_Chance(gen, gen->Options.CommentPercent);
+    const bool trailingComment = comment && Corpus_Chance(gen, 40) && !nested;
+    if(comment && !trailingComment)
+        Corpus_AppendComment(gen, depth, false);
+    
+    //Blocks write their own indent
+    gen->ContinuationPending = Corpus_Chance(gen, gen->Options.ContinuationPercent);
+    if(kind != CorpusStatement_Block)
+        Corpus_AppendIndent(gen, depth);
+    switch(kind)
+    {
+        case CorpusStatement_Declare:
+        {
+            const uint32_t typePick = Corpus_RandomBelow(gen, 10);
+            const uint32_t enumsCount = Corpus_EnumsCount(gen);
+            const uint32_t structsCount = gen->Options.TypesCount - enumsCount;
+            if(typePick == 0 && enumsCount > 0)
+            {
+                const uint32_t typeIndex = Corpus_RandomBelow(gen, enumsCount) * 2;
+                Corpus_AppendTypeName(gen, typeIndex);
+                StringBuilder_AppendChar(&gen->Builder, ' ');
+                Corpus_AppendLocal(gen, Corpus_AddLocal(gen, CorpusLocalType_Enum, typeIndex));
+                StringBuilder_AppendLiteral(&gen->Builder, " = ");
+                Corpus_AppendTypeName(gen, typeIndex);
+                StringBuilder_AppendChar(&gen->Builder, '.');
+                Corpus_AppendEnumValue( gen,
+                                        typeIndex,
+                                        Corpus_RandomBelow(gen, Corpus_EnumValuesCount(typeIndex)));
+            }
+            else if(typePick == 1 && structsCount > 0)
+            {
+                const uint32_t typeIndex = Corpus_RandomBelow(gen, structsCount) * 2 + 1;
+                Corpus_AppendTypeName(gen, typeIndex);
+                StringBuilder_AppendChar(&gen->Builder, ' ');
+                Corpus_AppendLocal(gen, Corpus_AddLocal(gen, CorpusLocalType_Struct, typeIndex));
+                StringBuilder_AppendLiteral(&gen->Builder, " = ");
+                Corpus_AppendTypeName(gen, typeIndex);
+                StringBuilder_AppendLiteral(&gen->Builder, "()");
+            }
+            else
+            {
+                //Initializer can't use the local being declared
+                StringBuilder_AppendLiteral(&gen->Builder, "int ");
+                const uint32_t intLocalsCount = gen->IntLocalsCount;
+                CorpusLocal* local = Corpus_AddLocal(gen, CorpusLocalType_Int, 0);
+                Corpus_AppendLocal(gen, local);
+                StringBuilder_AppendLiteral(&gen->Builder, " = ");
+                const uint32_t newIntLocalsCount = gen->IntLocalsCount;
+                gen->IntLocalsCount = intLocalsCount;
+                Corpus_AppendExpression(gen, depth, 4);
+                gen->IntLocalsCount = newIntLocalsCount;
+            }
+            StringBuilder_AppendChar(&gen->Builder, ';');
+            break;
+        }
+        case CorpusStatement_Assign:
+        {
+            const uint32_t intLocal = Corpus_RandomBelow(gen, gen->IntLocalsCount);
+            Corpus_AppendLocal(gen, &gen->Locals[gen->IntLocals[intLocal]]);
+            StringBuilder_AppendLiteral(&gen->Builder, " = ");
+            Corpus_AppendExpression(gen, depth, 4);
+            StringBuilder_AppendChar(&gen->Builder, ';');
+            break;
+        }
+        case CorpusStatement_Call:
+            Corpus_AppendCall(gen, depth);
+            StringBuilder_AppendChar(&gen->Builder, ';');
+            break;
+        case CorpusStatement_Return:
+            StringBuilder_AppendLiteral(&gen->Builder, "return ");
+            Corpus_AppendExpression(gen, depth, 3);
+            StringBuilder_AppendChar(&gen->Builder, ';');
+            break;
+        case CorpusStatement_If:
+        {
+            StringBuilder_AppendLiteral(&gen->Builder, "if(");
+            Corpus_AppendCondition(gen, depth);
+            StringBuilder_AppendLiteral(&gen->Builder, ")\n");
+            Corpus_AppendBody(gen, depth, true);
+            
+            const uint32_t elseIfCount = Corpus_Chance(gen, 30) ? Corpus_RandomBelow(gen, 3) : 0;
+            for(uint32_t i = 0; i < elseIfCount; ++i)
+            {
+                Corpus_AppendIndent(gen, depth);
+                StringBuilder_AppendLiteral(&gen->Builder, "else if(");
+                Corpus_AppendCondition(gen, depth);
+                StringBuilder_AppendLiteral(&gen->Builder, ")\n");
+                Corpus_AppendBody(gen, depth, true);
+            }
+            if(Corpus_Chance(gen, 40))
+            {
+                Corpus_AppendIndent(gen, depth);
+                StringBuilder_AppendLiteral(&gen->Builder, "else\n");
+                Corpus_AppendBody(gen, depth, true);
+            }
+            return;
+        }
+        case CorpusStatement_While:
+            StringBuilder_AppendLiteral(&gen->Builder, "while(");
+            Corpus_AppendCondition(gen, depth);
+            StringBuilder_AppendLiteral(&gen->Builder, ")\n");
+            Corpus_AppendBody(gen, depth, true);
+            return;
+        case CorpusStatement_Switch:
+        {
+            StringBuilder_AppendLiteral(&gen->Builder, "switch(");
+            Corpus_AppendExpression(gen, depth, 2);
+            StringBuilder_AppendLiteral(&gen->Builder, ")\n");
+            Corpus_AppendIndent(gen, depth);
+            StringBuilder_AppendLiteral(&gen->Builder, "{\n");
+            
+            ++gen->Depth;
+            const uint32_t casesCount = 1 + Corpus_RandomBelow(gen, 5);
+            for(uint32_t i = 0; i < casesCount; ++i)
+            {
+                Corpus_AppendIndent(gen, depth + 1);
+                StringBuilder_AppendLiteral(&gen->Builder, "case ");
+                StringBuilder_AppendUInt(&gen->Builder, i);
+                StringBuilder_AppendLiteral(&gen->Builder, ":\n");
+                
+                const uint32_t localsCount = gen->LocalsCount;
+                const uint32_t intLocalsCount = gen->IntLocalsCount;
+                const uint32_t statementsCount = 1 + Corpus_RandomBelow(gen, 3);
+                for(uint32_t j = 0; j < statementsCount; ++j)
+                    Corpus_AppendStatement(gen, depth + 2);
+                gen->LocalsCount = localsCount;
+                gen->IntLocalsCount = intLocalsCount;
+                
+                Corpus_AppendIndent(gen, depth + 2);
+                StringBuilder_AppendLiteral(&gen->Builder, "break;\n");
+            }
+            --gen->Depth;
+            
+            Corpus_AppendIndent(gen, depth);
+            StringBuilder_AppendLiteral(&gen->Builder, "}\n");
+            return;
+        }
+        case CorpusStatement_Block:
+            Corpus_AppendBody(gen, depth, false);
+            return;
+        case CorpusStatement_Count:
+            break;
+    }
+    
+    if(trailingComment)
+        Corpus_AppendComment(gen, depth, true);
+    StringBuilder_AppendChar(&gen->Builder, '\n');
+}
+
+static void Corpus_AppendTypes(CorpusGenerator* gen)
+{
+    //Even indices are enums, odd ones are structs, so structs can use any enum before them
+    for(uint32_t typeIndex = 0; typeIndex < gen->Options.TypesCount; ++typeIndex)
+    {
+        if(typeIndex % 2 == 0)
+        {
+            StringBuilder_AppendLiteral(&gen->Builder, "enum ");
+            Corpus_AppendTypeName(gen, typeIndex);
+            StringBuilder_AppendLiteral(&gen->Builder, "\n{\n");
+            const uint32_t valuesCount = Corpus_EnumValuesCount(typeIndex);
+            for(uint32_t i = 0; i < valuesCount; ++i)
+            {
+                StringBuilder_AppendLiteral(&gen->Builder, "    ");
+                Corpus_AppendEnumValue(gen, typeIndex, i);
+                if(i == 0)
+                    StringBuilder_AppendLiteral(&gen->Builder, " = 0");
+                Corpus_AppendCString(gen, i + 1 < valuesCount ? ",\n" : "\n");
+            }
+        }
+        else
+        {
+            StringBuilder_AppendLiteral(&gen->Builder, "struct ");
+            Corpus_AppendTypeName(gen, typeIndex);
+            StringBuilder_AppendLiteral(&gen->Builder, "\n{\n");
+            const uint32_t fieldsCount = 1 + Corpus_RandomBelow(gen, 6);
+            for(uint32_t i = 0; i < fieldsCount; ++i)
+            {
+                StringBuilder_AppendLiteral(&gen->Builder, "    ");
+                const uint32_t typePick = Corpus_RandomBelow(gen, 4);
+                if(typePick == 0)
+                    Corpus_AppendTypeName(gen, Corpus_RandomBelow(gen, typeIndex / 2 + 1) * 2);
+                else
+                    Corpus_AppendCString(gen, typePick == 1 ? "float" : "int");
+                StringBuilder_AppendChar(&gen->Builder, ' ');
+                
+                //Field names only need to be unique in the struct
+                Corpus_AppendWord(gen, i * gen->Options.VocabularySize / fieldsCount, true);
+                StringBuilder_AppendLiteral(&gen->Builder, ";\n");
+            }
+        }
+        StringBuilder_AppendLiteral(&gen->Builder, "}\n\n");
+    }
+}
+
+static void Corpus_AppendFunction(CorpusGenerator* gen, uint64_t bodyBytes)
+{
+    gen->LocalsCount = 0;
+    gen->IntLocalsCount = 0;
+    gen->NextSuffix = 0;
+    gen->Depth = 0;
+    
+    const uint32_t paramsCount = Corpus_RandomBelow(gen, CORPUS_MAX_PARAMS + 1);
+    gen->ParamCounts[gen->FunctionIndex] = paramsCount;
+    
+    if(Corpus_Chance(gen, gen->Options.CommentPercent))
+        Corpus_AppendComment(gen, 0, false);
+    StringBuilder_AppendLiteral(&gen->Builder, "int ");
+    Corpus_AppendFunctionName(gen, gen->FunctionIndex);
+    StringBuilder_AppendChar(&gen->Builder, '(');
+    for(uint32_t i = 0; i < paramsCount; ++i)
+    {
+        if(i > 0)
+            StringBuilder_AppendLiteral(&gen->Builder, ", ");
+        StringBuilder_AppendLiteral(&gen->Builder, "int ");
+        Corpus_AppendLocal(gen, Corpus_AddLocal(gen, CorpusLocalType_Int, 0));
+    }
+    StringBuilder_AppendLiteral(&gen->Builder, ")\n{\n");
+    
+    //At least one statement besides the return
+    gen->FunctionEndBytes = Corpus_WrittenBytes(gen) + bodyBytes;
+    do
+        Corpus_AppendStatement(gen, 1);
+    while(Corpus_WrittenBytes(gen) < gen->FunctionEndBytes);
+    
+    gen->ContinuationPending = false;
+    StringBuilder_AppendLiteral(&gen->Builder, "    return ");
+    Corpus_AppendExpression(gen, 1, 2);
+    StringBuilder_AppendLiteral(&gen->Builder, ";\n}\n\n");
+    
+    ++gen->FunctionIndex;
+    if(gen->Builder.Length >= CORPUS_FLUSH_SIZE)
+        Corpus_Flush(gen);
+}
+
+static bool Corpus_Generate(const CorpusOptions* options, FILE* output)
+{
+    CorpusGenerator gen =
+    {
+        .Options = *options,
+        .RandomState = options->Seed,
+        .Builder = StringBuilder_Create(CreateHeapAllocator(), 64 << 10),
+        .Output = output
+    };
+    
+    uint32_t functionsCount = options->FunctionsCount;
+    if(functionsCount == 0)
+        functionsCount = options->SizeBytes / 4096 > 0 ? (uint32_t)(options->SizeBytes / 4096) : 1;
+    gen.ParamCounts = calloc(functionsCount, sizeof(uint32_t));
+    if(!gen.ParamCounts)
+    {
+        StringBuilder_Free(&gen.Builder);
+        return false;
+    }
+    
+    StringBuilder_AppendLiteral(&gen.Builder, "#include <stdio.h>\n\n");
+    Corpus_AppendTypes(&gen);
+    
+    //Spread what is left of the size evenly over the remaining functions
+    for(uint32_t i = 0; i < functionsCount && !gen.Failed; ++i)
+    {
+        const uint64_t written = Corpus_WrittenBytes(&gen);
+        const uint64_t remaining = options->SizeBytes > written ? options->SizeBytes - written : 0;
+        Corpus_AppendFunction(&gen, remaining / (functionsCount - i));
+    }
+    Corpus_Flush(&gen);
+    
+    fprintf(stderr,
+            "Generated %"PRIu64" bytes, %"PRIu32" types, %"PRIu32" functions\n",
+            gen.FlushedBytes,
+            options->TypesCount,
+            gen.FunctionIndex);
+    
+    free(gen.ParamCounts);
+    StringBuilder_Free(&gen.Builder);
+    return !gen.Failed;
+}
+
+static bool Corpus_ParseUInt64(const char* text, uint64_t* outValue)
+{
+    char* end = NULL;
+    *outValue = strtoull(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+//Parses "<n>" with an optional K, M or G suffix
+static bool Corpus_ParseSize(const char* text, uint64_t* outValue)
+{
+    char* end = NULL;
+    uint64_t value = strtoull(text, &end, 10);
+    if(end == text)
+        return false;
+    
+    switch(toupper((unsigned char)*end))
+    {
+        case 'K': value <<= 10; ++end; break;
+        case 'M': value <<= 20; ++end; break;
+        case 'G': value <<= 30; ++end; break;
+        default: break;
+    }
+    *outValue = value;
+    return *end == '\0';
+}
+
+static bool Corpus_ParseUInt(const char* text, uint32_t* outValue)
+{
+    char* end = NULL;
+    unsigned long value = strtoul(text, &end, 10);
+    *outValue = (uint32_t)value;
+    return end != text && *end == '\0';
+}
+
+//"<kind>:<weight>,..." Kinds that are not listed keep their weight
+static bool Corpus_ParseMix(const char* text, uint32_t* outWeights)
+{
+    while(*text)
+    {
+        const char* separator = strchr(text, ':');
+        if(!separator)
+            return false;
+        
+        int kind = 0;
+        for(; kind < CorpusStatement_Count; ++kind)
+        {
+            const size_t nameLength = strlen(CorpusStatementNames[kind]);
+            if( nameLength == (size_t)(separator - text) &&
+                strncmp(text, CorpusStatementNames[kind], nameLength) == 0)
+            {
+                break;
+            }
+        }
+        if(kind == CorpusStatement_Count)
+            return false;
+        
+        char* end = NULL;
+        outWeights[kind] = (uint32_t)strtoul(separator + 1, &end, 10);
+        if(end == separator + 1 || (*end != ',' && *end != '\0'))
+            return false;
+        text = *end == ',' ? end + 1 : end;
+    }
+    
+    uint32_t totalWeight = 0;
+    for(int i = 0; i < CorpusStatement_Count; ++i)
+        totalWeight += outWeights[i];
+    return totalWeight > 0;
+}
+
+//Returns the text after `name` if `arg` starts with it
+#define CORPUS_OPTION(arg, name) \
+    (strncmp(arg, name, sizeof(name) - 1) == 0 ? arg + sizeof(name) - 1 : NULL)
+
+int main(int argc, char* argv[])
+{
+    CorpusOptions options =
+    {
+        .Seed = 1,
+        .SizeBytes = 64 << 10,
+        .FunctionsCount = 0,
+        .MaxDepth = 3,
+        .TypesCount = 8,
+        .VocabularySize = 256,
+        .CommentPercent = 10,
+        .ContinuationPercent = 2,
+        .MixWeights = { 5, 5, 3, 2, 1, 1, 1, 1 }
+    };
+    const char* outputPath = NULL;
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value = NULL;
+        bool valid = true;
+        if((value = CORPUS_OPTION(argv[i], "--seed=")))
+            valid = Corpus_ParseUInt64(value, &options.Seed);
+        else if((value = CORPUS_OPTION(argv[i], "--size=")))
+            valid = Corpus_ParseSize(value, &options.SizeBytes);
+        else if((value = CORPUS_OPTION(argv[i], "--functions=")))
+            valid = Corpus_ParseUInt(value, &options.FunctionsCount);
+        else if((value = CORPUS_OPTION(argv[i], "--depth=")))
+            valid = Corpus_ParseUInt(value, &options.MaxDepth);
+        else if((value = CORPUS_OPTION(argv[i], "--types=")))
+            valid = Corpus_ParseUInt(value, &options.TypesCount);
+        else if((value = CORPUS_OPTION(argv[i], "--vocabulary=")))
+            valid = Corpus_ParseUInt(value, &options.VocabularySize) && options.VocabularySize > 0;
+        else if((value = CORPUS_OPTION(argv[i], "--comments=")))
+            valid = Corpus_ParseUInt(value, &options.CommentPercent);
+        else if((value = CORPUS_OPTION(argv[i], "--continuations=")))
+            valid = Corpus_ParseUInt(value, &options.ContinuationPercent);
+        else if((value = CORPUS_OPTION(argv[i], "--mix=")))
+            valid = Corpus_ParseMix(value, options.MixWeights);
+        else if(argv[i][0] != '-' && !outputPath)
+            outputPath = argv[i];
+        else
+            valid = false;
+        
+        if(!valid)
+        {
+            fprintf(stderr, "Invalid argument %s, see the top of CorpusGenerator.c\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    FILE* output = outputPath ? fopen(outputPath, "wb") : stdout;
+    if(!output)
+    {
+        fprintf(stderr, "Failed to open %s\n", outputPath);
+        return 1;
+    }
+    
+    bool succeeded = Corpus_Generate(&options, output);
+    if(outputPath && fclose(output) != 0)
+        succeeded = false;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the corpus\n");
+    return succeeded ? 0 : 1;
+}
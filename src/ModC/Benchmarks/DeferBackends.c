@@ -0,0 +1,108 @@
+#include "ModC/Defer.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Setup and unwind cost of a defer scope with the Defer.h backend this is built with. build.sh builds
+it once with each `MODC_DEFER_COMPUTED_GOTO` value.
+*/
+
+#define ITERATIONS 50000000
+
+#if MODC_DEFER_COMPUTED_GOTO
+    #define BACKEND_NAME "Computed goto"
+#else
+    #define BACKEND_NAME "Switch"
+#endif
+
+//Called through volatile pointers so each call sets up and unwinds its own scope
+static int (*volatile DeferNormalExitFunc)(int value);
+static int (*volatile DeferEarlyBreakFunc)(int value);
+static int (*volatile DeferNoneRegisteredFunc)(int value);
+
+//Like most of our functions, a few resources released on the way out
+static int DeferNormalExit(int value)
+{
+    int total = value;
+    DEFER_SCOPE_START(0)
+    {
+        DEFER(0, total += 1);
+        total ^= value >> 3;
+        DEFER(0, total *= 3);
+        total += value & 7;
+        DEFER(0, total ^= 5);
+    }
+    DEFER_SCOPE_END(0)
+    
+    return total;
+}
+
+//Error path, leaves through `DEFER_BREAK` after some of the defers are registered
+static int DeferEarlyBreak(int value)
+{
+    int total = value;
+    DEFER_SCOPE_START(0)
+    {
+        DEFER(0, total += 1);
+        DEFER(0, total *= 3);
+        if(value >= 0)
+            DEFER_BREAK(0, return total);
+        
+        DEFER(0, total ^= 5);
+    }
+    DEFER_SCOPE_END(0)
+    
+    return -total;
+}
+
+//Scope that never registers a defer
+static int DeferNoneRegistered(int value)
+{
+    int total = value;
+    DEFER_SCOPE_START(0)
+    {
+        if(value < 0)
+            DEFER_BREAK(0, return 0);
+        
+        total += value & 7;
+    }
+    DEFER_SCOPE_END(0)
+    
+    return total;
+}
+
+int main(void)
+{
+    DeferNormalExitFunc = DeferNormalExit;
+    DeferEarlyBreakFunc = DeferEarlyBreak;
+    DeferNoneRegisteredFunc = DeferNoneRegistered;
+    
+    //Both backends run the defers in reverse order
+    if( DeferNormalExitFunc(8) != (((8 ^ 1) + 0) ^ 5) * 3 + 1 ||
+        DeferEarlyBreakFunc(2) != 2 * 3 + 1 ||
+        DeferNoneRegisteredFunc(-1) != 0)
+    {
+        printf("%s: Defers ran in the wrong order\n", BACKEND_NAME);
+        return 1;
+    }
+    
+    int value = 0;
+    BENCHMARK_RUN(  BACKEND_NAME ": 3 defers, normal exit",
+                    ITERATIONS,
+                    value = DeferNormalExitFunc(value & 0xffff);
+                    Benchmark_Sink((void*)(uintptr_t)value));
+    
+    BENCHMARK_RUN(  BACKEND_NAME ": 2 defers, DEFER_BREAK",
+                    ITERATIONS,
+                    value = DeferEarlyBreakFunc(value & 0xffff);
+                    Benchmark_Sink((void*)(uintptr_t)value));
+    
+    BENCHMARK_RUN(  BACKEND_NAME ": No defers",
+                    ITERATIONS,
+                    value = DeferNoneRegisteredFunc(value & 0xffff);
+                    Benchmark_Sink((void*)(uintptr_t)value));
+    
+    return 0;
+}
@@ -0,0 +1,233 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Defer.h"
+#include "ModC/Tokenization.h"
+#include "ModC/Classification.h"
+#include "ModC/Jobs.h"
+#include "ModC/TraceEvents.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Compiles a file as if it were many files, once on the calling thread and once spread over a
+`JobSystem`, and checks both produce the same statements.
+
+Usage: JobsPipeline <path> [files] [workers] [trace path]
+
+With a trace path, each file compiled is a span on the thread that compiled it.
+*/
+
+#define ITERATIONS 20
+
+typedef struct PipelineRun
+{
+    ConstStringView Source;
+    uint32_t* StatementCounts;                  //One per file
+    uint32_t FailedCount;                       //Atomic
+} PipelineRun;
+
+//Returns the number of statements, 0 if any stage failed
+static uint32_t RunPipeline(ConstStringView source, Allocator scratchArena)
+{
+    #undef ResultNameState
+    #define ResultNameState Result_Void
+    
+    Allocator mainArena = CreateArenaAllocator(source.Length * 64);
+    Allocator statementListArena = {0};
+    uint32_t statementsCount = 0;
+    
+    Result_TokenList tokenListResult = Tokenization(source, Allocator_Share(&mainArena));
+    if(tokenListResult.HasError)
+        goto exitPoint;
+    TokenList* tokenList = &tokenListResult.ValueOrError.Value;
+    
+    Result_StatementList statementListResult = CreateStatements(  tokenList,
+                                                                    source,
+                                                                    Allocator_Share(&mainArena),
+                                                                    &statementListArena);
+    if(statementListResult.HasError)
+        goto freeTokens;
+    StatementList* statementList = &statementListResult.ValueOrError.Value;
+    
+    Result_Void classifyResult =
+        CleanAndClassifyStatements( statementList,
+                                    Allocator_Share(&mainArena),
+                                    Allocator_Share(&statementListArena),
+                                    tokenList,
+                                    source,
+                                    scratchArena);
+    if(!classifyResult.HasError)
+        statementsCount = statementList->Length;
+    
+    Allocator_Destroy(&statementListArena);
+    freeTokens:;
+    TokenList_Free(tokenList);
+    exitPoint:;
+    //Errors are only counted, free them all at once
+    Result_ResetErrorArena();
+    Allocator_Destroy(&mainArena);
+    return statementsCount;
+}
+
+static void CompileFiles(JobContext* context, void* userData, uint64_t begin, uint64_t end)
+{
+    PipelineRun* run = userData;
+    for(uint64_t i = begin; i < end; ++i)
+    {
+        TraceSpan fileSpan = TraceEvents_Begin();
+        run->StatementCounts[i] = RunPipeline(run->Source, Allocator_Share(&context->Scratch));
+        if(run->StatementCounts[i] == 0)
+            __atomic_add_fetch(&run->FailedCount, 1, __ATOMIC_RELAXED);
+        
+        if(TraceEvents_IsEnabled())
+        {
+            char fileName[32];
+            int nameLength = snprintf(fileName, sizeof(fileName), "File %"PRIu64, i);
+            TraceEvents_End(fileSpan, "file", fileName, nameLength > 0 ? nameLength : 0);
+        }
+    }
+}
+
+//Fork-join, each call splits its range in half until a single file is left
+typedef struct SplitTask
+{
+    PipelineRun* Run;
+    uint64_t Begin;
+    uint64_t End;
+} SplitTask;
+
+static void CompileFilesSplit(JobContext* context, void* userData)
+{
+    SplitTask* task = userData;
+    if(task->End - task->Begin <= 1)
+    {
+        CompileFiles(context, task->Run, task->Begin, task->End);
+        return;
+    }
+    
+    const uint64_t middle = task->Begin + (task->End - task->Begin) / 2;
+    SplitTask upperTask = { .Run = task->Run, .Begin = middle, .End = task->End };
+    SplitTask lowerTask = { .Run = task->Run, .Begin = task->Begin, .End = middle };
+    JobCounter counter = {0};
+    Job upperJob = { .Function = CompileFilesSplit, .UserData = &upperTask, .Counter = &counter };
+    JobSystem_Submit(context, &upperJob);
+    CompileFilesSplit(context, &lowerTask);
+    JobSystem_Wait(context, &counter);
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        printf("Usage: %s <path> [files] [workers] [trace path]\n", argv[0]);
+        return 1;
+    }
+    
+    const uint64_t filesCount = argc > 2 ? strtoull(argv[2], NULL, 10) : 256;
+    const uint32_t workersCount = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 0;
+    if(argc > 4)
+        TraceEvents_WriteJsonAtExit(argv[4]);
+    TraceEvents_SetThreadName("Main");
+    
+    FILE* sourceFile = fopen(argv[1], "rb");
+    if(!sourceFile)
+    {
+        printf("Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    
+    fseek(sourceFile, 0, SEEK_END);
+    long fileSize = ftell(sourceFile);
+    fseek(sourceFile, 0, SEEK_SET);
+    
+    Allocator heapAllocator = CreateHeapAllocator();
+    AlignedString fileContent = AlignedString_Create(Allocator_Share(&heapAllocator), fileSize);
+    AlignedString_Resize(&fileContent, fileSize);
+    size_t readSize = fread(fileContent.Data, 1, fileSize, sourceFile);
+    fclose(sourceFile);
+    
+    JobSystem* jobSystem = CreateJobSystem(workersCount, 1 << 20);
+    uint32_t* serialCounts = calloc(filesCount, sizeof(uint32_t));
+    uint32_t* parallelCounts = calloc(filesCount, sizeof(uint32_t));
+    int exitCode = 1;
+    if( fileSize <= 0 || readSize != (size_t)fileSize ||
+        !jobSystem || !serialCounts || !parallelCounts)
+    {
+        printf("Failed to set up\n");
+        goto exitPoint;
+    }
+    
+    JobContext* mainContext = JobSystem_MainContext(jobSystem);
+    PipelineRun serialRun =
+    {
+        .Source = ConstStringView_Create(fileContent.Data, fileContent.Length),
+        .StatementCounts = serialCounts
+    };
+    PipelineRun parallelRun = serialRun;
+    parallelRun.StatementCounts = parallelCounts;
+    
+    printf( "%"PRIu64" files of %ld bytes, %"PRIu32" workers\n",
+            filesCount,
+            fileSize,
+            jobSystem->WorkerCount);
+    
+    BENCHMARK_RUN(  "Serial",
+                    ITERATIONS,
+                    CompileFiles(mainContext, &serialRun, 0, filesCount));
+    
+    BENCHMARK_RUN(  "JobSystem_ParallelFor, 1 file per batch",
+                    ITERATIONS,
+                    JobSystem_ParallelFor(  mainContext,
+                                            0,
+                                            filesCount,
+                                            1,
+                                            CompileFiles,
+                                            &parallelRun));
+    
+    BENCHMARK_RUN(  "JobSystem_ParallelFor, default batches",
+                    ITERATIONS,
+                    JobSystem_ParallelFor(  mainContext,
+                                            0,
+                                            filesCount,
+                                            0,
+                                            CompileFiles,
+                                            &parallelRun));
+    
+    SplitTask rootTask = { .Run = &parallelRun, .Begin = 0, .End = filesCount };
+    BENCHMARK_RUN(  "Fork-join split",
+                    ITERATIONS,
+                    CompileFilesSplit(mainContext, &rootTask));
+    
+    if(serialRun.FailedCount != 0 || parallelRun.FailedCount != 0)
+    {
+        printf("Failed files, serial: %"PRIu32", parallel: %"PRIu32"\n",
+               serialRun.FailedCount,
+               parallelRun.FailedCount);
+        goto exitPoint;
+    }
+    
+    for(uint64_t i = 0; i < filesCount; ++i)
+    {
+        if(serialCounts[i] != parallelCounts[i])
+        {
+            printf("File %"PRIu64" has %"PRIu32" statements, expected %"PRIu32"\n",
+                   i,
+                   parallelCounts[i],
+                   serialCounts[i]);
+            goto exitPoint;
+        }
+    }
+    exitCode = 0;
+    
+    exitPoint:;
+    free(parallelCounts);
+    free(serialCounts);
+    JobSystem_Destroy(jobSystem);
+    AlignedString_Free(&fileContent);
+    return exitCode;
+}
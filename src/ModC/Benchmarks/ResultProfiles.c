@@ -0,0 +1,145 @@
+#define ARENA_IMPLEMENTATION
+
+#include "ModC/Allocator.h"
+#include "ModC/Defer.h"
+#include "ModC/Tokenization.h"
+#include "ModC/Classification.h"
+#include "ModC/Benchmarks/Benchmark.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Runs the lexer, statement building and classification on a file with the Result.h profile this is
+built with. build.sh builds it once per `MODC_RESULT_TRACE_MODE` and prints the code size of each.
+
+Usage: ResultProfile_<Mode> <path> [iterations]
+*/
+
+#if MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_OFF
+    #define PROFILE_NAME "Trace off"
+#elif MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_RING
+    #define PROFILE_NAME "Trace ring"
+#else
+    #define PROFILE_NAME "Trace full"
+#endif
+
+static inline bool PrintIfError(Result_Void result)
+{
+    #undef ResultNameState
+    #define ResultNameState Result_Void
+    
+    if(!result.HasError)
+        return false;
+    
+    String resultStr = RESULT_TO_STRING_S(result);
+    printf("%.*s\n", (int)resultStr.Length, resultStr.Data);
+    String_Free(&resultStr);
+    RESULT_FREE_RESOURCE_S(&result);
+    return true;
+}
+
+//Returns false if any stage failed
+static bool RunPipeline(ConstStringView source)
+{
+    #undef ResultNameState
+    #define ResultNameState Result_Void
+    
+    Allocator mainArena = CreateArenaAllocator(source.Length * 64);
+    Allocator scratchArena = CreateArenaAllocator(4096);
+    Allocator statementListArena = {0};
+    bool succeeded = false;
+    
+    Result_TokenList tokenListResult = Tokenization(source, Allocator_Share(&mainArena));
+    if(tokenListResult.HasError)
+    {
+        PrintIfError(RESULT_ERROR_S(tokenListResult.ValueOrError.Error));
+        goto exitPoint;
+    }
+    TokenList* tokenList = &tokenListResult.ValueOrError.Value;
+    
+    Result_StatementList statementListResult = CreateStatements(  tokenList,
+                                                                    source,
+                                                                    Allocator_Share(&mainArena),
+                                                                    &statementListArena);
+    if(statementListResult.HasError)
+    {
+        PrintIfError(RESULT_ERROR_S(statementListResult.ValueOrError.Error));
+        goto freeTokens;
+    }
+    StatementList* statementList = &statementListResult.ValueOrError.Value;
+    
+    Result_Void classifyResult =
+        CleanAndClassifyStatements( statementList,
+                                    Allocator_Share(&mainArena),
+                                    Allocator_Share(&statementListArena),
+                                    tokenList,
+                                    source,
+                                    Allocator_Share(&scratchArena));
+    succeeded = !PrintIfError(classifyResult);
+    Benchmark_Sink(StatementList_Last(statementList));
+    
+    Allocator_Destroy(&statementListArena);
+    freeTokens:;
+    TokenList_Free(tokenList);
+    exitPoint:;
+    Allocator_Destroy(&scratchArena);
+    Allocator_Destroy(&mainArena);
+    return succeeded;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        printf("Usage: %s <path> [iterations]\n", argv[0]);
+        return 1;
+    }
+    
+    uint64_t iterations = argc > 2 ? strtoull(argv[2], NULL, 10) : 200;
+    
+    FILE* sourceFile = fopen(argv[1], "rb");
+    if(!sourceFile)
+    {
+        printf("Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    
+    fseek(sourceFile, 0, SEEK_END);
+    long fileSize = ftell(sourceFile);
+    fseek(sourceFile, 0, SEEK_SET);
+    
+    Allocator heapAllocator = CreateHeapAllocator();
+    AlignedString fileContent = AlignedString_Create(Allocator_Share(&heapAllocator), fileSize);
+    AlignedString_Resize(&fileContent, fileSize);
+    size_t readSize = fread(fileContent.Data, 1, fileSize, sourceFile);
+    fclose(sourceFile);
+    if(fileSize <= 0 || readSize != (size_t)fileSize)
+    {
+        printf("Failed to read %s\n", argv[1]);
+        AlignedString_Free(&fileContent);
+        return 1;
+    }
+    
+    ConstStringView source = ConstStringView_Create(fileContent.Data, fileContent.Length);
+    if(!RunPipeline(source))
+    {
+        AlignedString_Free(&fileContent);
+        return 1;
+    }
+    
+    printf( "%s, %ld bytes, MAX_TRACES %d, sizeof(Error) %zu\n",
+            PROFILE_NAME,
+            fileSize,
+            MAX_TRACES,
+            sizeof(Error));
+    BENCHMARK_RUN(  PROFILE_NAME ": Tokenize + statements + classify",
+                    iterations,
+                    RunPipeline(source));
+    
+    AlignedString_Free(&fileContent);
+    return 0;
+}
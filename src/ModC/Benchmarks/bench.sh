@@ -0,0 +1,74 @@
+#! /bin/sh
+set -e
+
+# Builds an optimized BenchRunner, generates the corpus set and times every phase over it.
+# Results are written to Build/BenchResults.json and compared with the stored baseline if there is
+# one. Exits with 2 if a phase regressed.
+#
+# Usage: bench.sh [--save-baseline] [BenchRunner options]
+#   --save-baseline     Stores this run as the baseline for the next ones
+#
+# ModCBenchBaseline overrides the baseline path (default Build/BenchBaseline.json)
+
+ModCBenchScriptDir="$(dirname "$0")"
+ModCRepoRoot="${ModCBenchScriptDir}/../../.."
+ModCBenchBuildDir="${ModCBenchScriptDir}/Build"
+ModCCorpusDir="${ModCBenchBuildDir}/Corpus"
+ModCBenchBaseline="${ModCBenchBaseline:-${ModCBenchBuildDir}/BenchBaseline.json}"
+
+# Same flags as main build.sh, optimized and without sanitizers
+ModCBenchFlags="-std=c99 -D_DEFAULT_SOURCE -Wall -Wextra -Wpedantic -Werror -Wno-sign-compare -O2 -g"
+
+ModCIncludes="-I${ModCRepoRoot}/External -I${ModCRepoRoot}/src"
+
+ModCSaveBaseline=0
+if [ "$1" = "--save-baseline" ]; then
+    ModCSaveBaseline=1
+    shift
+fi
+
+mkdir -p "${ModCCorpusDir}"
+
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/CorpusGenerator.c" -o "${ModCBenchBuildDir}/CorpusGenerator"
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/BenchRunner.c" -o "${ModCBenchBuildDir}/BenchRunner"
+
+# Fixed seeds, so the corpus set only changes if the generator does
+ModCGenerate()
+{
+    ModCCorpusName="$1"
+    shift
+    "${ModCBenchBuildDir}/CorpusGenerator" "$@" "${ModCCorpusDir}/${ModCCorpusName}.modc"
+}
+
+ModCGenerate Small      --seed=1 --size=64K
+ModCGenerate Medium     --seed=2 --size=1M
+ModCGenerate Large      --seed=3 --size=16M
+ModCGenerate Nested     --seed=4 --size=1M --depth=8 \
+                        --mix=declare:2,assign:2,call:1,if:4,while:2,switch:2,block:2,return:1
+ModCGenerate Commented  --seed=5 --size=1M --comments=60 --continuations=20
+ModCGenerate OneFunction --seed=6 --size=1M --functions=1
+
+ModCBaselineArg=""
+if [ "${ModCSaveBaseline}" = 0 ] && [ -f "${ModCBenchBaseline}" ]; then
+    ModCBaselineArg="--baseline=${ModCBenchBaseline}"
+fi
+
+ModCBenchStatus=0
+"${ModCBenchBuildDir}/BenchRunner" \
+    --output="${ModCBenchBuildDir}/BenchResults.json" ${ModCBaselineArg} "$@" \
+    "${ModCCorpusDir}/Small.modc" \
+    "${ModCCorpusDir}/Medium.modc" \
+    "${ModCCorpusDir}/Large.modc" \
+    "${ModCCorpusDir}/Nested.modc" \
+    "${ModCCorpusDir}/Commented.modc" \
+    "${ModCCorpusDir}/OneFunction.modc" \
+    "${ModCRepoRoot}/docs/pygments-plugin-modc/actions.modc" || ModCBenchStatus=$?
+
+if [ "${ModCSaveBaseline}" = 1 ] && [ "${ModCBenchStatus}" = 0 ]; then
+    cp "${ModCBenchBuildDir}/BenchResults.json" "${ModCBenchBaseline}"
+    echo "Saved baseline to ${ModCBenchBaseline}"
+fi
+
+exit ${ModCBenchStatus}
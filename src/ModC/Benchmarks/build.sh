@@ -0,0 +1,57 @@
+#! /bin/sh
+set -e
+
+ModCBenchScriptDir="$(dirname "$0")"
+ModCRepoRoot="${ModCBenchScriptDir}/../../.."
+
+# Same flags as main build.sh, optimized and without sanitizers. _DEFAULT_SOURCE exposes
+# clock_gettime() and the mmap() flags for virtual arenas
+ModCBenchFlags="-std=c99 -D_DEFAULT_SOURCE -Wall -Wextra -Wpedantic -Werror -Wno-sign-compare -O2 -g"
+
+ModCIncludes="-I${ModCRepoRoot}/External -I${ModCRepoRoot}/src"
+
+mkdir -p "${ModCBenchScriptDir}/Build"
+
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/AllocatorDispatch.c" -o "${ModCBenchScriptDir}/Build/AllocatorDispatch"
+
+#Same defer scopes with each Defer.h backend
+gcc ${ModCBenchFlags} ${ModCIncludes} -DMODC_DEFER_COMPUTED_GOTO=0 \
+    "${ModCBenchScriptDir}/DeferBackends.c" -o "${ModCBenchScriptDir}/Build/DeferBackend_Switch"
+gcc ${ModCBenchFlags} ${ModCIncludes} -DMODC_DEFER_COMPUTED_GOTO=1 \
+    "${ModCBenchScriptDir}/DeferBackends.c" -o "${ModCBenchScriptDir}/Build/DeferBackend_Goto"
+
+#Synthetic .modc inputs of any size for the benchmarks below
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/CorpusGenerator.c" -o "${ModCBenchScriptDir}/Build/CorpusGenerator"
+
+#Phase timings over a corpus set, bench.sh runs it
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/BenchRunner.c" -o "${ModCBenchScriptDir}/Build/BenchRunner"
+
+#Many copies of a file compiled serially and on a job system
+gcc ${ModCBenchFlags} ${ModCIncludes} -pthread \
+    "${ModCBenchScriptDir}/JobsPipeline.c" -o "${ModCBenchScriptDir}/Build/JobsPipeline"
+
+#List, View, TaggedUnion and allocator operations, with and without canaries
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/Containers.c" -o "${ModCBenchScriptDir}/Build/Containers_Canary"
+gcc ${ModCBenchFlags} ${ModCIncludes} -DALLOCATOR_NO_CANARY=1 \
+    "${ModCBenchScriptDir}/Containers.c" -o "${ModCBenchScriptDir}/Build/Containers_NoCanary"
+
+#Replays a ModCAllocatorTrace.bin from a ModC built with -DALLOCATOR_TRACE=1
+gcc ${ModCBenchFlags} ${ModCIncludes} \
+    "${ModCBenchScriptDir}/AllocReplay.c" -o "${ModCBenchScriptDir}/Build/AllocReplay_Canary"
+gcc ${ModCBenchFlags} ${ModCIncludes} -DALLOCATOR_NO_CANARY=1 \
+    "${ModCBenchScriptDir}/AllocReplay.c" -o "${ModCBenchScriptDir}/Build/AllocReplay_NoCanary"
+
+#Same lexer and classifier with each Result.h trace profile, then their code sizes
+for ModCTraceMode in FULL RING OFF; do
+    gcc ${ModCBenchFlags} ${ModCIncludes} -DMODC_RESULT_TRACE_MODE=MODC_RESULT_TRACE_${ModCTraceMode} \
+        "${ModCBenchScriptDir}/ResultProfiles.c" \
+        -o "${ModCBenchScriptDir}/Build/ResultProfile_${ModCTraceMode}"
+done
+
+if command -v size > /dev/null; then
+    size "${ModCBenchScriptDir}"/Build/ResultProfile_*
+fi
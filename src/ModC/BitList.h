@@ -0,0 +1,363 @@
+#include "ModC/Allocator.h"
+#include "MacroPowerToys/Miscellaneous.h"
+
+/* Docs
+List of bits stored in 64 bit words. Can be used as a bit stack (`_Push()`/`_Pop()`) or as a dense
+set of indices (`_Set()`/`_Test()`/`_FindFirstSet()` and the bulk operations).
+
+Define `LIST_NAME` for the name of the list.
+Define `NO_TYPEDEF` optionally to not use typedef struct
+
+Then include this file
+
+Bits past `Length` are always 0. Bulk operations (`_And()`, `_Or()`, `_AndNot()`, `_Xor()`) work on
+the first `min(this->Length, other->Length)` bits of `this` and use AVX2 when available.
+
+Just read the code for the functions
+*/
+
+#ifndef LIST_NAME
+    #error "LIST_NAME is not defined"
+#endif
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef MODC_BIT_LIST_COMMON
+#define MODC_BIT_LIST_COMMON
+
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+    #endif
+    
+    //32 bytes so AVX2 loads of the words don't straddle cache lines
+    #define BIT_LIST_ALIGNMENT 32
+    
+    typedef enum
+    {
+        BitListOp_And,
+        BitListOp_Or,
+        BitListOp_AndNot,
+        BitListOp_Xor,
+    } BitListOp;
+    
+    static inline uint64_t BitList_WordCount(uint64_t bitCount)
+    {
+        return bitCount / 64 + (bitCount % 64 != 0);
+    }
+    
+    static inline uint64_t BitList_PopcountWord(uint64_t word)
+    {
+        #if defined(__GNUC__) || defined(__clang__)
+            return (uint64_t)__builtin_popcountll(word);
+        #else
+            word = word - ((word >> 1) & 0x5555555555555555ull);
+            word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+            word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+            return (word * 0x0101010101010101ull) >> 56;
+        #endif
+    }
+    
+    //`word` must not be 0
+    static inline uint64_t BitList_LowestBitWord(uint64_t word)
+    {
+        #if defined(__GNUC__) || defined(__clang__)
+            return (uint64_t)__builtin_ctzll(word);
+        #else
+            uint64_t retIndex = 0;
+            while(!(word & 1))
+            {
+                word >>= 1;
+                ++retIndex;
+            }
+            return retIndex;
+        #endif
+    }
+    
+    //`dst = dst <op> src` for `wordCount` words
+    static inline void BitList_ApplyWords(  uint64_t* dst,
+                                            const uint64_t* src,
+                                            uint64_t wordCount,
+                                            BitListOp op)
+    {
+        uint64_t i = 0;
+        #if defined(__AVX2__)
+            for(; i + 4 <= wordCount; i += 4)
+            {
+                __m256i dstWords = _mm256_loadu_si256((const __m256i*)(const void*)(dst + i));
+                __m256i srcWords = _mm256_loadu_si256((const __m256i*)(const void*)(src + i));
+                switch(op)
+                {
+                    case BitListOp_And:
+                        dstWords = _mm256_and_si256(dstWords, srcWords);
+                        break;
+                    case BitListOp_Or:
+                        dstWords = _mm256_or_si256(dstWords, srcWords);
+                        break;
+                    case BitListOp_AndNot:
+                        dstWords = _mm256_andnot_si256(srcWords, dstWords);
+                        break;
+                    case BitListOp_Xor:
+                        dstWords = _mm256_xor_si256(dstWords, srcWords);
+                        break;
+                }
+                _mm256_storeu_si256((__m256i*)(void*)(dst + i), dstWords);
+            }
+        #endif
+        
+        for(; i < wordCount; ++i)
+        {
+            switch(op)
+            {
+                case BitListOp_And:
+                    dst[i] &= src[i];
+                    break;
+                case BitListOp_Or:
+                    dst[i] |= src[i];
+                    break;
+                case BitListOp_AndNot:
+                    dst[i] &= ~src[i];
+                    break;
+                case BitListOp_Xor:
+                    dst[i] ^= src[i];
+                    break;
+            }
+        }
+    }
+#endif
+
+#if NO_TYPEDEF
+    struct LIST_NAME
+    {
+        Allocator Allocator;
+        uint64_t* Words;
+        uint64_t Length;        //In bits
+        uint64_t WordCap;
+    };
+#else
+    typedef struct LIST_NAME
+    {
+        Allocator Allocator;
+        uint64_t* Words;
+        uint64_t Length;        //In bits
+        uint64_t WordCap;
+    } LIST_NAME;
+#endif
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(LIST_NAME* this, uint64_t reserveBitCount)
+{
+    uint64_t reserveWordCount = BitList_WordCount(reserveBitCount);
+    if(!this || this->WordCap >= reserveWordCount)
+        return this;
+    
+    uint64_t* words = Allocator_ReallocAligned( &this->Allocator,
+                                                this->WordCap == 0 ? NULL : this->Words,
+                                                sizeof(uint64_t) * reserveWordCount,
+                                                BIT_LIST_ALIGNMENT);
+    if(!words)
+        return this;
+    memset(words + this->WordCap, 0, sizeof(uint64_t) * (reserveWordCount - this->WordCap));
+    this->Words = words;
+    this->WordCap = reserveWordCount;
+    return this;
+}
+
+static inline LIST_NAME
+MPT_DELAYED_CONCAT(LIST_NAME, _Create)(Allocator allocator, uint64_t bitCap)
+{
+    LIST_NAME retList = { .Allocator = allocator };
+    MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(&retList, bitCap);
+    return retList;
+}
+
+static inline void MPT_DELAYED_CONCAT(LIST_NAME, _Free)(LIST_NAME* this)
+{
+    if(!this)
+        return;
+    
+    if(this->Words)
+        Allocator_FreeAligned(&this->Allocator, this->Words);
+    Allocator_Destroy(&this->Allocator);
+    *this = (LIST_NAME){0};
+}
+
+//New bits are 0
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(LIST_NAME* this, uint64_t resizeLength)
+{
+    if(!this)
+        return this;
+    
+    //Shrinking, clear the bits we are dropping so they are 0 if we grow again
+    if(this->Length >= resizeLength)
+    {
+        uint64_t oldWordCount = BitList_WordCount(this->Length);
+        uint64_t newWordCount = BitList_WordCount(resizeLength);
+        if(resizeLength % 64 != 0)
+            this->Words[newWordCount - 1] &= (1ull << (resizeLength % 64)) - 1;
+        if(oldWordCount > newWordCount)
+            memset(this->Words + newWordCount, 0, sizeof(uint64_t) * (oldWordCount - newWordCount));
+        this->Length = resizeLength;
+        return this;
+    }
+    
+    if(this->WordCap < BitList_WordCount(resizeLength))
+    {
+        //Double the cap like List.h
+        uint64_t newBitCap = this->WordCap * 64 * 2;
+        newBitCap = newBitCap < resizeLength ? resizeLength : newBitCap;
+        MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(this, newBitCap);
+        if(this->WordCap < BitList_WordCount(resizeLength))
+            return this;
+    }
+    this->Length = resizeLength;
+    return this;
+}
+
+static inline bool MPT_DELAYED_CONCAT(LIST_NAME, _Test)(const LIST_NAME* this, uint64_t index)
+{
+    if(!this || index >= this->Length)
+        return false;
+    return (this->Words[index / 64] >> (index % 64)) & 1;
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Set)(LIST_NAME* this, uint64_t index, bool value)
+{
+    if(!this || index >= this->Length)
+        return this;
+    
+    uint64_t bit = 1ull << (index % 64);
+    if(value)
+        this->Words[index / 64] |= bit;
+    else
+        this->Words[index / 64] &= ~bit;
+    return this;
+}
+
+static inline LIST_NAME* MPT_DELAYED_CONCAT(LIST_NAME, _Push)(LIST_NAME* this, bool value)
+{
+    if(!this)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    return MPT_DELAYED_CONCAT(LIST_NAME, _Set)(this, oldLength, value);
+}
+
+//Returns false if empty
+static inline bool MPT_DELAYED_CONCAT(LIST_NAME, _Last)(const LIST_NAME* this)
+{
+    if(!this || this->Length == 0)
+        return false;
+    return MPT_DELAYED_CONCAT(LIST_NAME, _Test)(this, this->Length - 1);
+}
+
+//Removes and returns the last bit. Returns false if empty
+static inline bool MPT_DELAYED_CONCAT(LIST_NAME, _Pop)(LIST_NAME* this)
+{
+    if(!this || this->Length == 0)
+        return false;
+    bool retBit = MPT_DELAYED_CONCAT(LIST_NAME, _Last)(this);
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, this->Length - 1);
+    return retBit;
+}
+
+//Sets all bits to `value`
+static inline LIST_NAME* MPT_DELAYED_CONCAT(LIST_NAME, _Fill)(LIST_NAME* this, bool value)
+{
+    if(!this || this->Length == 0)
+        return this;
+    
+    uint64_t wordCount = BitList_WordCount(this->Length);
+    memset(this->Words, value ? 0xff : 0, sizeof(uint64_t) * wordCount);
+    if(value && this->Length % 64 != 0)
+        this->Words[wordCount - 1] = (1ull << (this->Length % 64)) - 1;
+    return this;
+}
+
+static inline uint64_t MPT_DELAYED_CONCAT(LIST_NAME, _Popcount)(const LIST_NAME* this)
+{
+    if(!this)
+        return 0;
+    
+    uint64_t retCount = 0;
+    uint64_t wordCount = BitList_WordCount(this->Length);
+    for(uint64_t i = 0; i < wordCount; ++i)
+        retCount += BitList_PopcountWord(this->Words[i]);
+    return retCount;
+}
+
+//Returns the index of the first set bit at or after `startIndex`. Otherwise return `this->Length`
+static inline uint64_t
+MPT_DELAYED_CONCAT(LIST_NAME, _FindFirstSet)(const LIST_NAME* this, uint64_t startIndex)
+{
+    if(!this || startIndex >= this->Length)
+        return this ? this->Length : 0;
+    
+    uint64_t wordCount = BitList_WordCount(this->Length);
+    uint64_t wordIndex = startIndex / 64;
+    uint64_t word = this->Words[wordIndex] & (~0ull << (startIndex % 64));
+    while(true)
+    {
+        if(word)
+            return wordIndex * 64 + BitList_LowestBitWord(word);
+        if(++wordIndex >= wordCount)
+            return this->Length;
+        word = this->Words[wordIndex];
+    }
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _InternApply)(LIST_NAME* this, const LIST_NAME* other, BitListOp op)
+{
+    if(!this || !other)
+        return this;
+    
+    uint64_t length = this->Length < other->Length ? this->Length : other->Length;
+    uint64_t fullWordCount = length / 64;
+    BitList_ApplyWords(this->Words, other->Words, fullWordCount, op);
+    
+    //Only touch the bits in range for the partial word
+    if(length % 64 != 0)
+    {
+        uint64_t mask = (1ull << (length % 64)) - 1;
+        uint64_t word = this->Words[fullWordCount];
+        uint64_t result = word;
+        BitList_ApplyWords(&result, &other->Words[fullWordCount], 1, op);
+        this->Words[fullWordCount] = (word & ~mask) | (result & mask);
+    }
+    return this;
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _And)(LIST_NAME* this, const LIST_NAME* other)
+{
+    return MPT_DELAYED_CONCAT(LIST_NAME, _InternApply)(this, other, BitListOp_And);
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Or)(LIST_NAME* this, const LIST_NAME* other)
+{
+    return MPT_DELAYED_CONCAT(LIST_NAME, _InternApply)(this, other, BitListOp_Or);
+}
+
+//Clears the bits in `this` that are set in `other`
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _AndNot)(LIST_NAME* this, const LIST_NAME* other)
+{
+    return MPT_DELAYED_CONCAT(LIST_NAME, _InternApply)(this, other, BitListOp_AndNot);
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Xor)(LIST_NAME* this, const LIST_NAME* other)
+{
+    return MPT_DELAYED_CONCAT(LIST_NAME, _InternApply)(this, other, BitListOp_Xor);
+}
+
+#undef LIST_NAME
+#undef NO_TYPEDEF
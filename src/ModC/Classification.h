@@ -9,27 +9,28 @@
 #include "ModC/Tokenization.h"
 #include "ModC/GenericContainers.h"
 #include "ModC/Result.h"
+#include "ModC/TraceEvents.h"
 
-#define NO_DECLTYPE
-#include "uthash.h"
-typedef struct TypeEntry
-{
-    String Type;
-    UT_hash_handle hh;
-} TypeEntry;
+//Keys point to type names copied into the type table allocator
+#define MAP_NAME TypeHashSet
+#define KEY_TYPE ConstStringView
+#define KEY_HASH(key) HashMap_HashBytes((key)->Data, (key)->Length)
+#define KEY_EQUAL(keyA, keyB) StringLikeEqual(*(keyA), *(keyB))
+#include "ModC/HashMap.h"
 
 #define RETURN_VISUALIZED_ERROR(tokenPtr, source, spanLine, fmtMsg, ...) \
         do \
         { \
             String visualizeStr = Token_VisualizeLocation(  tokenPtr, \
-                                                            CreateHeapAllocator(), \
+                                                            Result_ErrorAllocator(), \
                                                             spanLine, \
                                                             source); \
             \
-            return ERROR_STR_FMT_S((fmtMsg "\n%.*s", \
-                                    __VA_ARGS__, \
-                                    visualizeStr.Length, \
-                                    visualizeStr.Data)); \
+            return ERROR_STR_FMT_ALLOC_S(   Result_ErrorAllocator(), \
+                                            (fmtMsg "\n%.*s", \
+                                            __VA_ARGS__, \
+                                            visualizeStr.Length, \
+                                            visualizeStr.Data)); \
         } \
         while(0)
 
@@ -37,20 +38,16 @@ static inline Result_Void TryClassifyAsTypeDeclaration( Statement* statement,
                                                         const TokenList* tokens,
                                                         const ConstStringView source,
                                                         Allocator statementsArena,
-                                                        Allocator scratchAllocator,
+                                                        Allocator typeTableAllocator,
                                                         bool inTypeDecl,
                                                         bool inFuncImpl,
-                                                        TypeEntry** rootTypeHashSet,
-                                                        TypeEntry** funcTypeHashSet)
+                                                        TypeHashSet* rootTypeHashSet,
+                                                        TypeHashSet* funcTypeHashSet)
 {
     #undef ResultNameState
     #define ResultNameState Result_Void
     #undef TaggedUnionNameState
     #define TaggedUnionNameState StatementInfoUnion
-    #undef uthash_malloc
-    #define uthash_malloc(sz) Allocator_Malloc(&scratchAllocator, sz)
-    #undef uthash_free
-    #define uthash_free(ptr, sz) Allocator_Free(&scratchAllocator, ptr)
     
     if(statement->StatementType == StatementType_Compound || inTypeDecl)
         return RESULT_VALUE_S(0);
@@ -88,19 +85,16 @@ static inline Result_Void TryClassifyAsTypeDeclaration( Statement* statement,
     ConstStringView typeNameTextView = *RESULT_TRY(constStringViewResult, RET_ERROR_S());
     {
         TypeDeclarationInfo* typeDeclInfo = &statement->Info.TU_DATA_S(TypeDeclarationInfo);
-        typeDeclInfo->TypeName = String_FromData(   statementsArena, 
-                                                    typeNameTextView.Data, 
-                                                    typeNameTextView.Length);
-        typeNameTextView = ConstStringView_Create(  typeDeclInfo->TypeName.Data, 
-                                                    typeDeclInfo->TypeName.Length);
+        typeDeclInfo->TypeName = SmallString_FromData(  statementsArena, 
+                                                        typeNameTextView.Data, 
+                                                        typeNameTextView.Length);
+        typeNameTextView = SmallString_ConstView(&typeDeclInfo->TypeName);
     }
-    TypeEntry* foundEntry = NULL;
-    HASH_FIND(hh, *rootTypeHashSet, typeNameTextView.Data, typeNameTextView.Length, foundEntry);
-    
-    if(!foundEntry && inFuncImpl)
-        HASH_FIND(hh, *funcTypeHashSet, typeNameTextView.Data, typeNameTextView.Length, foundEntry);
+    bool typeExist = TypeHashSet_Contains(rootTypeHashSet, &typeNameTextView);
+    if(!typeExist && inFuncImpl)
+        typeExist = TypeHashSet_Contains(funcTypeHashSet, &typeNameTextView);
     
-    if(foundEntry)
+    if(typeExist)
     {
         Result_TokenPtr tokenPtrResult = Statement_GetTokenAt(statement, tokens, 1);
         Token* tokenPtr = *RESULT_TRY(tokenPtrResult, RET_ERROR_S());
@@ -112,13 +106,15 @@ static inline Result_Void TryClassifyAsTypeDeclaration( Statement* statement,
                                 typeNameTextView.Data);
     }
     
-    TypeEntry* entry = Allocator_Malloc(&scratchAllocator, sizeof(TypeEntry));
-    CHECK(entry, (""), RET_ERROR_S());
-    entry->Type = String_FromData(scratchAllocator, typeNameTextView.Data, typeNameTextView.Length);
-    if(inFuncImpl)
-        HASH_ADD_KEYPTR(hh, *funcTypeHashSet, entry->Type.Data, entry->Type.Length, entry);
-    else
-        HASH_ADD_KEYPTR(hh, *rootTypeHashSet, entry->Type.Data, entry->Type.Length, entry);
+    String typeName = String_FromData(  typeTableAllocator, 
+                                        typeNameTextView.Data, 
+                                        typeNameTextView.Length);
+    CHECK(typeName.Length == typeNameTextView.Length, (""), RET_ERROR_S());
+    
+    const ConstStringView typeNameKey = ConstStringView_Create(typeName.Data, typeName.Length);
+    CHECK(  TypeHashSet_Add(inFuncImpl ? funcTypeHashSet : rootTypeHashSet, typeNameKey), 
+            (""), 
+            RET_ERROR_S());
     
     return RESULT_VALUE_S(0);
 }
@@ -135,19 +131,22 @@ static inline Result_Void TryClassifyEnumValues(Statement* statement,
     if(statement->StatementType == StatementType_Compound || !inTypeDecl)
         return RESULT_VALUE_S(0);
     
-    Statement* parent = &statements->Data[statement->ParentIndex];
-    Statement* grandparent = &statements->Data[parent->ParentIndex];
+    const Statement* parent = StatementList_ConstAt(statements, statement->ParentIndex);
+    CHECK(parent, (""), RET_ERROR_S());
+    const Statement* grandparent = StatementList_ConstAt(statements, parent->ParentIndex);
+    CHECK(grandparent, (""), RET_ERROR_S());
     
     CHECK(grandparent->StatementType == StatementType_Compound, (""), RET_ERROR_S());
-    CompoundStatement* grandparentChildren = &grandparent->Tokens.TU_DATA_S(CompoundStatement);
-    uint64_t foundIndex = Uint32List_Find(&grandparentChildren->ChildStatements, &parent->Index);
+    const CompoundStatement* grandparentChildren = 
+        &grandparent->Tokens.TU_DATA_S(CompoundStatement);
+    uint64_t foundIndex = SmallUint32List_Find(&grandparentChildren->ChildStatements, &parent->Index);
     CHECK(foundIndex != grandparentChildren->ChildStatements.Length, (""), RET_ERROR_S());
     
     if(foundIndex == 0)
         return RESULT_VALUE_S(0);
     
-    const Statement* typeDecl = 
-        &statements->Data[grandparentChildren->ChildStatements.Data[foundIndex - 1]];
+    const uint32_t* siblingIndices = SmallUint32List_ConstData(&grandparentChildren->ChildStatements);
+    const Statement* typeDecl = StatementList_ConstAt(statements, siblingIndices[foundIndex - 1]);
     
     if(typeDecl->StatementType != StatementType_TypeDeclaration)
         return RESULT_VALUE_S(0);
@@ -194,8 +193,8 @@ static inline Result_Void TryClassifyAsVariableDeclareAssignment(   Statement* s
                                                                     const ConstStringView source,
                                                                     bool inTypeDecl,
                                                                     bool inFuncImpl,
-                                                                    TypeEntry** rootTypeHashSet,
-                                                                    TypeEntry** funcTypeHashSet)
+                                                                    TypeHashSet* rootTypeHashSet,
+                                                                    TypeHashSet* funcTypeHashSet)
 {
     #undef ResultNameState
     #define ResultNameState Result_Void
@@ -242,18 +241,10 @@ static inline Result_Void TryClassifyAsVariableDeclareAssignment(   Statement* s
     bool typeExist = false;
     ConstStringView typeTokenText = Token_TokenTextView(typeToken);
     if(inFuncImpl)
-    {
-        TypeEntry* foundEntry = NULL;
-        HASH_FIND(hh, *funcTypeHashSet, typeTokenText.Data, typeTokenText.Length, foundEntry);
-        typeExist = foundEntry != NULL;
-    }
+        typeExist = TypeHashSet_Contains(funcTypeHashSet, &typeTokenText);
     
     if(!typeExist)
-    {
-        TypeEntry* foundEntry = NULL;
-        HASH_FIND(hh, *rootTypeHashSet, typeTokenText.Data, typeTokenText.Length, foundEntry);
-        typeExist = foundEntry != NULL;
-    }
+        typeExist = TypeHashSet_Contains(rootTypeHashSet, &typeTokenText);
     
     if(!typeExist)
     {
@@ -315,7 +306,7 @@ static inline Result_Void TryClassifyAsFunctionDeclaration( Statement* statement
                                                             const ConstStringView source,
                                                             bool inTypeDecl,
                                                             bool inFuncImpl,
-                                                            TypeEntry** rootTypeHashSet)
+                                                            TypeHashSet* rootTypeHashSet)
 {
     #undef ResultNameState
     #define ResultNameState Result_Void
@@ -340,8 +331,8 @@ static inline Result_Void TryClassifyAsFunctionDeclaration( Statement* statement
     if(tokenCount < 4)
         return RESULT_VALUE_S(0);
     
-    Token* typeToken;
-    Token* identifierToken;
+    Token* typeToken = NULL;
+    Token* identifierToken = NULL;
     Token* argumentToken = NULL;
     
     //NOTE: Hardcode type to be index 0 and identifier to be index 1 for now
@@ -374,10 +365,7 @@ static inline Result_Void TryClassifyAsFunctionDeclaration( Statement* statement
     
     ConstStringView typeTokenText = Token_TokenTextView(typeToken);
     {
-        TypeEntry* foundEntry = NULL;
-        HASH_FIND(hh, *rootTypeHashSet, typeTokenText.Data, typeTokenText.Length, foundEntry);
-        
-        if(!foundEntry)
+        if(!TypeHashSet_Contains(rootTypeHashSet, &typeTokenText))
         {
             RETURN_VISUALIZED_ERROR(typeToken, 
                                     source, 
@@ -562,7 +550,7 @@ static inline Result_Void TryClassifyCase(  Statement* statement,
         Token* token = *RESULT_TRY(tokenPtrResult, RET_ERROR_S());
         if(token->TokenType != TokenType_Operator)
             return RESULT_VALUE_S(0);
-    
+        
         ConstStringView tokenText = Token_TokenTextView(token);
         if(!ConstStringView_IsEqualLiteral(&tokenText, ":"))
             return RESULT_VALUE_S(0);
@@ -578,7 +566,7 @@ static inline Result_Void TryClassifyCase(  Statement* statement,
         Token* token = *RESULT_TRY(tokenPtrResult, RET_ERROR_S());
         if(token->TokenType != TokenType_Identifier)
             return RESULT_VALUE_S(0);
-    
+        
         ConstStringView tokenText = Token_TokenTextView(token);
         if(!ConstStringView_IsEqualLiteral(&tokenText, "case"))
             return RESULT_VALUE_S(0);
@@ -615,7 +603,7 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
     
     uint32_t currentStatementIndex = 0;
     {
-        Statement* rootStatement = &statements->Data[0];
+        Statement* rootStatement = StatementList_At(statements, 0);
         
         CHECK(  rootStatement->StatementType == StatementType_Compound, 
                 ("Root node must be compound statement"),
@@ -626,10 +614,10 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
     }
     
     
-    TypeEntry* rootTypeHashSet = NULL;
+    TypeHashSet rootTypeHashSet = {0};
     
     //TODO: This won't work when there are nested scopes in func
-    TypeEntry* funcTypeHashSet = NULL;
+    TypeHashSet funcTypeHashSet = {0};
     
     //TODO: Pull these from centralized place instead
     char* defaultTypes[] = 
@@ -638,49 +626,59 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
         "char", "float", "double", "bool"
     };
     
-    #undef uthash_malloc
-    #define uthash_malloc(sz) Allocator_Malloc(&scratchAllocator, sz)
-    #undef uthash_free
-    #define uthash_free(ptr, sz) Allocator_Free(&scratchAllocator, ptr)
-    
-    for(int i = 0; i < sizeof(defaultTypes) / sizeof(defaultTypes[0]); ++i)
-    {
-        //printf("i: %d\n", i);
-        TypeEntry* defaultTypeEntry = Allocator_Malloc(&scratchAllocator, sizeof(TypeEntry));
-        defaultTypeEntry->Type = String_FromData(   scratchAllocator, 
-                                                    defaultTypes[i], 
-                                                    strlen(defaultTypes[i]));
-        HASH_ADD_KEYPTR(hh, 
-                        rootTypeHashSet, 
-                        defaultTypeEntry->Type.Data, 
-                        defaultTypeEntry->Type.Length,
-                        defaultTypeEntry);
-    }
+    //Type tables outlive each statement, so they can't be in the scratch allocator which is rewound
+    Allocator typeTableArena;
     
     DEFER_SCOPE_START(0)
     {
-        DEFER(0,    if(!rootTypeHashSet)
-                        HASH_CLEAR(hh, rootTypeHashSet);
-                    if(!funcTypeHashSet)
-                        HASH_CLEAR(hh, funcTypeHashSet));
+        typeTableArena = CreateArenaAllocator(4096);
+        CHECK(typeTableArena.Allocator != NULL, ("Failed to allocate"), DEFER_BREAK(0, RET_ERROR_S()));
+        DEFER(0, Allocator_Destroy(&typeTableArena));
+        
+        const uint64_t defaultTypesCount = sizeof(defaultTypes) / sizeof(defaultTypes[0]);
+        rootTypeHashSet = TypeHashSet_Create(   Allocator_Share(&typeTableArena), 
+                                                defaultTypesCount * 4);
+        funcTypeHashSet = TypeHashSet_Create(Allocator_Share(&typeTableArena), 0);
+        DEFER(0,    TypeHashSet_Free(&rootTypeHashSet);
+                    TypeHashSet_Free(&funcTypeHashSet));
+        
+        //String literals outlive the sets, no need to copy them
+        for(int i = 0; i < defaultTypesCount; ++i)
+        {
+            const ConstStringView defaultType = ConstStringView_Create( defaultTypes[i], 
+                                                                        strlen(defaultTypes[i]));
+            CHECK(  TypeHashSet_Add(&rootTypeHashSet, defaultType), 
+                    ("Failed to allocate"), 
+                    DEFER_BREAK(0, RET_ERROR_S()));
+        }
+        
+        //Scratch allocations only need to live for a single statement
+        AllocatorMark scratchMark = Allocator_Mark(&scratchAllocator);
+        DEFER(0, Allocator_Rewind(&scratchAllocator, scratchMark));
         
         int funcScope = -1;
         int typeScope = -1;
         int currentScope = 0;
         
+        //Span of the function body being classified, named by the function identifier
+        TraceSpan funcSpan = {0};
+        ConstStringView funcName = {0};
+        
         //Iterate all statements
-        Statement* prevStatement = &statements->Data[currentStatementIndex];
+        Statement* prevStatement = StatementList_At(statements, currentStatementIndex);
         do
         {
+            Allocator_Rewind(&scratchAllocator, scratchMark);
+            
             bool isEnd = false;
-            Statement* statement = &statements->Data[currentStatementIndex];
+            Statement* statement = StatementList_At(statements, currentStatementIndex);
             Result_Uint32 uint32Result = Statement_Next(statement, prevStatement, statements, &isEnd);
-            currentStatementIndex = *RESULT_TRY(uint32Result, RET_ERROR_S());
+            currentStatementIndex = *RESULT_TRY(uint32Result, DEFER_BREAK(0, RET_ERROR_S()));
             if(isEnd)
                 break;
             
             prevStatement = statement;
-            statement = &statements->Data[currentStatementIndex];
+            statement = StatementList_At(statements, currentStatementIndex);
             
             bool onExitCompound = prevStatement->ParentIndex == statement->Index;
             if(statement->StatementType == StatementType_Compound)
@@ -689,14 +687,31 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
                 {
                     --currentScope;
                     if(funcScope != -1 && funcScope == currentScope)
+                    {
                         funcScope = -1;
+                        TraceEvents_End(funcSpan, "function", funcName.Data, funcName.Length);
+                        funcSpan = (TraceSpan){0};
+                    }
                     if(typeScope != -1 && typeScope == currentScope)
                         typeScope = -1;
                 }
                 else
                 {
                     if(prevStatement->StatementType == StatementType_FunctionDeclaration)
+                    {
                         funcScope = currentScope;
+                        if(TraceEvents_IsEnabled())
+                        {
+                            const uint32_t nameIndex = 
+                                prevStatement->Info.TU_DATA(StatementInfoUnion, 
+                                                            FunctionDeclarationInfo)
+                                                   .IdentifierIndexInStatement;
+                            Result_ConstStringView nameResult = 
+                                Statement_GetTokenTextViewAt(prevStatement, tokens, nameIndex);
+                            funcName = *RESULT_TRY(nameResult, DEFER_BREAK(0, RET_ERROR_S()));
+                            funcSpan = TraceEvents_Begin();
+                        }
+                    }
                     else if(prevStatement->StatementType == StatementType_TypeDeclaration)
                         typeScope = currentScope;
                     ++currentScope;
@@ -706,7 +721,7 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
             
             CHECK(  statement->StatementType == StatementType_Unknown,
                     ("Unexpected statement type"),
-                    RET_ERROR_S());
+                    DEFER_BREAK(0, RET_ERROR_S()));
             
             Result_Void voidResult = Statement_Normalize(   statement,
                                                             tokensAllcoator,
@@ -731,7 +746,7 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
                                                                 tokens, \
                                                                 source, \
                                                                 statementsArena, \
-                                                                scratchAllocator, \
+                                                                Allocator_Share(&typeTableArena), \
                                                                 typeScope != -1, \
                                                                 funcScope != -1, \
                                                                 &rootTypeHashSet, \
@@ -898,7 +913,7 @@ static inline Result_Void CleanAndClassifyStatements(   StatementList* statement
     DEFER_SCOPE_END(0)
     
     return RESULT_VALUE_S(0);
-
+    
     #undef TRY_CLASSIFY_TYPE_DECLARATION
     #undef TRY_CLASSIFY_ENUM_VALUES
     #undef TRY_CLASSIFY_COMPILER_DIRECTIVE
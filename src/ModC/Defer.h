@@ -18,6 +18,11 @@ DEFER_SCOPE_END(scopeId)
 ```
 
 `DEFER_BREAK` will go to `DEFER_SCOPE_END` if it doesn't contain a return statement.
+
+Define `MODC_DEFER_COMPUTED_GOTO` optionally to choose how defers are unwound
+- `1`: A stack of label addresses (`&&label`), each defer jumps to the next with `goto *`.
+       Default with GCC and Clang
+- `0`: A stack of case IDs, each defer jumps back to a switch. Default otherwise
 */
 
 
@@ -29,12 +34,83 @@ DEFER_SCOPE_END(scopeId)
     #define MAX_DEFER_COUNT 32
 #endif
 
-//NOTE: Shit solution to silence c2y-extensions warnings caused by __COUNTER__ until 
+#ifndef MODC_DEFER_COMPUTED_GOTO
+    #if defined(__GNUC__) || defined(__clang__)
+        #define MODC_DEFER_COMPUTED_GOTO 1
+    #else
+        #define MODC_DEFER_COMPUTED_GOTO 0
+    #endif
+#endif
+
+//NOTE: Shit solution to silence c2y-extensions warnings caused by __COUNTER__ until
 //      https://github.com/llvm/llvm-project/issues/189645 is resolved
 #if defined(__clang__)
     #pragma clang diagnostic ignored "-Wc2y-extensions"
 #endif
 
+#if MODC_DEFER_COMPUTED_GOTO
+
+#define INTERN_DEFER_LABEL2(counter) modcDeferLabel ## counter
+#define INTERN_DEFER_LABEL(counter) INTERN_DEFER_LABEL2(counter)
+
+#define INTERN_DEFER_LABEL_ADDRESS(label) (__extension__ &&label)
+
+//Pops the last defer and jumps to it
+#define INTERN_DEFER_UNWIND() \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wpedantic\"") \
+    goto *modcDeferStack[--modcDeferCount]; \
+    _Pragma("GCC diagnostic pop")
+
+#define DEFER_SCOPE_START(id) \
+    { \
+        /* Addresses of the defer blocks, which are run from back to front. */ \
+        /* Index 0 is where we go after all of them, the scope end or a `DEFER_BREAK` block */ \
+        void* modcDeferStack[MAX_DEFER_COUNT + 1]; \
+        uint8_t modcDeferCount = 1; \
+        modcDeferStack[0] = INTERN_DEFER_LABEL_ADDRESS(modcDeferScopeEnd ## id);
+
+#define INTERNAL_DEFER(id, counter, ... /* statements */) \
+            do \
+            { \
+                if(false) \
+                { \
+                    /* Defer block */ \
+                    INTERN_DEFER_LABEL(counter):; \
+                    __VA_ARGS__; \
+                    /* Go to previous defer, we run defers in reverse order */ \
+                    INTERN_DEFER_UNWIND() \
+                } \
+                /* Register defer */ \
+                assert((modcDeferCount < MAX_DEFER_COUNT + 1) && "Number of defers exceeds maximum"); \
+                modcDeferStack[modcDeferCount++] = \
+                    INTERN_DEFER_LABEL_ADDRESS(INTERN_DEFER_LABEL(counter)); \
+            } \
+            while(false)
+
+#define INTERN_DEFER_BREAK(id, counter, ... /* statements */) \
+            do \
+            { \
+                /* Register return */ \
+                modcDeferStack[0] = INTERN_DEFER_LABEL_ADDRESS(INTERN_DEFER_LABEL(counter)); \
+                INTERN_DEFER_UNWIND() \
+                if(false) \
+                { \
+                    /* Return statement block */ \
+                    INTERN_DEFER_LABEL(counter):; \
+                    __VA_ARGS__; \
+                    goto modcDeferScopeEnd ## id; \
+                } \
+            } \
+            while(false)
+
+#define DEFER_SCOPE_END(id) \
+        INTERN_DEFER_UNWIND() \
+        modcDeferScopeEnd ## id:; \
+    }
+
+#else
+
 //Improvised from: https://btmc.substack.com/i/142434521/duffs-device-to-the-rescue
 #define DEFER_SCOPE_START(id) \
     { \
@@ -72,8 +148,6 @@ DEFER_SCOPE_END(scopeId)
             } \
             while(false)
 
-#define DEFER(id, ... /* statements */) INTERNAL_DEFER(id, __COUNTER__, __VA_ARGS__)
-
 #define INTERN_DEFER_BREAK(id, counter, ... /* statements */) \
             do \
             { \
@@ -90,8 +164,6 @@ DEFER_SCOPE_END(scopeId)
             } \
             while(false)
 
-#define DEFER_BREAK(id, ... /* statements */) INTERN_DEFER_BREAK(id, __COUNTER__, __VA_ARGS__)
-
 #define DEFER_SCOPE_END(id) \
             goto modcDeferStart ## id; \
         } /* switch(modcDefers[modcDeferIndex]) */ \
@@ -99,5 +171,11 @@ DEFER_SCOPE_END(scopeId)
         modcDeferScopeEnd ## id:; \
     }
 
+#endif
+
+#define DEFER(id, ... /* statements */) INTERNAL_DEFER(id, __COUNTER__, __VA_ARGS__)
+
+#define DEFER_BREAK(id, ... /* statements */) INTERN_DEFER_BREAK(id, __COUNTER__, __VA_ARGS__)
+
 
 #endif
@@ -10,6 +10,8 @@ Define `DEFAULT_ALLOC` to use non `_ALLOC` macro variants
 
 #include <stdbool.h>
 
+#include "static_assert.h/assert.h"
+
 #include "ModC/Result.h"
 DEFINE_RESULT_STRUCT(Result_Int32, int32_t)
 DEFINE_RESULT_STRUCT(Result_Uint32, uint32_t)
@@ -26,4 +28,15 @@ DEFINE_RESULT_STRUCT(Result_Void, Void)
 #define VALUE_TYPE bool
 #include "ModC/List.h"
 
+#define LIST_NAME BitList
+#include "ModC/BitList.h"
+
+//Same size as Uint32List
+#define LIST_NAME SmallUint32List
+#define VALUE_TYPE uint32_t
+#define INLINE_CAP 4
+#include "ModC/SmallList.h"
+
+static_assert(sizeof(SmallUint32List) == sizeof(Uint32List), "SmallUint32List grew");
+
 #endif
@@ -0,0 +1,510 @@
+#include "ModC/Allocator.h"
+#include "MacroPowerToys/Miscellaneous.h"
+
+/* Docs
+Open addressing hash map with control bytes, probed 16 slots at a time (SSE2 when available).
+
+Define `MAP_NAME` for the name of the map.
+Define `KEY_TYPE` for the key type stored in the map
+Define `VALUE_TYPE` optionally for the value type stored in the map. If not defined, this is a set.
+Define `KEY_HASH` which will be called as `uint64_t KEY_HASH(const KEY_TYPE* key)`
+Define `KEY_EQUAL` which will be called as `bool KEY_EQUAL(const KEY_TYPE* a, const KEY_TYPE* b)`
+Define `KEY_FREE` optionally which will be called as `KEY_FREE(KEY_TYPE* key)`
+Define `VALUE_FREE` optionally which will be called as `VALUE_FREE(VALUE_TYPE* val)`
+Define `NO_TYPEDEF` optionally to not use typedef struct
+
+Then include this file
+
+`<MAP_NAME>Entry` holds `Key` and `Value` (map only). Entries are stored inline in one allocation
+and move when the map grows, so don't keep pointers to them across insertions.
+
+`HashMap_HashBytes()` can be used for `KEY_HASH` of string-like keys.
+
+Just read the code for the functions
+*/
+
+#ifndef MAP_NAME
+    #error "MAP_NAME is not defined"
+#endif
+
+#ifndef KEY_TYPE
+    #error "KEY_TYPE is not defined"
+#endif
+
+#ifndef KEY_HASH
+    #error "KEY_HASH is not defined"
+#endif
+
+#ifndef KEY_EQUAL
+    #error "KEY_EQUAL is not defined"
+#endif
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef MODC_HASH_MAP_COMMON
+#define MODC_HASH_MAP_COMMON
+
+    #if defined(__SSE2__)
+        #include <emmintrin.h>
+    #endif
+    
+    #define HASH_MAP_GROUP_WIDTH 16
+    #define HASH_MAP_CTRL_EMPTY ((int8_t)-128)      //0b10000000
+    #define HASH_MAP_CTRL_DELETED ((int8_t)-2)      //0b11111110
+    
+    //Full slots store the low 7 bits of the hash, empty and deleted slots have the top bit set
+    static inline bool HashMap_IsFull(int8_t ctrl)
+    {
+        return ctrl >= 0;
+    }
+    
+    static inline uint64_t HashMap_H1(uint64_t hash)
+    {
+        return hash >> 7;
+    }
+    
+    static inline int8_t HashMap_H2(uint64_t hash)
+    {
+        return (int8_t)(hash & 0x7f);
+    }
+    
+    //Returns a bit for each control byte in the group that equals `ctrl`
+    static inline uint32_t HashMap_GroupMatch(const int8_t* group, int8_t ctrl)
+    {
+        #if defined(__SSE2__)
+            __m128i groupBytes = _mm_loadu_si128((const __m128i*)(const void*)group);
+            return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(groupBytes, _mm_set1_epi8(ctrl)));
+        #else
+            uint32_t retMask = 0;
+            for(int i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
+                retMask |= (uint32_t)(group[i] == ctrl) << i;
+            return retMask;
+        #endif
+    }
+    
+    //Returns a bit for each empty or deleted control byte in the group
+    static inline uint32_t HashMap_GroupMatchEmptyOrDeleted(const int8_t* group)
+    {
+        #if defined(__SSE2__)
+            __m128i groupBytes = _mm_loadu_si128((const __m128i*)(const void*)group);
+            return (uint32_t)_mm_movemask_epi8(groupBytes);
+        #else
+            uint32_t retMask = 0;
+            for(int i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
+                retMask |= (uint32_t)(group[i] < 0) << i;
+            return retMask;
+        #endif
+    }
+    
+    static inline int HashMap_LowestBit(uint32_t mask)
+    {
+        #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(mask);
+        #else
+            int retIndex = 0;
+            while(!(mask & 1))
+            {
+                mask >>= 1;
+                ++retIndex;
+            }
+            return retIndex;
+        #endif
+    }
+    
+    //Leading zeros of a group mask, counting from the last slot of the group
+    static inline int HashMap_GroupLeadingZeros(uint32_t mask)
+    {
+        int retCount = 0;
+        for(uint32_t bit = 1u << (HASH_MAP_GROUP_WIDTH - 1); bit && !(mask & bit); bit >>= 1)
+            ++retCount;
+        return retCount;
+    }
+    
+    static inline uint64_t HashMap_Mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+    
+    static inline uint64_t HashMap_HashBytes(const void* data, uint64_t length)
+    {
+        const unsigned char* bytes = data;
+        uint64_t retHash = 0x9e3779b97f4a7c15ull ^ (length * 0xbf58476d1ce4e5b9ull);
+        
+        for(; length >= 8; bytes += 8, length -= 8)
+        {
+            uint64_t chunk;
+            memcpy(&chunk, bytes, sizeof(chunk));
+            retHash = (retHash ^ HashMap_Mix(chunk)) * 0x9e3779b97f4a7c15ull;
+        }
+        
+        uint64_t tail = 0;
+        for(uint64_t i = 0; i < length; ++i)
+            tail |= (uint64_t)bytes[i] << (i * 8);
+        return HashMap_Mix(retHash ^ tail);
+    }
+    
+    //Maximum number of full slots for the capacity, 7/8 load factor
+    static inline uint64_t HashMap_MaxLoad(uint64_t cap)
+    {
+        return cap - cap / 8;
+    }
+#endif
+
+#if NO_TYPEDEF
+    struct MPT_DELAYED_CONCAT(MAP_NAME, Entry)
+    {
+        KEY_TYPE Key;
+        #ifdef VALUE_TYPE
+            VALUE_TYPE Value;
+        #endif
+    };
+    
+    struct MAP_NAME
+    {
+        Allocator Allocator;
+        int8_t* Ctrl;                               //`Cap + HASH_MAP_GROUP_WIDTH` bytes
+        struct MPT_DELAYED_CONCAT(MAP_NAME, Entry)* Entries;
+        uint64_t Length;
+        uint64_t Cap;                               //0 or a power of 2, at least the group width
+        uint64_t GrowthLeft;                        //Empty slots left before we need to rehash
+    };
+#else
+    typedef struct MPT_DELAYED_CONCAT(MAP_NAME, Entry)
+    {
+        KEY_TYPE Key;
+        #ifdef VALUE_TYPE
+            VALUE_TYPE Value;
+        #endif
+    } MPT_DELAYED_CONCAT(MAP_NAME, Entry);
+    
+    typedef struct MAP_NAME
+    {
+        Allocator Allocator;
+        int8_t* Ctrl;                               //`Cap + HASH_MAP_GROUP_WIDTH` bytes
+        MPT_DELAYED_CONCAT(MAP_NAME, Entry)* Entries;
+        uint64_t Length;
+        uint64_t Cap;                               //0 or a power of 2, at least the group width
+        uint64_t GrowthLeft;                        //Empty slots left before we need to rehash
+    } MAP_NAME;
+#endif
+
+//The first group is mirrored after the last slot so a group can be loaded at any slot
+static inline void
+MPT_DELAYED_CONCAT(MAP_NAME, _InternSetCtrl)(MAP_NAME* this, uint64_t slotIndex, int8_t ctrl)
+{
+    this->Ctrl[slotIndex] = ctrl;
+    if(slotIndex < HASH_MAP_GROUP_WIDTH)
+        this->Ctrl[this->Cap + slotIndex] = ctrl;
+}
+
+//Returns the first empty or deleted slot for `hash`
+static inline uint64_t
+MPT_DELAYED_CONCAT(MAP_NAME, _InternFindInsertSlot)(const MAP_NAME* this, uint64_t hash)
+{
+    uint64_t mask = this->Cap - 1;
+    uint64_t groupIndex = HashMap_H1(hash) & mask;
+    for(uint64_t probeStep = HASH_MAP_GROUP_WIDTH; ; probeStep += HASH_MAP_GROUP_WIDTH)
+    {
+        uint32_t emptyMask = HashMap_GroupMatchEmptyOrDeleted(&this->Ctrl[groupIndex]);
+        if(emptyMask)
+            return (groupIndex + HashMap_LowestBit(emptyMask)) & mask;
+        groupIndex = (groupIndex + probeStep) & mask;
+    }
+}
+
+//Returns `this->Cap` if not found
+static inline uint64_t
+MPT_DELAYED_CONCAT(MAP_NAME, _InternFindSlot)(const MAP_NAME* this, const KEY_TYPE* key)
+{
+    if(!this || !key || this->Length == 0)
+        return this ? this->Cap : 0;
+    
+    uint64_t hash = KEY_HASH(key);
+    int8_t h2 = HashMap_H2(hash);
+    uint64_t mask = this->Cap - 1;
+    uint64_t groupIndex = HashMap_H1(hash) & mask;
+    
+    //Triangular probing visits every group once since the group count is a power of 2
+    for(uint64_t step = HASH_MAP_GROUP_WIDTH; step <= this->Cap; step += HASH_MAP_GROUP_WIDTH)
+    {
+        const int8_t* group = &this->Ctrl[groupIndex];
+        uint32_t matchMask = HashMap_GroupMatch(group, h2);
+        for(; matchMask; matchMask &= matchMask - 1)
+        {
+            uint64_t slotIndex = (groupIndex + HashMap_LowestBit(matchMask)) & mask;
+            if(KEY_EQUAL(&this->Entries[slotIndex].Key, key))
+                return slotIndex;
+        }
+        
+        //An empty slot means the key was never inserted further along the probe sequence
+        if(HashMap_GroupMatch(group, HASH_MAP_CTRL_EMPTY))
+            break;
+        groupIndex = (groupIndex + step) & mask;
+    }
+    return this->Cap;
+}
+
+static inline bool MPT_DELAYED_CONCAT(MAP_NAME, _InternRehash)(MAP_NAME* this, uint64_t newCap)
+{
+    if(newCap < HASH_MAP_GROUP_WIDTH)
+        newCap = HASH_MAP_GROUP_WIDTH;
+    
+    uint64_t entriesSize = sizeof(MPT_DELAYED_CONCAT(MAP_NAME, Entry)) * newCap;
+    if( UINT64_MAX / sizeof(MPT_DELAYED_CONCAT(MAP_NAME, Entry)) < newCap ||
+        UINT64_MAX - entriesSize < newCap + HASH_MAP_GROUP_WIDTH)
+    {
+        return false;
+    }
+    
+    //Entries first so they keep the allocator's alignment, followed by the control bytes
+    char* newData = Allocator_Malloc(&this->Allocator, entriesSize + newCap + HASH_MAP_GROUP_WIDTH);
+    if(!newData)
+        return false;
+    
+    MAP_NAME oldMap = *this;
+    this->Entries = (void*)newData;
+    this->Ctrl = (int8_t*)(newData + entriesSize);
+    this->Cap = newCap;
+    this->GrowthLeft = HashMap_MaxLoad(newCap) - oldMap.Length;
+    memset(this->Ctrl, (unsigned char)HASH_MAP_CTRL_EMPTY, newCap + HASH_MAP_GROUP_WIDTH);
+    
+    for(uint64_t i = 0; i < oldMap.Cap; ++i)
+    {
+        if(!HashMap_IsFull(oldMap.Ctrl[i]))
+            continue;
+        
+        uint64_t hash = KEY_HASH(&oldMap.Entries[i].Key);
+        uint64_t slotIndex = MPT_DELAYED_CONCAT(MAP_NAME, _InternFindInsertSlot)(this, hash);
+        MPT_DELAYED_CONCAT(MAP_NAME, _InternSetCtrl)(this, slotIndex, HashMap_H2(hash));
+        this->Entries[slotIndex] = oldMap.Entries[i];
+    }
+    
+    if(oldMap.Entries)
+        Allocator_Free(&this->Allocator, oldMap.Entries);
+    return true;
+}
+
+static inline MAP_NAME* MPT_DELAYED_CONCAT(MAP_NAME, _Reserve)(MAP_NAME* this, uint64_t count)
+{
+    if(!this || (this->Cap != 0 && HashMap_MaxLoad(this->Cap) >= count))
+        return this;
+    
+    uint64_t newCap = HASH_MAP_GROUP_WIDTH;
+    while(HashMap_MaxLoad(newCap) < count && newCap <= UINT64_MAX / 4)
+        newCap *= 2;
+    MPT_DELAYED_CONCAT(MAP_NAME, _InternRehash)(this, newCap);
+    return this;
+}
+
+static inline MAP_NAME MPT_DELAYED_CONCAT(MAP_NAME, _Create)(Allocator allocator, uint64_t cap)
+{
+    MAP_NAME retMap = { .Allocator = allocator };
+    if(cap > 0)
+        MPT_DELAYED_CONCAT(MAP_NAME, _Reserve)(&retMap, cap);
+    return retMap;
+}
+
+static inline void
+MPT_DELAYED_CONCAT(MAP_NAME, _InternFreeEntry)(MAP_NAME* this, uint64_t slotIndex)
+{
+    (void)this;
+    (void)slotIndex;
+    #ifdef KEY_FREE
+        KEY_FREE(&this->Entries[slotIndex].Key);
+    #endif
+    #if defined(VALUE_TYPE) && defined(VALUE_FREE)
+        VALUE_FREE(&this->Entries[slotIndex].Value);
+    #endif
+}
+
+static inline void MPT_DELAYED_CONCAT(MAP_NAME, _Clear)(MAP_NAME* this)
+{
+    if(!this || this->Cap == 0)
+        return;
+    
+    #if defined(KEY_FREE) || (defined(VALUE_TYPE) && defined(VALUE_FREE))
+        for(uint64_t i = 0; i < this->Cap; ++i)
+        {
+            if(HashMap_IsFull(this->Ctrl[i]))
+                MPT_DELAYED_CONCAT(MAP_NAME, _InternFreeEntry)(this, i);
+        }
+    #endif
+    
+    memset(this->Ctrl, (unsigned char)HASH_MAP_CTRL_EMPTY, this->Cap + HASH_MAP_GROUP_WIDTH);
+    this->Length = 0;
+    this->GrowthLeft = HashMap_MaxLoad(this->Cap);
+}
+
+static inline void MPT_DELAYED_CONCAT(MAP_NAME, _Free)(MAP_NAME* this)
+{
+    if(!this)
+        return;
+    
+    MPT_DELAYED_CONCAT(MAP_NAME, _Clear)(this);
+    if(this->Entries)
+        Allocator_Free(&this->Allocator, this->Entries);
+    Allocator_Destroy(&this->Allocator);
+    *this = (MAP_NAME){0};
+}
+
+static inline MPT_DELAYED_CONCAT(MAP_NAME, Entry)*
+MPT_DELAYED_CONCAT(MAP_NAME, _FindEntry)(MAP_NAME* this, const KEY_TYPE* key)
+{
+    uint64_t slotIndex = MPT_DELAYED_CONCAT(MAP_NAME, _InternFindSlot)(this, key);
+    return this && slotIndex != this->Cap ? &this->Entries[slotIndex] : NULL;
+}
+
+static inline bool
+MPT_DELAYED_CONCAT(MAP_NAME, _Contains)(const MAP_NAME* this, const KEY_TYPE* key)
+{
+    return this && MPT_DELAYED_CONCAT(MAP_NAME, _InternFindSlot)(this, key) != this->Cap;
+}
+
+//Returns the existing entry for `key` or inserts a new one. `outInserted` is optional.
+//Returns NULL if we failed to allocate.
+static inline MPT_DELAYED_CONCAT(MAP_NAME, Entry)*
+MPT_DELAYED_CONCAT(MAP_NAME, _InternFindOrInsert)(  MAP_NAME* this,
+                                                    const KEY_TYPE* key,
+                                                    bool* outInserted)
+{
+    if(!this || !key)
+        return NULL;
+    
+    uint64_t slotIndex = MPT_DELAYED_CONCAT(MAP_NAME, _InternFindSlot)(this, key);
+    if(slotIndex != this->Cap)
+    {
+        if(outInserted)
+            *outInserted = false;
+        return &this->Entries[slotIndex];
+    }
+    
+    if(this->GrowthLeft == 0)
+    {
+        //Rehash in place if most of the used slots are deleted, otherwise grow
+        uint64_t newCap =   this->Cap != 0 && this->Length < HashMap_MaxLoad(this->Cap) / 2 ?
+                            this->Cap :
+                            (this->Cap == 0 ? HASH_MAP_GROUP_WIDTH : this->Cap * 2);
+        if(!MPT_DELAYED_CONCAT(MAP_NAME, _InternRehash)(this, newCap))
+            return NULL;
+    }
+    
+    uint64_t hash = KEY_HASH(key);
+    slotIndex = MPT_DELAYED_CONCAT(MAP_NAME, _InternFindInsertSlot)(this, hash);
+    if(this->Ctrl[slotIndex] == HASH_MAP_CTRL_EMPTY)
+        --(this->GrowthLeft);
+    MPT_DELAYED_CONCAT(MAP_NAME, _InternSetCtrl)(this, slotIndex, HashMap_H2(hash));
+    ++(this->Length);
+    
+    this->Entries[slotIndex].Key = *key;
+    if(outInserted)
+        *outInserted = true;
+    return &this->Entries[slotIndex];
+}
+
+#ifdef VALUE_TYPE
+    static inline VALUE_TYPE*
+    MPT_DELAYED_CONCAT(MAP_NAME, _Get)(MAP_NAME* this, const KEY_TYPE* key)
+    {
+        MPT_DELAYED_CONCAT(MAP_NAME, Entry)* entry =
+            MPT_DELAYED_CONCAT(MAP_NAME, _FindEntry)(this, key);
+        return entry ? &entry->Value : NULL;
+    }
+    
+    //Inserts or overwrites the value for `key`. Returns NULL if we failed to allocate.
+    static inline VALUE_TYPE*
+    MPT_DELAYED_CONCAT(MAP_NAME, _Set)(MAP_NAME* this, const KEY_TYPE key, const VALUE_TYPE value)
+    {
+        bool inserted = false;
+        MPT_DELAYED_CONCAT(MAP_NAME, Entry)* entry =
+            MPT_DELAYED_CONCAT(MAP_NAME, _InternFindOrInsert)(this, &key, &inserted);
+        if(!entry)
+            return NULL;
+        
+        #ifdef VALUE_FREE
+            if(!inserted)
+                VALUE_FREE(&entry->Value);
+        #endif
+        
+        #ifdef KEY_FREE
+            //Keep the existing key, the new one is not stored
+            if(!inserted)
+            {
+                KEY_TYPE unusedKey = key;
+                KEY_FREE(&unusedKey);
+            }
+        #endif
+        
+        entry->Value = value;
+        return &entry->Value;
+    }
+#else
+    //Returns the stored key, which is the existing one if `key` is already in the set.
+    //Returns NULL if we failed to allocate.
+    static inline KEY_TYPE* MPT_DELAYED_CONCAT(MAP_NAME, _Add)(MAP_NAME* this, const KEY_TYPE key)
+    {
+        MPT_DELAYED_CONCAT(MAP_NAME, Entry)* entry =
+            MPT_DELAYED_CONCAT(MAP_NAME, _InternFindOrInsert)(this, &key, NULL);
+        return entry ? &entry->Key : NULL;
+    }
+#endif
+
+//Returns true if `key` was found and removed
+static inline bool MPT_DELAYED_CONCAT(MAP_NAME, _Remove)(MAP_NAME* this, const KEY_TYPE* key)
+{
+    uint64_t slotIndex = MPT_DELAYED_CONCAT(MAP_NAME, _InternFindSlot)(this, key);
+    if(!this || slotIndex == this->Cap)
+        return false;
+    
+    MPT_DELAYED_CONCAT(MAP_NAME, _InternFreeEntry)(this, slotIndex);
+    
+    //If no group containing the slot was ever full, no probe went past it and it can be empty again
+    uint64_t mask = this->Cap - 1;
+    uint64_t groupBefore = (slotIndex - HASH_MAP_GROUP_WIDTH) & mask;
+    uint32_t emptyAfter = HashMap_GroupMatch(&this->Ctrl[slotIndex], HASH_MAP_CTRL_EMPTY);
+    uint32_t emptyBefore = HashMap_GroupMatch(&this->Ctrl[groupBefore], HASH_MAP_CTRL_EMPTY);
+    bool wasNeverFull = emptyAfter && emptyBefore &&
+                        HashMap_LowestBit(emptyAfter) + HashMap_GroupLeadingZeros(emptyBefore) <
+                        HASH_MAP_GROUP_WIDTH;
+    
+    if(wasNeverFull)
+    {
+        MPT_DELAYED_CONCAT(MAP_NAME, _InternSetCtrl)(this, slotIndex, HASH_MAP_CTRL_EMPTY);
+        ++(this->GrowthLeft);
+    }
+    else
+        MPT_DELAYED_CONCAT(MAP_NAME, _InternSetCtrl)(this, slotIndex, HASH_MAP_CTRL_DELETED);
+    --(this->Length);
+    return true;
+}
+
+//Iterates the entries in slot order. Start with `*inOutIndex` as 0, returns NULL when done.
+static inline MPT_DELAYED_CONCAT(MAP_NAME, Entry)*
+MPT_DELAYED_CONCAT(MAP_NAME, _Next)(MAP_NAME* this, uint64_t* inOutIndex)
+{
+    if(!this || !inOutIndex)
+        return NULL;
+    
+    for(; *inOutIndex < this->Cap; ++(*inOutIndex))
+    {
+        if(HashMap_IsFull(this->Ctrl[*inOutIndex]))
+            return &this->Entries[(*inOutIndex)++];
+    }
+    return NULL;
+}
+
+#undef MAP_NAME
+#undef KEY_TYPE
+#undef VALUE_TYPE
+#undef KEY_HASH
+#undef KEY_EQUAL
+#undef KEY_FREE
+#undef VALUE_FREE
+#undef NO_TYPEDEF
@@ -0,0 +1,493 @@
+#ifndef MODC_JOBS_H
+#define MODC_JOBS_H
+
+/* Docs
+A fixed pool of worker threads running jobs, for anything that wants to run in parallel instead of
+starting its own threads. Requires pthreads and GCC/Clang `__atomic` builtins.
+
+Create one with `CreateJobSystem()`, passing 0 to use one thread per core. The creating thread
+takes part as worker 0, its context is returned by `JobSystem_MainContext()`. Every job gets the
+context of the worker running it, which is used to submit and wait for more jobs.
+
+Each worker has its own deque of jobs (Chase-Lev). Submitting pushes to the back of the current
+worker's deque, and the worker takes its latest jobs from the back. Idle workers steal the oldest
+jobs from the front of other deques, then sleep until more jobs are submitted. If a deque is full,
+the job is run straight away.
+
+Fork-join: Submit jobs sharing a zero initialized `JobCounter`, then `JobSystem_Wait()` on it.
+Waiting runs other jobs until the counter reaches 0. Jobs and their user data must outlive that.
+
+`JobSystem_ParallelFor()` splits an index range into batches and waits for all of them.
+
+Each worker has a scratch thread arena, `JobContext.Scratch`, rewound after each job.
+Use `Allocator_Share(&context->Scratch)` for anything that only lives for the job.
+Worker threads destroy their Result.h error arena before exiting, so errors from jobs must be
+handled before `JobSystem_Destroy()`.
+
+Define `JOBS_DEQUE_CAPACITY` optionally to set the number of jobs each deque holds (1024)
+*/
+
+#include "ModC/Assert.h"
+#include "ModC/Allocator.h"
+#include "ModC/Result.h"
+#include "ModC/TraceEvents.h"
+
+#include "static_assert.h/assert.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifndef JOBS_DEQUE_CAPACITY
+    #define JOBS_DEQUE_CAPACITY 1024
+#endif
+
+static_assert((JOBS_DEQUE_CAPACITY & (JOBS_DEQUE_CAPACITY - 1)) == 0, "Needs to be a power of 2");
+
+//Rounds of looking for jobs before an idle worker goes to sleep
+#ifndef JOBS_SPIN_ROUNDS
+    #define JOBS_SPIN_ROUNDS 64
+#endif
+
+#define JOBS_CACHE_LINE_SIZE 64
+
+struct JobSystem;
+
+typedef struct JobContext
+{
+    struct JobSystem* System;
+    Allocator Scratch;
+    uint32_t WorkerIndex;                       //0 is the thread that created the job system
+    uint32_t RandomState;                       //For picking workers to steal from
+} JobContext;
+
+typedef void (*JobFunction)(JobContext* context, void* userData);
+typedef void (*JobRangeFunction)(JobContext* context, void* userData, uint64_t begin, uint64_t end);
+
+typedef struct JobCounter
+{
+    uint32_t Pending;                           //Atomic
+} JobCounter;
+
+typedef struct Job
+{
+    JobFunction Function;
+    void* UserData;
+    JobCounter* Counter;                        //Optional, decremented once the job is done
+} Job;
+
+//`Top` is only moved by thieves and the last pop, `Bottom` only by the owning worker
+typedef struct JobDeque
+{
+    int64_t Top;                                //Atomic
+    char TopPadding[JOBS_CACHE_LINE_SIZE - sizeof(int64_t)];
+    int64_t Bottom;                             //Atomic
+    char BottomPadding[JOBS_CACHE_LINE_SIZE - sizeof(int64_t)];
+    Job* Slots[JOBS_DEQUE_CAPACITY];            //Atomic
+} JobDeque;
+
+typedef struct JobWorker
+{
+    JobDeque Deque;
+    JobContext Context;
+    pthread_t Thread;
+} JobWorker;
+
+typedef struct JobSystem
+{
+    JobWorker* Workers;
+    uint32_t WorkerCount;                       //Including the creating thread
+    uint32_t StartedThreads;
+    ThreadArenaPool* ScratchPool;
+    
+    pthread_mutex_t SleepMutex;
+    pthread_cond_t SleepCondition;
+    uint32_t SleepingWorkers;                   //Atomic
+    int64_t QueuedJobs;                         //Atomic
+    bool ShuttingDown;                          //Atomic
+} JobSystem;
+
+typedef struct JobRangeBatch
+{
+    Job Job;
+    JobRangeFunction Function;
+    void* UserData;
+    uint64_t Begin;
+    uint64_t End;
+} JobRangeBatch;
+
+static inline JobSystem* CreateJobSystem(uint32_t workerCount, uint64_t scratchChunkSize);
+static inline void JobSystem_Destroy(JobSystem* this);
+
+static inline JobContext* JobSystem_MainContext(JobSystem* this);
+
+static inline void JobSystem_Submit(JobContext* context, Job* job);
+static inline void JobSystem_SubmitMany(JobContext* context, Job* jobs, uint32_t jobsCount);
+static inline void JobSystem_Wait(JobContext* context, JobCounter* counter);
+
+//Pass 0 for `batchSize` to split the range into a few batches per worker
+static inline void JobSystem_ParallelFor(   JobContext* context,
+                                            uint64_t begin,
+                                            uint64_t end,
+                                            uint64_t batchSize,
+                                            JobRangeFunction function,
+                                            void* userData);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+//Only called by the owning worker. Returns false if the deque is full
+static inline bool JobDeque_Push(JobDeque* this, Job* job)
+{
+    int64_t bottom = __atomic_load_n(&this->Bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&this->Top, __ATOMIC_ACQUIRE);
+    if(bottom - top >= JOBS_DEQUE_CAPACITY)
+        return false;
+    
+    __atomic_store_n(&this->Slots[bottom & (JOBS_DEQUE_CAPACITY - 1)], job, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&this->Bottom, bottom + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+//Only called by the owning worker, takes the latest job
+static inline Job* JobDeque_Pop(JobDeque* this)
+{
+    int64_t bottom = __atomic_load_n(&this->Bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&this->Bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&this->Top, __ATOMIC_RELAXED);
+    
+    if(top > bottom)
+    {
+        //Empty
+        __atomic_store_n(&this->Bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    
+    Job* job = __atomic_load_n(&this->Slots[bottom & (JOBS_DEQUE_CAPACITY - 1)], __ATOMIC_ACQUIRE);
+    if(top == bottom)
+    {
+        //Last job, race the thieves for it
+        if(!__atomic_compare_exchange_n(&this->Top,
+                                        &top,
+                                        top + 1,
+                                        false,
+                                        __ATOMIC_SEQ_CST,
+                                        __ATOMIC_RELAXED))
+        {
+            job = NULL;
+        }
+        __atomic_store_n(&this->Bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+//Called by other workers, takes the oldest job. Returns NULL if empty or another thread won it
+static inline Job* JobDeque_Steal(JobDeque* this)
+{
+    int64_t top = __atomic_load_n(&this->Top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&this->Bottom, __ATOMIC_ACQUIRE);
+    if(top >= bottom)
+        return NULL;
+    
+    Job* job = __atomic_load_n(&this->Slots[top & (JOBS_DEQUE_CAPACITY - 1)], __ATOMIC_ACQUIRE);
+    if(!__atomic_compare_exchange_n(&this->Top,
+                                    &top,
+                                    top + 1,
+                                    false,
+                                    __ATOMIC_SEQ_CST,
+                                    __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+    return job;
+}
+
+static inline void JobSystem_InternRunJob(JobContext* context, Job* job)
+{
+    JobCounter* counter = job->Counter;
+    AllocatorMark scratchMark = Allocator_Mark(&context->Scratch);
+    job->Function(context, job->UserData);
+    Allocator_Rewind(&context->Scratch, scratchMark);
+    
+    //The job can be freed by whoever is waiting as soon as this reaches 0
+    if(counter)
+        __atomic_sub_fetch(&counter->Pending, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline Job* JobSystem_InternFindJob(JobContext* context)
+{
+    JobSystem* system = context->System;
+    Job* job = JobDeque_Pop(&system->Workers[context->WorkerIndex].Deque);
+    if(!job)
+    {
+        //xorshift
+        context->RandomState ^= context->RandomState << 13;
+        context->RandomState ^= context->RandomState >> 17;
+        context->RandomState ^= context->RandomState << 5;
+        
+        const uint32_t firstVictim = context->RandomState % system->WorkerCount;
+        for(uint32_t i = 0; i < system->WorkerCount && !job; ++i)
+        {
+            const uint32_t victim = (firstVictim + i) % system->WorkerCount;
+            if(victim != context->WorkerIndex)
+                job = JobDeque_Steal(&system->Workers[victim].Deque);
+        }
+    }
+    
+    if(job)
+        __atomic_sub_fetch(&system->QueuedJobs, 1, __ATOMIC_RELAXED);
+    return job;
+}
+
+static inline void* JobSystem_InternWorkerMain(void* worker)
+{
+    JobContext* context = &((JobWorker*)worker)->Context;
+    JobSystem* system = context->System;
+    uint32_t idleRounds = 0;
+    
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "Worker %"PRIu32, context->WorkerIndex);
+    TraceEvents_SetThreadName(threadName);
+    
+    while(!__atomic_load_n(&system->ShuttingDown, __ATOMIC_ACQUIRE))
+    {
+        Job* job = JobSystem_InternFindJob(context);
+        if(job)
+        {
+            JobSystem_InternRunJob(context, job);
+            idleRounds = 0;
+            continue;
+        }
+        
+        if(++idleRounds < JOBS_SPIN_ROUNDS)
+        {
+            sched_yield();
+            continue;
+        }
+        
+        //Submitting checks for sleeping workers after queuing, and we check for queued jobs
+        //after going to sleep, so one of us always sees the other
+        pthread_mutex_lock(&system->SleepMutex);
+        __atomic_add_fetch(&system->SleepingWorkers, 1, __ATOMIC_SEQ_CST);
+        while(  __atomic_load_n(&system->QueuedJobs, __ATOMIC_SEQ_CST) <= 0 &&
+                !__atomic_load_n(&system->ShuttingDown, __ATOMIC_ACQUIRE))
+        {
+            pthread_cond_wait(&system->SleepCondition, &system->SleepMutex);
+        }
+        __atomic_sub_fetch(&system->SleepingWorkers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&system->SleepMutex);
+        idleRounds = 0;
+    }
+    
+    Result_DestroyErrorArena();
+    return NULL;
+}
+
+static inline JobSystem* CreateJobSystem(uint32_t workerCount, uint64_t scratchChunkSize)
+{
+    if(workerCount == 0)
+    {
+        #if defined(_SC_NPROCESSORS_ONLN)
+            long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+            workerCount = coreCount > 0 ? (uint32_t)coreCount : 1;
+        #else
+            workerCount = 4;
+        #endif
+    }
+    
+    JobSystem* retSystem = malloc(sizeof(JobSystem));
+    if(!retSystem)
+        return NULL;
+    
+    *retSystem = (JobSystem){ .WorkerCount = workerCount };
+    retSystem->Workers = calloc(workerCount, sizeof(JobWorker));
+    retSystem->ScratchPool = CreateThreadArenaPool(scratchChunkSize);
+    if(!retSystem->Workers || !retSystem->ScratchPool)
+    {
+        ThreadArenaPool_Destroy(retSystem->ScratchPool);
+        free(retSystem->Workers);
+        free(retSystem);
+        return NULL;
+    }
+    
+    pthread_mutex_init(&retSystem->SleepMutex, NULL);
+    pthread_cond_init(&retSystem->SleepCondition, NULL);
+    
+    for(uint32_t i = 0; i < workerCount; ++i)
+    {
+        JobContext* context = &retSystem->Workers[i].Context;
+        *context =  (JobContext)
+                    {
+                        .System = retSystem,
+                        .Scratch = CreateThreadArenaAllocator(retSystem->ScratchPool),
+                        .WorkerIndex = i,
+                        .RandomState = 2463534242u + i * 2654435761u
+                    };
+        if(!context->Scratch.Allocator)
+        {
+            JobSystem_Destroy(retSystem);
+            return NULL;
+        }
+    }
+    
+    //Worker 0 is the creating thread
+    for(uint32_t i = 1; i < workerCount; ++i)
+    {
+        if(pthread_create( &retSystem->Workers[i].Thread,
+                            NULL,
+                            JobSystem_InternWorkerMain,
+                            &retSystem->Workers[i]) != 0)
+        {
+            JobSystem_Destroy(retSystem);
+            return NULL;
+        }
+        ++retSystem->StartedThreads;
+    }
+    
+    return retSystem;
+}
+
+//Jobs still queued are not run, wait for them first
+static inline void JobSystem_Destroy(JobSystem* this)
+{
+    if(!this)
+        return;
+    
+    pthread_mutex_lock(&this->SleepMutex);
+    __atomic_store_n(&this->ShuttingDown, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&this->SleepCondition);
+    pthread_mutex_unlock(&this->SleepMutex);
+    
+    for(uint32_t i = 0; i < this->StartedThreads; ++i)
+        pthread_join(this->Workers[i + 1].Thread, NULL);
+    
+    for(uint32_t i = 0; i < this->WorkerCount; ++i)
+        Allocator_Destroy(&this->Workers[i].Context.Scratch);
+    
+    ThreadArenaPool_Destroy(this->ScratchPool);
+    pthread_cond_destroy(&this->SleepCondition);
+    pthread_mutex_destroy(&this->SleepMutex);
+    free(this->Workers);
+    free(this);
+}
+
+static inline JobContext* JobSystem_MainContext(JobSystem* this)
+{
+    return this ? &this->Workers[0].Context : NULL;
+}
+
+static inline void JobSystem_Submit(JobContext* context, Job* job)
+{
+    ASSERT(context && job && job->Function);
+    JobSystem* system = context->System;
+    if(job->Counter)
+        __atomic_add_fetch(&job->Counter->Pending, 1, __ATOMIC_RELAXED);
+    
+    __atomic_add_fetch(&system->QueuedJobs, 1, __ATOMIC_SEQ_CST);
+    if(!JobDeque_Push(&system->Workers[context->WorkerIndex].Deque, job))
+    {
+        __atomic_sub_fetch(&system->QueuedJobs, 1, __ATOMIC_RELAXED);
+        JobSystem_InternRunJob(context, job);
+        return;
+    }
+    
+    if(__atomic_load_n(&system->SleepingWorkers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&system->SleepMutex);
+        pthread_cond_signal(&system->SleepCondition);
+        pthread_mutex_unlock(&system->SleepMutex);
+    }
+}
+
+static inline void JobSystem_SubmitMany(JobContext* context, Job* jobs, uint32_t jobsCount)
+{
+    for(uint32_t i = 0; i < jobsCount; ++i)
+        JobSystem_Submit(context, &jobs[i]);
+}
+
+static inline void JobSystem_Wait(JobContext* context, JobCounter* counter)
+{
+    ASSERT(context && counter);
+    while(__atomic_load_n(&counter->Pending, __ATOMIC_ACQUIRE) > 0)
+    {
+        Job* job = JobSystem_InternFindJob(context);
+        if(job)
+            JobSystem_InternRunJob(context, job);
+        else
+            sched_yield();
+    }
+}
+
+static inline void JobSystem_InternRunRangeBatch(JobContext* context, void* batch)
+{
+    JobRangeBatch* rangeBatch = batch;
+    rangeBatch->Function(context, rangeBatch->UserData, rangeBatch->Begin, rangeBatch->End);
+}
+
+static inline void JobSystem_ParallelFor(   JobContext* context,
+                                            uint64_t begin,
+                                            uint64_t end,
+                                            uint64_t batchSize,
+                                            JobRangeFunction function,
+                                            void* userData)
+{
+    ASSERT(context && function);
+    if(begin >= end)
+        return;
+    
+    const uint64_t rangeSize = end - begin;
+    if(batchSize == 0)
+        batchSize = rangeSize / (context->System->WorkerCount * 4) + 1;
+    
+    const uint64_t batchesCount = (rangeSize + batchSize - 1) / batchSize;
+    AllocatorMark scratchMark = Allocator_Mark(&context->Scratch);
+    JobRangeBatch* batches = batchesCount > 1 ?
+                                Allocator_Malloc(&context->Scratch,
+                                                 sizeof(JobRangeBatch) * batchesCount) :
+                                NULL;
+    if(!batches)
+    {
+        function(context, userData, begin, end);
+        Allocator_Rewind(&context->Scratch, scratchMark);
+        return;
+    }
+    
+    //The first batch is run by us after submitting the rest
+    JobCounter counter = {0};
+    for(uint64_t i = batchesCount; i-- > 1;)
+    {
+        const uint64_t batchBegin = begin + i * batchSize;
+        const uint64_t batchEnd = rangeSize - i * batchSize > batchSize ?
+                                    batchBegin + batchSize :
+                                    end;
+        batches[i] =    (JobRangeBatch)
+                        {
+                            .Job =  {
+                                        .Function = JobSystem_InternRunRangeBatch,
+                                        .UserData = &batches[i],
+                                        .Counter = &counter
+                                    },
+                            .Function = function,
+                            .UserData = userData,
+                            .Begin = batchBegin,
+                            .End = batchEnd
+                        };
+        JobSystem_Submit(context, &batches[i].Job);
+    }
+    
+    function(context, userData, begin, begin + batchSize);
+    JobSystem_Wait(context, &counter);
+    Allocator_Rewind(&context->Scratch, scratchMark);
+}
+
+#endif
@@ -6,6 +6,8 @@ Define `LIST_NAME` for the name of the list.
 Define `VALUE_TYPE` for the element type stored in the list
 Define `VALUE_FREE` optionally which will be called as `VALUE_FREE(VALUE_TYPE* val)`
 Define `NO_TYPEDEF` optionally to not use typedef struct
+Define `LIST_ALIGNMENT` optionally to a power of 2 to align the data beyond the allocator's 
+default, for example for vector loads. See `Allocator_MallocAligned()`.
 
 Then include this file
 
@@ -25,6 +27,10 @@ Just read the code for the functions
 #include <stddef.h>
 #include <stdint.h>
 
+#ifndef LIST_ALIGNMENT
+    #define LIST_ALIGNMENT 0
+#endif
+
 
 #if NO_TYPEDEF
     struct LIST_NAME
@@ -50,9 +56,18 @@ MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(LIST_NAME* this, uint32_t reserveSize)
     if(!this || this->Cap >= reserveSize)
         return this;
     
-    void* dataPtr = this->Cap == 0 ? 
-                    Allocator_Malloc(&this->Allocator, sizeof(VALUE_TYPE) * reserveSize) :
-                    Allocator_Realloc(&this->Allocator, this->Data, sizeof(VALUE_TYPE) * reserveSize);
+    #if LIST_ALIGNMENT
+        void* dataPtr = Allocator_ReallocAligned(   &this->Allocator, 
+                                                    this->Cap == 0 ? NULL : this->Data, 
+                                                    sizeof(VALUE_TYPE) * reserveSize, 
+                                                    LIST_ALIGNMENT);
+    #else
+        void* dataPtr = this->Cap == 0 ? 
+                        Allocator_Malloc(&this->Allocator, sizeof(VALUE_TYPE) * reserveSize) :
+                        Allocator_Realloc(  &this->Allocator, 
+                                            this->Data, 
+                                            sizeof(VALUE_TYPE) * reserveSize);
+    #endif
     if(!dataPtr)
         return this;
     this->Data = dataPtr;
@@ -85,7 +100,11 @@ static inline void MPT_DELAYED_CONCAT(LIST_NAME, _Free)(LIST_NAME* this)
         *this = (LIST_NAME){0};
         return;
     }
-    Allocator_Free(&this->Allocator, this->Data);
+    #if LIST_ALIGNMENT
+        Allocator_FreeAligned(&this->Allocator, this->Data);
+    #else
+        Allocator_Free(&this->Allocator, this->Data);
+    #endif
     Allocator_Destroy(&this->Allocator);
     *this = (LIST_NAME){0};
     return;
@@ -132,9 +151,18 @@ MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(LIST_NAME* this, uint64_t resizeLength)
                                     this->Cap * 2       //Yes? Just double the cap
                                 )
                             );
-    void* dataPtr = empty ? 
-                    Allocator_Malloc(&this->Allocator, newCap * sizeof(VALUE_TYPE)) :
-                    Allocator_Realloc(&this->Allocator, this->Data, newCap * sizeof(VALUE_TYPE));
+    #if LIST_ALIGNMENT
+        void* dataPtr = Allocator_ReallocAligned(   &this->Allocator, 
+                                                    empty ? NULL : this->Data, 
+                                                    newCap * sizeof(VALUE_TYPE), 
+                                                    LIST_ALIGNMENT);
+    #else
+        void* dataPtr = empty ? 
+                        Allocator_Malloc(&this->Allocator, newCap * sizeof(VALUE_TYPE)) :
+                        Allocator_Realloc(  &this->Allocator, 
+                                            this->Data, 
+                                            newCap * sizeof(VALUE_TYPE));
+    #endif
     if(!dataPtr)
         return this;
     this->Data = dataPtr;
@@ -307,3 +335,4 @@ MPT_DELAYED_CONCAT(LIST_NAME, _Find)(const LIST_NAME* this, const VALUE_TYPE* da
 #undef VALUE_TYPE
 #undef VALUE_FREE
 #undef NO_TYPEDEF
+#undef LIST_ALIGNMENT
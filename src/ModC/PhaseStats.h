@@ -0,0 +1,312 @@
+#ifndef MODC_PHASE_STATS_H
+#define MODC_PHASE_STATS_H
+
+/* Docs
+Wall and CPU time, throughput and allocations of each compiler phase, for `--stats` in main.c.
+
+Start a `PhaseTimer` with `PhaseTimer_Start()` before a phase and get its `PhaseStats` with
+`PhaseTimer_Stop()` after it. Fill in `InputBytes` and `ItemsCount` for the throughput, then
+append the report for all phases with `PhaseStats_AppendReport()` as text or JSON.
+
+Wall time uses `CLOCK_MONOTONIC` and CPU time `CLOCK_PROCESS_CPUTIME_ID`. Without them (strict
+C99 without `_POSIX_C_SOURCE`), both are measured with `clock()`, which is CPU time.
+
+Each timed phase is also recorded as a span in the "phase" category, see TraceEvents.h.
+
+Allocations are the `AllocatorProfile_Totals()` added during the phase, so they are only counted
+when built with `ALLOCATOR_PROFILE`. Peak RSS is 0 where `getrusage()` is not available.
+*/
+
+#include "ModC/AllocatorProfile.h"
+#include "ModC/TraceEvents.h"
+#include "ModC/Strings/StringBuilder.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+    #define INTERN_PHASE_STATS_HAS_RUSAGE 1
+#endif
+
+typedef enum PhaseStatsFormat
+{
+    PhaseStatsFormat_Text,
+    PhaseStatsFormat_Json,
+} PhaseStatsFormat;
+
+typedef struct PhaseStats
+{
+    const char* Name;
+    uint64_t WallNs;
+    uint64_t CpuNs;
+    uint64_t InputBytes;                //0 if the phase doesn't go through the source
+    uint64_t ItemsCount;                //What the phase produced, tokens or statements
+    const char* ItemsName;              //NULL if nothing is counted
+    AllocatorStats Allocations;         //Counters added during the phase
+} PhaseStats;
+
+typedef struct PhaseTimer
+{
+    uint64_t StartWallNs;
+    uint64_t StartCpuNs;
+    AllocatorStats StartAllocations;
+    TraceSpan Span;
+} PhaseTimer;
+
+static inline PhaseTimer PhaseTimer_Start(void);
+static inline PhaseStats PhaseTimer_Stop(const PhaseTimer* this, const char* name);
+
+static inline uint64_t PhaseStats_PeakRssBytes(void);
+
+//Appends a report for `phases` and their total
+static inline void PhaseStats_AppendReport( const PhaseStats* phases,
+                                            uint32_t phasesCount,
+                                            PhaseStatsFormat format,
+                                            StringBuilder* outBuilder);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+static inline uint64_t PhaseStats_InternClockNs(void)
+{
+    return (uint64_t)((double)clock() * (1000000000.0 / (double)CLOCKS_PER_SEC));
+}
+
+static inline uint64_t PhaseStats_WallNs(void)
+{
+    return TraceEvents_NowNs();
+}
+
+static inline uint64_t PhaseStats_CpuNs(void)
+{
+    #if defined(CLOCK_PROCESS_CPUTIME_ID)
+        struct timespec currentTime;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &currentTime);
+        return (uint64_t)currentTime.tv_sec * 1000000000ull + (uint64_t)currentTime.tv_nsec;
+    #else
+        return PhaseStats_InternClockNs();
+    #endif
+}
+
+static inline PhaseTimer PhaseTimer_Start(void)
+{
+    //Allocator totals first so summing them is not part of the phase time
+    PhaseTimer retTimer = { .StartAllocations = AllocatorProfile_Totals() };
+    retTimer.StartCpuNs = PhaseStats_CpuNs();
+    retTimer.StartWallNs = PhaseStats_WallNs();
+    retTimer.Span = TraceEvents_Begin();
+    return retTimer;
+}
+
+static inline PhaseStats PhaseTimer_Stop(const PhaseTimer* this, const char* name)
+{
+    const uint64_t wallNs = PhaseStats_WallNs();
+    const uint64_t cpuNs = PhaseStats_CpuNs();
+    TraceEvents_End(this->Span, "phase", name, strlen(name));
+    const AllocatorStats endAllocations = AllocatorProfile_Totals();
+    const AllocatorStats* startAllocations = &this->StartAllocations;
+    
+    return  (PhaseStats)
+            {
+                .Name = name,
+                .WallNs = wallNs - this->StartWallNs,
+                .CpuNs = cpuNs - this->StartCpuNs,
+                .Allocations =
+                {
+                    .Name = name,
+                    .AllocCount = endAllocations.AllocCount - startAllocations->AllocCount,
+                    .AllocBytes = endAllocations.AllocBytes - startAllocations->AllocBytes,
+                    .ReallocCount = endAllocations.ReallocCount - startAllocations->ReallocCount,
+                    .ReallocCopyBytes = endAllocations.ReallocCopyBytes -
+                                        startAllocations->ReallocCopyBytes,
+                    .FreeCount = endAllocations.FreeCount - startAllocations->FreeCount,
+                    .WastedFreeBytes =  endAllocations.WastedFreeBytes -
+                                        startAllocations->WastedFreeBytes,
+                    //Not a difference, what is in use once the phase is done
+                    .UsedBytes = endAllocations.UsedBytes,
+                    .HighWaterBytes = endAllocations.HighWaterBytes,
+                    .ReservedBytes = endAllocations.ReservedBytes,
+                    .ChainLength = endAllocations.ChainLength
+                }
+            };
+}
+
+static inline uint64_t PhaseStats_PeakRssBytes(void)
+{
+    #if INTERN_PHASE_STATS_HAS_RUSAGE
+        struct rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+        
+        //Bytes on macOS, KiB elsewhere
+        #if defined(__APPLE__)
+            return (uint64_t)usage.ru_maxrss;
+        #else
+            return (uint64_t)usage.ru_maxrss * 1024;
+        #endif
+    #else
+        return 0;
+    #endif
+}
+
+static inline double PhaseStats_InternPerSecond(uint64_t count, uint64_t ns)
+{
+    return ns ? (double)count * 1000000000.0 / (double)ns : 0.0;
+}
+
+static inline void PhaseStats_InternAppendText(const PhaseStats* phase, StringBuilder* outBuilder)
+{
+    StringBuilder_AppendFormat( outBuilder,
+                                "%-12s %12.3f %12.3f",
+                                phase->Name,
+                                (double)phase->WallNs / 1000000.0,
+                                (double)phase->CpuNs / 1000000.0);
+    
+    const char* separator = "  ";
+    if(phase->InputBytes)
+    {
+        StringBuilder_AppendFormat( outBuilder,
+                                    "%s%.2f MB/s",
+                                    separator,
+                                    PhaseStats_InternPerSecond(phase->InputBytes, phase->WallNs) /
+                                    1000000.0);
+        separator = ", ";
+    }
+    if(phase->ItemsName)
+    {
+        StringBuilder_AppendFormat( outBuilder,
+                                    "%s%.3f M %s/s",
+                                    separator,
+                                    PhaseStats_InternPerSecond(phase->ItemsCount, phase->WallNs) /
+                                    1000000.0,
+                                    phase->ItemsName);
+    }
+    StringBuilder_AppendChar(outBuilder, '\n');
+    
+    #if ALLOCATOR_PROFILE
+        const AllocatorStats* allocations = &phase->Allocations;
+        StringBuilder_AppendFormat( outBuilder,
+                                    "%-12s allocs %" PRIu64 " (%" PRIu64 " bytes), "
+                                    "reallocs %" PRIu64 " (%" PRIu64 " bytes copied), "
+                                    "frees %" PRIu64 ", in use %" PRIu64 " bytes\n",
+                                    "",
+                                    allocations->AllocCount,
+                                    allocations->AllocBytes,
+                                    allocations->ReallocCount,
+                                    allocations->ReallocCopyBytes,
+                                    allocations->FreeCount,
+                                    allocations->UsedBytes);
+    #endif
+}
+
+static inline void PhaseStats_InternAppendJson(const PhaseStats* phase, StringBuilder* outBuilder)
+{
+    StringBuilder_AppendLiteral(outBuilder, "    {\"name\": \"");
+    StringBuilder_AppendData(outBuilder, phase->Name, strlen(phase->Name));
+    StringBuilder_AppendLiteral(outBuilder, "\", \"wallNs\": ");
+    StringBuilder_AppendUInt(outBuilder, phase->WallNs);
+    StringBuilder_AppendLiteral(outBuilder, ", \"cpuNs\": ");
+    StringBuilder_AppendUInt(outBuilder, phase->CpuNs);
+    StringBuilder_AppendLiteral(outBuilder, ", \"inputBytes\": ");
+    StringBuilder_AppendUInt(outBuilder, phase->InputBytes);
+    StringBuilder_AppendLiteral(outBuilder, ", \"bytesPerSecond\": ");
+    StringBuilder_AppendDouble( outBuilder,
+                                PhaseStats_InternPerSecond(phase->InputBytes, phase->WallNs));
+    
+    StringBuilder_AppendLiteral(outBuilder, ", \"items\": ");
+    StringBuilder_AppendUInt(outBuilder, phase->ItemsCount);
+    StringBuilder_AppendLiteral(outBuilder, ", \"itemsName\": ");
+    if(phase->ItemsName)
+    {
+        StringBuilder_AppendChar(outBuilder, '"');
+        StringBuilder_AppendData(outBuilder, phase->ItemsName, strlen(phase->ItemsName));
+        StringBuilder_AppendChar(outBuilder, '"');
+    }
+    else
+        StringBuilder_AppendLiteral(outBuilder, "null");
+    StringBuilder_AppendLiteral(outBuilder, ", \"itemsPerSecond\": ");
+    StringBuilder_AppendDouble( outBuilder,
+                                PhaseStats_InternPerSecond(phase->ItemsCount, phase->WallNs));
+    
+    StringBuilder_AppendLiteral(outBuilder, ", \"allocations\": ");
+    #if ALLOCATOR_PROFILE
+        const AllocatorStats* allocations = &phase->Allocations;
+        StringBuilder_AppendLiteral(outBuilder, "{\"allocCount\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->AllocCount);
+        StringBuilder_AppendLiteral(outBuilder, ", \"allocBytes\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->AllocBytes);
+        StringBuilder_AppendLiteral(outBuilder, ", \"reallocCount\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->ReallocCount);
+        StringBuilder_AppendLiteral(outBuilder, ", \"reallocCopyBytes\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->ReallocCopyBytes);
+        StringBuilder_AppendLiteral(outBuilder, ", \"freeCount\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->FreeCount);
+        StringBuilder_AppendLiteral(outBuilder, ", \"usedBytes\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->UsedBytes);
+        StringBuilder_AppendLiteral(outBuilder, ", \"reservedBytes\": ");
+        StringBuilder_AppendUInt(outBuilder, allocations->ReservedBytes);
+        StringBuilder_AppendChar(outBuilder, '}');
+    #else
+        //Not counted without ALLOCATOR_PROFILE
+        StringBuilder_AppendLiteral(outBuilder, "null");
+    #endif
+    StringBuilder_AppendChar(outBuilder, '}');
+}
+
+static inline void PhaseStats_AppendReport( const PhaseStats* phases,
+                                            uint32_t phasesCount,
+                                            PhaseStatsFormat format,
+                                            StringBuilder* outBuilder)
+{
+    if(!outBuilder || (!phases && phasesCount))
+        return;
+    
+    PhaseStats totalPhase = { .Name = "Total", .Allocations.Name = "Total" };
+    for(uint32_t i = 0; i < phasesCount; ++i)
+    {
+        totalPhase.WallNs += phases[i].WallNs;
+        totalPhase.CpuNs += phases[i].CpuNs;
+        totalPhase.Allocations.AllocCount += phases[i].Allocations.AllocCount;
+        totalPhase.Allocations.AllocBytes += phases[i].Allocations.AllocBytes;
+        totalPhase.Allocations.ReallocCount += phases[i].Allocations.ReallocCount;
+        totalPhase.Allocations.ReallocCopyBytes += phases[i].Allocations.ReallocCopyBytes;
+        totalPhase.Allocations.FreeCount += phases[i].Allocations.FreeCount;
+        totalPhase.Allocations.WastedFreeBytes += phases[i].Allocations.WastedFreeBytes;
+    }
+    if(phasesCount)
+    {
+        totalPhase.Allocations.UsedBytes = phases[phasesCount - 1].Allocations.UsedBytes;
+        totalPhase.Allocations.ReservedBytes = phases[phasesCount - 1].Allocations.ReservedBytes;
+    }
+    
+    const uint64_t peakRssBytes = PhaseStats_PeakRssBytes();
+    if(format == PhaseStatsFormat_Json)
+    {
+        StringBuilder_AppendLiteral(outBuilder, "{\n  \"phases\":\n  [\n");
+        for(uint32_t i = 0; i < phasesCount; ++i)
+        {
+            PhaseStats_InternAppendJson(&phases[i], outBuilder);
+            StringBuilder_AppendLiteral(outBuilder, ",\n");
+        }
+        PhaseStats_InternAppendJson(&totalPhase, outBuilder);
+        StringBuilder_AppendLiteral(outBuilder, "\n  ],\n  \"peakRssBytes\": ");
+        StringBuilder_AppendUInt(outBuilder, peakRssBytes);
+        StringBuilder_AppendLiteral(outBuilder, "\n}\n");
+        return;
+    }
+    
+    StringBuilder_AppendFormat( outBuilder,
+                                "%-12s %12s %12s  Throughput\n",
+                                "Phase",
+                                "Wall ms",
+                                "CPU ms");
+    for(uint32_t i = 0; i < phasesCount; ++i)
+        PhaseStats_InternAppendText(&phases[i], outBuilder);
+    PhaseStats_InternAppendText(&totalPhase, outBuilder);
+    StringBuilder_AppendFormat(outBuilder, "Peak RSS: %.2f MB\n", (double)peakRssBytes / 1000000.0);
+}
+
+#endif
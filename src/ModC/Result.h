@@ -24,6 +24,33 @@ typedef struct ResultName
 Define `DEFAULT_ALLOC()` to use non `_ALLOC` macro variants
 Define `ResultNameState` to use `_S` macro variants
 
+#### Profiles
+
+Define `MODC_RESULT_TRACE_MODE` optionally to choose how traces are captured
+- `MODC_RESULT_TRACE_FULL`: Up to `MAX_TRACES` (64) traces from where the error was created. Default
+- `MODC_RESULT_TRACE_RING`: The last `MAX_TRACES` (8) traces, older ones are overwritten
+- `MODC_RESULT_TRACE_OFF`: No traces
+Define `MODC_RESULT_RELEASE` optionally to default to `MODC_RESULT_TRACE_RING`
+Define `MAX_TRACES` optionally to override the number of traces kept
+
+Creating errors and appending traces are outlined into cold functions in every profile, so the 
+checks only leave a branch and a call in the functions using them.
+
+#### Threads
+
+`LAST_ERROR` and the error being returned are thread local, so functions returning results can run
+on multiple threads at once. Errors still need a thread safe allocator, the heap or the error arena.
+
+Each thread has its own error arena, created on first use. Errors allocated from it are freed all
+at once by resetting it, instead of one by one with `RESULT_FREE_RESOURCE`.
+Define `MODC_ERROR_ARENA_SIZE` optionally to set the size of each arena block (16 KiB)
+
+```c
+static inline Allocator Result_ErrorAllocator(void);    //Shared allocator of the thread's arena
+static inline void Result_ResetErrorArena(void);        //Invalidates all errors from this thread
+static inline void Result_DestroyErrorArena(void);      //Call before a thread exits
+```
+
 
 #### Functions:
 
@@ -32,18 +59,24 @@ Define `ResultNameState` to use `_S` macro variants
 ```c
 typedef struct Trace
 {
-    StringView File;
+    StringView File;        //Full path, use `ModC_GetFileName()` for the name
     StringView Function;
     int32_t Line;
 } Trace;
 static inline void TraceCreate(const char* file, const char* function, int line, Trace* outTrace);
+static inline void TraceCreateLength(   const char* file,
+                                        uint32_t fileLength,
+                                        const char* function,
+                                        uint32_t functionLength,
+                                        int line,
+                                        Trace* outTrace);
 ```
 
 ```c
 typedef struct Error
 {
     Trace Traces[MAX_TRACES];
-    uint8_t TracesSize;
+    uint32_t TracesSize;    //Number of traces appended, can be more than `MAX_TRACES` in ring mode
     String ErrorMsg;
     int32_t ErrorCode;
 } Error;
@@ -158,6 +191,7 @@ CHECK_EC(expr, errorCode, (formatAppend), failedAction);
 #include "ModC/Strings/Strings.h"
 #include "ModC/Allocator.h"
 #include "ModC/ChainUtil.h"
+#include "ModC/ThreadLocal.h"
 
 #include "MacroPowerToys/Miscellaneous.h"
 #include "MacroPowerToys/RemoveParenthesisInList.h"
@@ -167,10 +201,49 @@ CHECK_EC(expr, errorCode, (formatAppend), failedAction);
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <inttypes.h>
+
+#define MODC_RESULT_TRACE_OFF 0
+#define MODC_RESULT_TRACE_RING 1
+#define MODC_RESULT_TRACE_FULL 2
+
+#ifndef MODC_RESULT_TRACE_MODE
+    #if MODC_RESULT_RELEASE
+        #define MODC_RESULT_TRACE_MODE MODC_RESULT_TRACE_RING
+    #else
+        #define MODC_RESULT_TRACE_MODE MODC_RESULT_TRACE_FULL
+    #endif
+#endif
+
+#ifndef MAX_TRACES
+    #if MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_FULL
+        #define MAX_TRACES 64
+    #elif MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_RING
+        #define MAX_TRACES 8
+    #else
+        #define MAX_TRACES 1
+    #endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define MODC_LIKELY(expr) __builtin_expect(!!(expr), 1)
+    #define MODC_UNLIKELY(expr) __builtin_expect(!!(expr), 0)
+    //`unused` since these are static functions in a header
+    #define MODC_COLD __attribute__((cold, noinline, unused))
+#else
+    #define MODC_LIKELY(expr) (expr)
+    #define MODC_UNLIKELY(expr) (expr)
+    #define MODC_COLD
+#endif
+
+#ifndef MODC_ERROR_ARENA_SIZE
+    #define MODC_ERROR_ARENA_SIZE 16384
+#endif
 
 typedef struct Trace
 {
-    StringView File;
+    StringView File;        //Full path, use `ModC_GetFileName()` for the name
     StringView Function;
     int32_t Line;
 } Trace;
@@ -190,36 +263,139 @@ static inline ConstStringView ModC_GetFileName(const ConstStringView path)
     return ConstStringView_Slice(&path, lastSlash, path.Length);
 }
 
-static inline void TraceCreate(const char* file, const char* function, int line, Trace* outTrace)
+static inline void TraceCreateLength(   const char* file,
+                                        uint32_t fileLength,
+                                        const char* function,
+                                        uint32_t functionLength,
+                                        int line,
+                                        Trace* outTrace)
 {
     if(!outTrace)
         return;
     
-    ConstStringView constFileView = CHAIN( ConstStringView_Create, (file, strlen(file)),
-                                                ModC_GetFileName, ());
-    ConstStringView constFuncView = ConstStringView_Create(function, strlen(function));
+    //The file name is only extracted when the trace is printed
     *outTrace = (Trace)
                 {
-                    .File = ConstStringView_Unconst(&constFileView),
-                    .Function = ConstStringView_Unconst(&constFuncView),
+                    .File = StringView_Create((char*)file, fileLength),
+                    .Function = StringView_Create((char*)function, functionLength),
                     .Line = line
                 };
 }
 
+static inline void TraceCreate(const char* file, const char* function, int line, Trace* outTrace)
+{
+    TraceCreateLength(file, strlen(file), function, strlen(function), line, outTrace);
+}
 
-#define MAX_TRACES 64
+//Location arguments with the lengths known at compile time, `__func__` is an array as well
+#define INTERN_MODC_TRACE_ARGS \
+    __FILE__, sizeof(__FILE__) - 1, __func__, sizeof(__func__) - 1, __LINE__
 
 typedef struct Error
 {
     Trace Traces[MAX_TRACES];
     Allocator Allocator;
     String ErrorMsg;
-    uint8_t TracesSize;
+    uint32_t TracesSize;
     int32_t ErrorCode;
 } Error;
 
-static Error* GlobalError = NULL;
-static Error* GlobalRetError = NULL;
+static MODC_THREAD_LOCAL Error* GlobalError = NULL;
+static MODC_THREAD_LOCAL Error* GlobalRetError = NULL;
+static MODC_THREAD_LOCAL Allocator ModC_ThreadErrorArena = {0};
+
+static inline Allocator Result_ErrorAllocator(void)
+{
+    if(!ModC_ThreadErrorArena.Allocator)
+    {
+        ModC_ThreadErrorArena = CreateArenaAllocator(MODC_ERROR_ARENA_SIZE);
+        
+        //Still able to report errors without the arena
+        if(!ModC_ThreadErrorArena.Allocator)
+            return CreateHeapAllocator();
+        Allocator_SetProfileName(&ModC_ThreadErrorArena, "Errors");
+    }
+    
+    return Allocator_Share(&ModC_ThreadErrorArena);
+}
+
+static inline void Result_ResetErrorArena(void)
+{
+    GlobalError = NULL;
+    GlobalRetError = NULL;
+    Allocator_Reset(&ModC_ThreadErrorArena);
+}
+
+static inline void Result_DestroyErrorArena(void)
+{
+    GlobalError = NULL;
+    GlobalRetError = NULL;
+    if(ModC_ThreadErrorArena.Allocator)
+        Allocator_Destroy(&ModC_ThreadErrorArena);
+    ModC_ThreadErrorArena = (Allocator){0};
+}
+
+//Appends the traces of `errorPtr` from the innermost, each on a new line
+static inline void ModC_Error_InternAppendTracesString(const Error* errorPtr, String* outString)
+{
+    uint32_t traceCount = errorPtr->TracesSize;
+    uint32_t firstTrace = 0;
+    if(traceCount > MAX_TRACES)
+    {
+        //Only in ring mode, the oldest traces were overwritten
+        String_AppendFormat(outString, "\n  (%"PRIu32" traces dropped)", traceCount - MAX_TRACES);
+        firstTrace = traceCount % MAX_TRACES;
+        traceCount = MAX_TRACES;
+    }
+    
+    for(uint32_t i = 0; i < traceCount; ++i)
+    {
+        const Trace* trace = &errorPtr->Traces[(firstTrace + i) % MAX_TRACES];
+        ConstStringView fileView = ConstStringView_Create(trace->File.Data, trace->File.Length);
+        fileView = ModC_GetFileName(fileView);
+        String_AppendFormat(outString,
+                            "\n  at %.*s:%d in %.*s()",
+                            MODC_LENGTH_DATA(fileView),
+                            trace->Line,
+                            MODC_LENGTH_DATA(trace->Function));
+    }
+}
+
+static inline void ModC_Error_InternAddTrace(  Error* errorPtr,
+                                                const char* file,
+                                                uint32_t fileLength,
+                                                const char* func,
+                                                uint32_t funcLength,
+                                                int32_t line)
+{
+    #if MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_OFF
+        (void)errorPtr;
+        (void)file;
+        (void)fileLength;
+        (void)func;
+        (void)funcLength;
+        (void)line;
+    #elif MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_RING
+        Trace* trace = &errorPtr->Traces[errorPtr->TracesSize++ % MAX_TRACES];
+        TraceCreateLength(file, fileLength, func, funcLength, line, trace);
+    #else
+        if(errorPtr->TracesSize >= MAX_TRACES)
+            return;
+        Trace* trace = &errorPtr->Traces[errorPtr->TracesSize++];
+        TraceCreateLength(file, fileLength, func, funcLength, line, trace);
+    #endif
+}
+
+MODC_COLD static void ModC_Error_InternAppendTrace(Error* errorPtr,
+                                                    const char* file,
+                                                    uint32_t fileLength,
+                                                    const char* func,
+                                                    uint32_t funcLength,
+                                                    int32_t line)
+{
+    if(errorPtr)
+        ModC_Error_InternAddTrace(errorPtr, file, fileLength, func, funcLength, line);
+}
 
 #define DEFINE_RESULT_STRUCT(ModC_DefResultName, valueType) \
     typedef struct ModC_DefResultName \
@@ -268,22 +444,16 @@ static Error* GlobalRetError = NULL;
             String_AppendFormat(&outputString, "\nError Code: %d", errorPtr->ErrorCode); \
         \
         String_AppendLiteral(&outputString, "\n\nStack trace:"); \
-        for(int i = 0; i < errorPtr->TracesSize; ++i) \
-        { \
-            /* Trace */ \
-            String_AppendFormat(&outputString, \
-                                "\n  at %.*s:%d in %.*s()", \
-                                MODC_LENGTH_DATA(errorPtr->Traces[i].File), \
-                                errorPtr->Traces[i].Line, \
-                                MODC_LENGTH_DATA(errorPtr->Traces[i].Function)); \
-        } \
+        ModC_Error_InternAppendTracesString(errorPtr, &outputString); \
         return outputString; \
     }
-    
-static inline Error* 
+
+MODC_COLD static Error* 
 ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
                                     const char* file,
+                                    uint32_t fileLength,
                                     const char* func,
+                                    uint32_t funcLength,
                                     int32_t line,
                                     int32_t errorCode,
                                     Allocator allocator)
@@ -293,7 +463,7 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
     {
         *modcErrorPtr = (Error){0};
         modcErrorPtr->Allocator = allocator;
-        TraceCreate(file, func, line, &modcErrorPtr->Traces[modcErrorPtr->TracesSize++]);
+        ModC_Error_InternAddTrace(modcErrorPtr, file, fileLength, func, funcLength, line);
         
         //Error.ErrorMsg
         {
@@ -301,9 +471,13 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
                 modcErrorPtr->ErrorMsg = msg.TU_DATA(StringUnion, String);
             else
             {
-                modcErrorPtr->ErrorMsg = String_Create(allocator, 256);
-                ConstStringView* msgView = &msg.TU_DATA(StringUnion, ConstStringView);
-                String_AddRange(&modcErrorPtr->ErrorMsg, msgView->Data, msgView->Length);
+                //Room for what `CHECK()` appends after the expression
+                modcErrorPtr->ErrorMsg = 
+                    String_Create(allocator, StringUnion_GetConstView(&msg).Length + 64);
+                ConstStringView msgView = StringUnion_GetConstView(&msg);
+                String_AddRange(&modcErrorPtr->ErrorMsg, msgView.Data, msgView.Length);
+                if(msg.Type == TU_TYPE(StringUnion, SmallString))
+                    SmallString_Free(&msg.TU_DATA(StringUnion, SmallString));
             }
         }
         modcErrorPtr->ErrorCode = errorCode;
@@ -312,12 +486,44 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
     return modcErrorPtr;
 }
 
-#define ERROR_APPEND_TRACE(ErrorPtr) \
-    do \
-    { \
-        if((ErrorPtr) && ErrorPtr->TracesSize < MAX_TRACES) \
-            TraceCreate(__FILE__, __func__, __LINE__, &ErrorPtr->Traces[ErrorPtr->TracesSize++]); \
-    } while(false)
+//Creates the error for a failed `CHECK()`, `format` and the arguments after it are appended
+MODC_COLD static Error* 
+ModC_Error_InternCreateCheckError(  ConstStringView exprMsg,
+                                    const char* file,
+                                    uint32_t fileLength,
+                                    const char* func,
+                                    uint32_t funcLength,
+                                    int32_t line,
+                                    int32_t errorCode,
+                                    Allocator allocator,
+                                    const char* format,
+                                    ...)
+{
+    Error* modcErrorPtr = 
+        ModC_Error_InternCreateErrorMsgEc(  TU_INIT(StringUnion, ConstStringView, exprMsg),
+                                            file,
+                                            fileLength,
+                                            func,
+                                            funcLength,
+                                            line,
+                                            errorCode,
+                                            allocator);
+    if(!modcErrorPtr)
+        return modcErrorPtr;
+    
+    va_list args;
+    va_start(args, format);
+    String_AppendVFormat(&modcErrorPtr->ErrorMsg, format, args);
+    va_end(args);
+    return modcErrorPtr;
+}
+
+#if MODC_RESULT_TRACE_MODE == MODC_RESULT_TRACE_OFF
+    #define ERROR_APPEND_TRACE(ErrorPtr) do { (void)(ErrorPtr); } while(false)
+#else
+    #define ERROR_APPEND_TRACE(ErrorPtr) \
+        ModC_Error_InternAppendTrace((ErrorPtr), INTERN_MODC_TRACE_ARGS)
+#endif
 
 //Failed reuslt name
 #define LAST_ERROR GlobalError
@@ -343,8 +549,8 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
                 MPT_REMOVE_PARENTHESIS(failedAction); \
             } \
         } while(0)
-
-
+    
+    
     #define RESULT_TRY(ModC_ExprResultName, expr, failedAction) \
         INTERN_RESULT_TRY(ModC_ExprResultName, expr, failedAction, __COUNTER__)
 #else
@@ -352,7 +558,7 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
         &result.ValueOrError.Value; \
         do \
         { \
-            if(result.HasError) \
+            if(MODC_UNLIKELY(result.HasError)) \
             { \
                 GlobalError = result.ValueOrError.Error; \
                 ERROR_APPEND_TRACE(result.ValueOrError.Error); \
@@ -366,9 +572,7 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
     MPT_DELAYED_CONCAT2(ResultName, _CreateError) \
     ( \
         ModC_Error_InternCreateErrorMsgEc(  (msg), \
-                                            __FILE__, \
-                                            __func__, \
-                                            __LINE__, \
+                                            INTERN_MODC_TRACE_ARGS, \
                                             (errorCode), \
                                             (allocator)) \
     )
@@ -403,9 +607,7 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
     MPT_DELAYED_CONCAT2(ResultName, _CreateError) \
     ( \
         ModC_Error_InternCreateErrorMsgEc(  INTERN_MODC_STR_VIEW_FROM_STR_FMT(allocator, strfmts), \
-                                            __FILE__, \
-                                            __func__, \
-                                            __LINE__, \
+                                            INTERN_MODC_TRACE_ARGS, \
                                             (errorCode), \
                                             (allocator)) \
     )
@@ -431,9 +633,7 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
     MPT_DELAYED_CONCAT2(ResultName, _CreateError) \
     ( \
         ModC_Error_InternCreateErrorMsgEc(  StringUnion_ViewFromLiteral(cstr), \
-                                            __FILE__, \
-                                            __func__, \
-                                            __LINE__, \
+                                            INTERN_MODC_TRACE_ARGS, \
                                             (errorCode), \
                                             (allocator)) \
     )
@@ -496,19 +696,14 @@ ModC_Error_InternCreateErrorMsgEc(  StringUnion msg,
 #define INTERNAL_CHECK_EC_ALLOC(expr, errorCode, formatAppend, allocator, ... /* failedAction */) \
     do \
     { \
-        if(!(expr)) \
+        if(MODC_UNLIKELY(!(expr))) \
         { \
-            ConstStringView exprView = \
-                ConstStringView_FromLiteral("Expression \"" #expr "\" has failed. "); \
-            StringUnion assertView = TU_INIT(StringUnion, ConstStringView, exprView); \
-            GlobalError = ModC_Error_InternCreateErrorMsgEc(assertView, \
-                                                            __FILE__, \
-                                                            __func__, \
-                                                            __LINE__, \
-                                                            (errorCode), \
-                                                            (allocator)); \
-            String_AppendFormat(   &GlobalError->ErrorMsg, \
-                                        MPT_REMOVE_PARENTHESIS(formatAppend)); \
+            GlobalError = ModC_Error_InternCreateCheckError( \
+                ConstStringView_FromLiteral("Expression \"" #expr "\" has failed. "), \
+                INTERN_MODC_TRACE_ARGS, \
+                (errorCode), \
+                (allocator), \
+                MPT_REMOVE_PARENTHESIS(formatAppend)); \
             __VA_ARGS__; \
         } \
     } \
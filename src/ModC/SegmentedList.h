@@ -0,0 +1,261 @@
+#include "ModC/Allocator.h"
+#include "MacroPowerToys/Miscellaneous.h"
+
+/* Docs
+List that grows by adding fixed size segments instead of reallocating, so elements are never copied
+and pointers to them stay valid until they are removed or the list is freed.
+
+Define `LIST_NAME` for the name of the list.
+Define `VALUE_TYPE` for the element type stored in the list
+Define `SEGMENT_SHIFT` optionally for the log2 of the number of elements per segment. Default is 8
+Define `VALUE_FREE` optionally which will be called as `VALUE_FREE(VALUE_TYPE* val)`
+Define `NO_TYPEDEF` optionally to not use typedef struct
+
+Then include this file
+
+Elements are not contiguous, use `_At()` instead of indexing the data directly.
+
+Just read the code for the functions
+*/
+
+#ifndef LIST_NAME
+    #error "LIST_NAME is not defined"
+#endif
+
+#ifndef VALUE_TYPE
+    #error "VALUE_TYPE is not defined"
+#endif
+
+#ifndef SEGMENT_SHIFT
+    #define SEGMENT_SHIFT 8
+#endif
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if NO_TYPEDEF
+    struct LIST_NAME
+    {
+        Allocator Allocator;
+        VALUE_TYPE** Segments;
+        uint64_t SegmentCount;
+        uint64_t SegmentCap;        //Capacity of `Segments`, not the number of elements
+        uint64_t Length;
+    };
+#else
+    typedef struct LIST_NAME
+    {
+        Allocator Allocator;
+        VALUE_TYPE** Segments;
+        uint64_t SegmentCount;
+        uint64_t SegmentCap;        //Capacity of `Segments`, not the number of elements
+        uint64_t Length;
+    } LIST_NAME;
+#endif
+
+enum
+{
+    MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_SHIFT) = SEGMENT_SHIFT,
+    MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH) = 1 << SEGMENT_SHIFT
+};
+
+static inline uint64_t MPT_DELAYED_CONCAT(LIST_NAME, _Cap)(const LIST_NAME* this)
+{
+    return this ? this->SegmentCount << MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_SHIFT) : 0;
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(LIST_NAME* this, uint64_t reserveSize)
+{
+    if(!this)
+        return this;
+    
+    const uint64_t segmentLength = MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH);
+    const uint64_t segmentsNeeded = reserveSize / segmentLength + 
+                                    (reserveSize % segmentLength != 0);
+    if(this->SegmentCount >= segmentsNeeded)
+        return this;
+    
+    //Only the segment table is reallocated, the segments themselves never move
+    if(this->SegmentCap < segmentsNeeded)
+    {
+        uint64_t newSegmentCap = this->SegmentCap == 0 ? 4 : this->SegmentCap * 2;
+        if(newSegmentCap < segmentsNeeded)
+            newSegmentCap = segmentsNeeded;
+        
+        void* segmentsPtr = this->SegmentCap == 0 ?
+                            Allocator_Malloc(&this->Allocator, sizeof(VALUE_TYPE*) * newSegmentCap) :
+                            Allocator_Realloc(  &this->Allocator,
+                                                this->Segments,
+                                                sizeof(VALUE_TYPE*) * newSegmentCap);
+        if(!segmentsPtr)
+            return this;
+        this->Segments = segmentsPtr;
+        this->SegmentCap = newSegmentCap;
+    }
+    
+    while(this->SegmentCount < segmentsNeeded)
+    {
+        VALUE_TYPE* segment = Allocator_Malloc(&this->Allocator, sizeof(VALUE_TYPE) * segmentLength);
+        if(!segment)
+            return this;
+        this->Segments[this->SegmentCount++] = segment;
+    }
+    return this;
+}
+
+static inline LIST_NAME
+MPT_DELAYED_CONCAT(LIST_NAME, _Create)(Allocator allocator, uint64_t cap)
+{
+    LIST_NAME retList = { .Allocator = allocator };
+    MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(&retList, cap);
+    return retList;
+}
+
+static inline VALUE_TYPE* MPT_DELAYED_CONCAT(LIST_NAME, _At)(LIST_NAME* this, uint64_t index)
+{
+    if(!this || index >= this->Length)
+        return NULL;
+    return  this->Segments[index >> MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_SHIFT)] +
+            (index & (MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH) - 1));
+}
+
+static inline const VALUE_TYPE*
+MPT_DELAYED_CONCAT(LIST_NAME, _ConstAt)(const LIST_NAME* this, uint64_t index)
+{
+    if(!this || index >= this->Length)
+        return NULL;
+    return  this->Segments[index >> MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_SHIFT)] +
+            (index & (MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH) - 1));
+}
+
+static inline void MPT_DELAYED_CONCAT(LIST_NAME, _Free)(LIST_NAME* this)
+{
+    if(!this)
+        return;
+    
+    #ifdef VALUE_FREE
+        for(uint64_t i = 0; i < this->Length; ++i)
+        {
+            VALUE_FREE(MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, i));
+        }
+    #endif
+    
+    for(uint64_t i = 0; i < this->SegmentCount; ++i)
+        Allocator_Free(&this->Allocator, this->Segments[i]);
+    if(this->Segments)
+        Allocator_Free(&this->Allocator, this->Segments);
+    Allocator_Destroy(&this->Allocator);
+    *this = (LIST_NAME){0};
+}
+
+//Segments are kept when shrinking
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(LIST_NAME* this, uint64_t resizeLength)
+{
+    if(!this)
+        return this;
+    
+    //Shrinking
+    if(this->Length >= resizeLength)
+    {
+        #ifdef VALUE_FREE
+            for(uint64_t i = resizeLength; i < this->Length; ++i)
+            {
+                VALUE_FREE(MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, i));
+            }
+        #endif
+        
+        this->Length = resizeLength;
+        return this;
+    }
+    
+    MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(this, resizeLength);
+    if(MPT_DELAYED_CONCAT(LIST_NAME, _Cap)(this) < resizeLength)
+        return this;
+    this->Length = resizeLength;
+    return this;
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _AddValue)(LIST_NAME* this, const VALUE_TYPE val)
+{
+    if(!this)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    *MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, oldLength) = val;
+    return this;
+}
+
+static inline LIST_NAME*
+MPT_DELAYED_CONCAT(LIST_NAME, _AddRange)(LIST_NAME* this, const VALUE_TYPE* data, uint64_t dataLength)
+{
+    if(!this || !dataLength || !data)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + dataLength);
+    if(this->Length != oldLength + dataLength)
+        return this;
+    
+    //Copy one segment at a time
+    for(uint64_t copied = 0; copied < dataLength;)
+    {
+        uint64_t index = oldLength + copied;
+        uint64_t segmentLeft =  MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH) -
+                                (index & (MPT_DELAYED_CONCAT(LIST_NAME, _SEGMENT_LENGTH) - 1));
+        uint64_t copyLength = dataLength - copied < segmentLeft ? dataLength - copied : segmentLeft;
+        memcpy( MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, index),
+                data + copied,
+                sizeof(VALUE_TYPE) * copyLength);
+        copied += copyLength;
+    }
+    return this;
+}
+
+static inline LIST_NAME* MPT_DELAYED_CONCAT(LIST_NAME, _AddEmpty)(LIST_NAME* this, bool zeroInit)
+{
+    if(!this)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    if(zeroInit)
+        memset(MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, oldLength), 0, sizeof(VALUE_TYPE));
+    return this;
+}
+
+//Returns the last element, NULL if empty
+static inline VALUE_TYPE* MPT_DELAYED_CONCAT(LIST_NAME, _Last)(LIST_NAME* this)
+{
+    if(!this || this->Length == 0)
+        return NULL;
+    return MPT_DELAYED_CONCAT(LIST_NAME, _At)(this, this->Length - 1);
+}
+
+//Returns the index of the found element. Otherwise return `this->Length`
+static inline uint64_t
+MPT_DELAYED_CONCAT(LIST_NAME, _Find)(const LIST_NAME* this, const VALUE_TYPE* data)
+{
+    if(!this || !data)
+        return this ? this->Length : 0;
+    
+    uint64_t i;
+    for(i = 0; i < this->Length; ++i)
+    {
+        if(memcmp(MPT_DELAYED_CONCAT(LIST_NAME, _ConstAt)(this, i), data, sizeof(VALUE_TYPE)) == 0)
+            return i;
+    }
+    return i;
+}
+
+#undef LIST_NAME
+#undef VALUE_TYPE
+#undef SEGMENT_SHIFT
+#undef VALUE_FREE
+#undef NO_TYPEDEF
@@ -0,0 +1,366 @@
+#include "ModC/Allocator.h"
+#include "MacroPowerToys/Miscellaneous.h"
+
+/* Docs
+Same as List.h but the first `INLINE_CAP` elements are stored inside the list itself. The allocator
+is only used once the list grows past it.
+
+Define `LIST_NAME` for the name of the list.
+Define `VALUE_TYPE` for the element type stored in the list
+Define `INLINE_CAP` for the number of elements stored inline
+Define `VALUE_FREE` optionally which will be called as `VALUE_FREE(VALUE_TYPE* val)`
+Define `NO_TYPEDEF` optionally to not use typedef struct
+
+Then include this file
+
+Length and Cap are 32 bits so the inline data takes the space List.h uses for its data pointer and
+capacity. `INLINE_CAP` elements of 16 bytes or less keep the list the same size as a List.h list.
+
+The list doesn't point to itself, so it can be copied or moved with memcpy like List.h.
+Since the data can be inline, use `_Data()` instead of `.Data`. A zero initialized list is empty
+and valid.
+
+Just read the code for the functions
+*/
+
+#ifndef LIST_NAME
+    #error "LIST_NAME is not defined"
+#endif
+
+#ifndef VALUE_TYPE
+    #error "VALUE_TYPE is not defined"
+#endif
+
+#ifndef INLINE_CAP
+    #error "INLINE_CAP is not defined"
+#endif
+
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#if NO_TYPEDEF
+    struct LIST_NAME
+    {
+        Allocator Allocator;
+        uint32_t Length;
+        uint32_t Cap;           //Data is inline if `INLINE_CAP` or less
+        union
+        {
+            VALUE_TYPE* HeapData;
+            VALUE_TYPE InlineData[INLINE_CAP];
+        } Storage;
+    };
+#else
+    typedef struct LIST_NAME
+    {
+        Allocator Allocator;
+        uint32_t Length;
+        uint32_t Cap;           //Data is inline if `INLINE_CAP` or less
+        union
+        {
+            VALUE_TYPE* HeapData;
+            VALUE_TYPE InlineData[INLINE_CAP];
+        } Storage;
+    } LIST_NAME;
+#endif
+
+static inline bool MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(const LIST_NAME* this)
+{
+    return this->Cap <= INLINE_CAP;
+}
+
+static inline VALUE_TYPE* MPT_DELAYED_CONCAT(LIST_NAME, _Data)(LIST_NAME* this)
+{
+    if(!this)
+        return NULL;
+    return  MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(this) ? 
+            this->Storage.InlineData : 
+            this->Storage.HeapData;
+}
+
+static inline const VALUE_TYPE* MPT_DELAYED_CONCAT(LIST_NAME, _ConstData)(const LIST_NAME* this)
+{
+    if(!this)
+        return NULL;
+    return  MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(this) ? 
+            this->Storage.InlineData : 
+            this->Storage.HeapData;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(LIST_NAME* this, uint64_t reserveSize)
+{
+    if(!this || reserveSize <= INLINE_CAP || this->Cap >= reserveSize)
+        return this;
+    
+    if(reserveSize > UINT32_MAX)
+        return this;
+    
+    //Spill the inline data to the allocator
+    if(MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(this))
+    {
+        VALUE_TYPE* dataPtr = Allocator_Malloc(&this->Allocator, sizeof(VALUE_TYPE) * reserveSize);
+        if(!dataPtr)
+            return this;
+        
+        memcpy(dataPtr, this->Storage.InlineData, sizeof(VALUE_TYPE) * this->Length);
+        this->Storage.HeapData = dataPtr;
+        this->Cap = reserveSize;
+        return this;
+    }
+    
+    void* dataPtr = Allocator_Realloc(  &this->Allocator, 
+                                        this->Storage.HeapData, 
+                                        sizeof(VALUE_TYPE) * reserveSize);
+    if(!dataPtr)
+        return this;
+    this->Storage.HeapData = dataPtr;
+    this->Cap = reserveSize;
+    return this;
+}
+
+static inline LIST_NAME 
+MPT_DELAYED_CONCAT(LIST_NAME, _Create)(Allocator allocator, uint64_t cap)
+{
+    LIST_NAME retList = { .Allocator = allocator, .Cap = INLINE_CAP };
+    MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(&retList, cap);
+    return retList;
+}
+
+static inline void MPT_DELAYED_CONCAT(LIST_NAME, _Free)(LIST_NAME* this)
+{
+    if(!this)
+        return;
+    
+    #ifdef VALUE_FREE
+        VALUE_TYPE* data = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+        for(uint64_t i = 0; i < this->Length; ++i)
+        {
+            VALUE_FREE(&data[i]);
+        }
+    #endif
+    
+    if(!MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(this))
+        Allocator_Free(&this->Allocator, this->Storage.HeapData);
+    Allocator_Destroy(&this->Allocator);
+    *this = (LIST_NAME){0};
+    return;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(LIST_NAME* this, uint64_t resizeLength)
+{
+    if(!this)
+        return this;
+    
+    //Shrinking
+    if(this->Length >= resizeLength)
+    {
+        #ifdef VALUE_FREE
+            VALUE_TYPE* data = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+            for(uint64_t i = resizeLength; i < this->Length; ++i)
+            {
+                VALUE_FREE(&data[i]);
+            }
+        #endif
+        
+        this->Length = resizeLength;
+        return this;
+    }
+    
+    if(resizeLength <= INLINE_CAP || this->Cap >= resizeLength)
+    {
+        this->Length = resizeLength;
+        return this;
+    }
+    
+    if(resizeLength > UINT32_MAX)
+        return this;
+    
+    uint64_t currentCap = MPT_DELAYED_CONCAT(LIST_NAME, _IsInline)(this) ? INLINE_CAP : this->Cap;
+    const uint64_t newCap = UINT32_MAX / 2 < currentCap ? 
+                            //If doubling our cap reaches max, use max
+                            UINT32_MAX : 
+                            (
+                                //Does doubling the cap sufficient? 
+                                currentCap * 2 < resizeLength ? 
+                                resizeLength :      //No? Use request count
+                                currentCap * 2      //Yes? Just double the cap
+                            );
+    MPT_DELAYED_CONCAT(LIST_NAME, _Reserve)(this, newCap);
+    if(this->Cap != newCap)
+        return this;
+    this->Length = resizeLength;
+    assert(newCap >= resizeLength);
+    return this;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _AddValue)(LIST_NAME* this, const VALUE_TYPE val)
+{
+    if(!this)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this)[oldLength] = val;
+    return this;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _AddRange)(LIST_NAME* this, const VALUE_TYPE* data, uint64_t dataLength)
+{
+    if(!this || !dataLength || !data)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + dataLength);
+    if(this->Length != oldLength + dataLength)
+        return this;
+    memcpy( MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this) + oldLength, 
+            data, 
+            sizeof(VALUE_TYPE) * dataLength);
+    return this;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _InsertValue)(LIST_NAME* this, uint64_t index, const VALUE_TYPE val)
+{
+    if(!this || index > this->Length)
+        return NULL;
+    
+    if(index == this->Length)
+        return MPT_DELAYED_CONCAT(LIST_NAME, _AddValue)(this, val);
+    
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    
+    VALUE_TYPE* data = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+    memmove(data + index + 1, data + index, (oldLength - index) * sizeof(VALUE_TYPE));
+    data[index] = val;
+    return this;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _InsertRange)(LIST_NAME* this, 
+                                            uint64_t index, 
+                                            const VALUE_TYPE* data, 
+                                            uint64_t dataLength)
+{
+    if(!this || !dataLength || !data || index > this->Length)
+        return this;
+    
+    if(index == this->Length)
+        return MPT_DELAYED_CONCAT(LIST_NAME, _AddRange)(this, data, dataLength);
+    
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + dataLength);
+    if(this->Length != oldLength + dataLength)
+        return this;
+    
+    VALUE_TYPE* listData = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+    memmove(listData + index + dataLength, 
+            listData + index, 
+            (oldLength - index) * sizeof(VALUE_TYPE));
+    memcpy(listData + index, data, sizeof(VALUE_TYPE) * dataLength);
+    return this;
+}
+
+static inline LIST_NAME* MPT_DELAYED_CONCAT(LIST_NAME, _AddEmpty)(LIST_NAME* this, bool zeroInit)
+{
+    if(!this)
+        return this;
+    uint64_t oldLength = this->Length;
+    MPT_DELAYED_CONCAT(LIST_NAME, _Resize)(this, oldLength + 1);
+    if(this->Length != oldLength + 1)
+        return this;
+    if(zeroInit)
+        memset(MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this) + oldLength, 0, sizeof(VALUE_TYPE));
+    return this;
+}
+
+static inline LIST_NAME* MPT_DELAYED_CONCAT(LIST_NAME, _Remove)(LIST_NAME* this, uint64_t index)
+{
+    if(!this || index >= this->Length)
+        return this;
+    
+    VALUE_TYPE* data = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+    #ifdef VALUE_FREE
+        VALUE_FREE(&data[index]);
+    #endif
+    
+    if(index == this->Length - 1)
+    {
+        --(this->Length);
+        return this;
+    }
+    memmove(data + index, data + index + 1, (this->Length - index - 1) * sizeof(VALUE_TYPE));
+    --(this->Length);
+    return this;
+}
+
+static inline LIST_NAME* 
+MPT_DELAYED_CONCAT(LIST_NAME, _RemoveRange)(LIST_NAME* this, 
+                                            uint64_t startIndex, 
+                                            uint64_t endExclusiveIndex)
+{
+    if(!this || startIndex >= this->Length || startIndex >= endExclusiveIndex)
+        return this;
+    
+    endExclusiveIndex = endExclusiveIndex > this->Length ? this->Length : endExclusiveIndex;
+    VALUE_TYPE* data = MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this);
+    
+    #ifdef VALUE_FREE
+        for(uint64_t i = startIndex; i < endExclusiveIndex; ++i)
+        {
+            VALUE_FREE(&data[i]);
+        }
+    #endif
+    
+    if(endExclusiveIndex == this->Length)
+    {
+        this->Length -= endExclusiveIndex - startIndex;
+        return this;
+    }
+    memmove(data + startIndex, 
+            data + endExclusiveIndex, 
+            (this->Length - endExclusiveIndex) * sizeof(VALUE_TYPE));
+    this->Length -= endExclusiveIndex - startIndex;
+    return this;
+}
+
+static inline VALUE_TYPE* MPT_DELAYED_CONCAT(LIST_NAME, _At)(LIST_NAME* this, uint64_t index)
+{
+    if(!this || index >= this->Length)
+        return NULL;
+    return MPT_DELAYED_CONCAT(LIST_NAME, _Data)(this) + index;
+}
+
+//Returns the index of the found element. Otherwise return `this->Length`
+static inline uint64_t
+MPT_DELAYED_CONCAT(LIST_NAME, _Find)(const LIST_NAME* this, const VALUE_TYPE* data)
+{
+    if(!this || !data)
+        return this->Length;
+    
+    const VALUE_TYPE* listData = MPT_DELAYED_CONCAT(LIST_NAME, _ConstData)(this);
+    uint64_t i;
+    for(i = 0; i < this->Length; ++i)
+    {
+        if(memcmp(&listData[i], data, sizeof(VALUE_TYPE)) == 0)
+            return i;
+    }
+    return i;
+}
+
+#undef LIST_NAME
+#undef VALUE_TYPE
+#undef INLINE_CAP
+#undef VALUE_FREE
+#undef NO_TYPEDEF
@@ -8,6 +8,7 @@
 #include "ModC/Tokenization.h"
 #include "ModC/GenericContainers.h"
 #include "ModC/Result.h"
+#include "ModC/Strings/StringBuilder.h"
 #include "ModC/Operators.h"
 #include "ModC/Keyword.h"
 
@@ -43,7 +44,7 @@ typedef struct TokenIndexRange
     uint32_t EndIndex;      //Exclusive
 } TokenIndexRange;
 
-typedef Uint32List StatementIndexList;
+typedef SmallUint32List StatementIndexList;
 
 //TODO: Add function for checking start and end token alignment
 typedef struct CompoundStatement
@@ -54,7 +55,7 @@ typedef struct CompoundStatement
     bool Implicit;      //No start and end token index if true
 } CompoundStatement;
 
-typedef Uint32List TokenIndexList;
+typedef SmallUint32List TokenIndexList;
 
 #define TU_NAME StatementTokensUnion
 #define VALUE_TYPES CompoundStatement,TokenIndexList,TokenIndexRange
@@ -68,7 +69,7 @@ typedef struct TypeDeclarationInfo
         Type_Enum
     } Type;
     
-    String TypeName;   //TODO: Use token index instead
+    SmallString TypeName;   //TODO: Use token index instead
 } TypeDeclarationInfo;
 
 typedef struct VariableDeclareAssignInfo
@@ -111,11 +112,13 @@ struct Statement
     uint32_t ParentIndex;
 };
 
+//Segmented so `Statement*` stay valid while more statements are added
 #define LIST_NAME StatementList
 #define VALUE_TYPE Statement
+#define SEGMENT_SHIFT 7
 #define NO_TYPEDEF 1
 //TODO: Value item free
-#include "ModC/List.h"
+#include "ModC/SegmentedList.h"
 
 DEFINE_RESULT_STRUCT(ResultStatementPtr, Statement*)
 DEFINE_RESULT_STRUCT(Result_ConstStringView, ConstStringView)
@@ -176,7 +179,7 @@ static inline ResultStatementPtr Statement_CreateCompound(  Allocator allocator,
     CHECK(allocator.Type == AllocatorType_SharedArena, (""), RET_ERROR_S());
     
     uint64_t oldLength = statementList->Length;
-    StatementIndexList childStatements = Uint32List_Create(allocator, reserveStatementsCount);
+    StatementIndexList childStatements = SmallUint32List_Create(allocator, reserveStatementsCount);
     CHECK(childStatements.Cap > 0, ("Failed to allocate"), RET_ERROR_S());
     StatementList_AddValue( statementList, 
                             (Statement)
@@ -196,7 +199,7 @@ static inline ResultStatementPtr Statement_CreateCompound(  Allocator allocator,
     childStatements = (StatementIndexList){0};
     CHECK(statementList->Length != oldLength, ("Failed to allocate"), RET_ERROR_S());
     
-    Statement* retStatementPtr = &statementList->Data[statementList->Length - 1];
+    Statement* retStatementPtr = StatementList_Last(statementList);
     return RESULT_VALUE_S(retStatementPtr);
 }
 
@@ -224,7 +227,7 @@ static inline ResultStatementPtr Statement_CreatePlain( Allocator allocator,
                             });
     CHECK(statementList->Length != oldLength, ("Failed to allocate"), RET_ERROR_S());
     
-    Statement* retStatementPtr = &statementList->Data[statementList->Length - 1];
+    Statement* retStatementPtr = StatementList_Last(statementList);
     //CHECK(  retStatementPtr->Tokens.TU_DATA(StatementTokensUnion, TokenIndexList).Cap > 0,
     //        ("Failed to allocate"), 
     //        RET_ERROR_S());
@@ -232,25 +235,22 @@ static inline ResultStatementPtr Statement_CreatePlain( Allocator allocator,
     return RESULT_VALUE_S(retStatementPtr);
 }
 
+//Appends the description of the statement to `outBuilder`
 static inline Result_Void Statement_ToString(   Statement* this, 
                                                 TokenList* tokenList,
-                                                String* inOutString, 
-                                                bool append)
+                                                StringBuilder* outBuilder)
 {
     #undef ResultNameState
     #define ResultNameState Result_Void
     #undef TaggedUnionNameState
     #define TaggedUnionNameState StatementTokensUnion
     
-    if(!inOutString || !tokenList)
+    if(!outBuilder || !tokenList)
         return RESULT_VALUE_S(0);
     
-    if(!append)
-        String_Resize(inOutString, 0);
-    
     ConstStringView statementTypeStr = StatementType_ToConstStringView(this->StatementType);
-    String_AddRange(inOutString, statementTypeStr.Data, statementTypeStr.Length);
-    String_AppendLiteral(inOutString, " - ");
+    StringBuilder_AppendView(outBuilder, statementTypeStr);
+    StringBuilder_AppendLiteral(outBuilder, " - ");
     
     static_assert((int)TU_TYPE_S(Count) == 3, "");
     switch(this->Tokens.Type)
@@ -258,76 +258,80 @@ static inline Result_Void Statement_ToString(   Statement* this,
         case TU_TYPE_S(CompoundStatement):
         {
             CompoundStatement* compoundStatement = &this->Tokens.TU_DATA_S(CompoundStatement);
-            String_AppendFormat(inOutString, 
-                                "CompoundStatement: %" PRIu32 " - %" PRIu32 " "
-                                "(Implicit: %s), (Children: ", 
-                                compoundStatement->StartTokenIndex,
-                                compoundStatement->EndTokenIndex,
-                                (compoundStatement->Implicit ? "true" : "false"));
+            StringBuilder_AppendLiteral(outBuilder, "CompoundStatement: ");
+            StringBuilder_AppendUInt(outBuilder, compoundStatement->StartTokenIndex);
+            StringBuilder_AppendLiteral(outBuilder, " - ");
+            StringBuilder_AppendUInt(outBuilder, compoundStatement->EndTokenIndex);
+            if(compoundStatement->Implicit)
+                StringBuilder_AppendLiteral(outBuilder, " (Implicit: true), (Children: ");
+            else
+                StringBuilder_AppendLiteral(outBuilder, " (Implicit: false), (Children: ");
             
+            const uint32_t* childIndices = 
+                SmallUint32List_ConstData(&compoundStatement->ChildStatements);
             if(compoundStatement->ChildStatements.Length >= 2)
             {
                 for(int j = 0; j < compoundStatement->ChildStatements.Length - 1; ++j)
                 {
-                    String_AppendFormat(inOutString, 
-                                        "%" PRIu32 ", ", 
-                                        compoundStatement->ChildStatements.Data[j]);
+                    StringBuilder_AppendUInt(outBuilder, childIndices[j]);
+                    StringBuilder_AppendLiteral(outBuilder, ", ");
                 }
             }
             
             if(compoundStatement->ChildStatements.Length > 0)
             {
                 uint32_t lastIndex = compoundStatement->ChildStatements.Length - 1;
-                String_AppendFormat(inOutString, 
-                                    "%" PRIu32, 
-                                    compoundStatement->ChildStatements.Data[lastIndex]);
+                StringBuilder_AppendUInt(outBuilder, childIndices[lastIndex]);
             }
-            String_AddValue(inOutString, ')');
+            StringBuilder_AppendChar(outBuilder, ')');
             break;
         }
         case TU_TYPE_S(TokenIndexList):
         {
             TokenIndexList* tokenIndexList = &this->Tokens.TU_DATA_S(TokenIndexList);
-            String_AppendFormat(inOutString, "TokenIndexList: (Indices: ");
+            const uint32_t* tokenIndices = SmallUint32List_ConstData(tokenIndexList);
+            StringBuilder_AppendLiteral(outBuilder, "TokenIndexList: (Indices: ");
             if(tokenIndexList->Length >= 2)
             {
                 for(int j = 0; j < tokenIndexList->Length - 1; ++j)
-                    String_AppendFormat(inOutString, "%" PRIu32 ", ", tokenIndexList->Data[j]);
+                {
+                    StringBuilder_AppendUInt(outBuilder, tokenIndices[j]);
+                    StringBuilder_AppendLiteral(outBuilder, ", ");
+                }
             }
             
             if(tokenIndexList->Length > 0)
-            {
-                String_AppendFormat(inOutString, 
-                                    "%" PRIu32, 
-                                    tokenIndexList->Data[tokenIndexList->Length - 1]);
-            }
+                StringBuilder_AppendUInt(outBuilder, tokenIndices[tokenIndexList->Length - 1]);
             
-            String_AppendFormat(inOutString, "), \"");
+            StringBuilder_AppendLiteral(outBuilder, "), \"");
             for(int j = 0; j < tokenIndexList->Length; ++j)
             {
                 ConstStringView tokenText = 
-                    Token_TokenTextView(&tokenList->Data[tokenIndexList->Data[j]]);
+                    Token_TokenTextView(&tokenList->Data[tokenIndices[j]]);
                 CHECK(tokenText.Length > 0, ("Invalid token text"), RET_ERROR_S());
-                String_AppendFormat(inOutString, "%.*s ", (int)tokenText.Length, tokenText.Data);
+                StringBuilder_AppendView(outBuilder, tokenText);
+                StringBuilder_AppendChar(outBuilder, ' ');
             }
-            String_AppendLiteral(inOutString, "\"");
+            StringBuilder_AppendLiteral(outBuilder, "\"");
             break;
         }
         case TU_TYPE_S(TokenIndexRange):
         {
             TokenIndexRange* tokenIndexRange = &this->Tokens.TU_DATA_S(TokenIndexRange);
-            String_AppendFormat(inOutString, 
-                                "TokenIndexRange: %" PRIu32 " - %" PRIu32 ", \"",
-                                tokenIndexRange->StartIndex,
-                                tokenIndexRange->EndIndex);
+            StringBuilder_AppendLiteral(outBuilder, "TokenIndexRange: ");
+            StringBuilder_AppendUInt(outBuilder, tokenIndexRange->StartIndex);
+            StringBuilder_AppendLiteral(outBuilder, " - ");
+            StringBuilder_AppendUInt(outBuilder, tokenIndexRange->EndIndex);
+            StringBuilder_AppendLiteral(outBuilder, ", \"");
             
             for(int j = tokenIndexRange->StartIndex; j < tokenIndexRange->EndIndex; ++j)
             {
                 ConstStringView tokenText = Token_TokenTextView(&tokenList->Data[j]);
                 CHECK(tokenText.Length > 0, ("Invalid token text"), RET_ERROR_S());
-                String_AppendFormat(inOutString, "%.*s ", (int)tokenText.Length, tokenText.Data);
+                StringBuilder_AppendView(outBuilder, tokenText);
+                StringBuilder_AppendChar(outBuilder, ' ');
             }
-            String_AppendLiteral(inOutString, "\"");
+            StringBuilder_AppendLiteral(outBuilder, "\"");
             break;
         }
         default:
@@ -397,7 +401,7 @@ static inline Result_Uint32 Statement_GetTokenIndexAt(  const Statement* this,
                     ("Invalid index for accessing, index: %"PRIu32", length: %"PRIu64, 
                     indexInStatement, tokenIndexList->Length),
                     RET_ERROR_S());
-            tokenIndex = tokenIndexList->Data[indexInStatement];
+            tokenIndex = SmallUint32List_ConstData(tokenIndexList)[indexInStatement];
             break;
         }
         case TU_TYPE_S(TokenIndexRange):
@@ -484,7 +488,7 @@ static inline Result_Uint32 Statement_ContainsTokenText(const Statement* this,
         //No children, just free the token list
         if(this->Tokens.Type == TU_TYPE_S(TokenIndexList))
         {
-            Uint32List_Free(&this->Tokens.TU_DATA_S(TokenIndexList));
+            SmallUint32List_Free(&this->Tokens.TU_DATA_S(TokenIndexList));
             *this = (Statement){0};
             return;
         }
@@ -515,17 +519,16 @@ static inline Result_Void AddStatementToParent( uint32_t statementIndex,
     #undef TaggedUnionNameState
     #define TaggedUnionNameState StatementTokensUnion
     
-    CHECK(  statementList->Data[currentParentIndex].Tokens.Type ==
-            TU_TYPE_S(CompoundStatement),
+    Statement* parentStatement = StatementList_At(statementList, currentParentIndex);
+    CHECK(parentStatement, (""), RET_ERROR_S());
+    CHECK(  parentStatement->Tokens.Type == TU_TYPE_S(CompoundStatement),
             ("Expecting parent to be type compound, found type index %d instead",
-            (int)statementList->Data[currentParentIndex].Tokens.Type),
+            (int)parentStatement->Tokens.Type),
             RET_ERROR_S());
     
-    StatementIndexList* parentStatementList = &statementList->Data[currentParentIndex]
-                                                            .Tokens
-                                                            .TU_DATA_S(CompoundStatement)
-                                                            .ChildStatements;
-    Uint32List_AddValue(parentStatementList, statementIndex);
+    StatementIndexList* parentStatementList =
+        &parentStatement->Tokens.TU_DATA_S(CompoundStatement).ChildStatements;
+    SmallUint32List_AddValue(parentStatementList, statementIndex);
     
     return RESULT_VALUE_S(0);
 }
@@ -545,18 +548,18 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
     CHECK(  statement->Tokens.Type != TU_TYPE_S(CompoundStatement),
             ("Unexpected statement union type"),
             RET_ERROR_S());
-        
+    
     TokenIndexList tokenIndices;
-    String tempMergedOperator;
+    SmallString tempMergedOperator;
     
     DEFER_SCOPE_START(0)
     {
         uint32_t tokensCount = Statement_GetTokenCount(statement);
-        tokenIndices = Uint32List_Create(scratchAllocator, tokensCount);
-        DEFER(0, Uint32List_Free(&tokenIndices));
+        tokenIndices = SmallUint32List_Create(scratchAllocator, tokensCount);
+        DEFER(0, SmallUint32List_Free(&tokenIndices));
         
-        tempMergedOperator = String_Create(scratchAllocator, 3);
-        DEFER(0, String_Free(&tempMergedOperator));
+        tempMergedOperator = SmallString_Create(scratchAllocator, 3);
+        DEFER(0, SmallString_Free(&tempMergedOperator));
         
         uint32_t minLookBack = 0;
         bool skipped = false;
@@ -580,7 +583,7 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                 {
                     CHECK(minLookBack < i, (""), DEFER_BREAK(0, RET_ERROR_S()));
                     
-                    String_Resize(&tempMergedOperator, 0);
+                    SmallString_Resize(&tempMergedOperator, 0);
                     for(uint32_t j = minLookBack; j <= i; ++j)
                     {
                         tokenPtrResult = Statement_GetTokenAt(statement, tokens, j);
@@ -596,13 +599,11 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                                 opChar.Length),
                                 DEFER_BREAK(0, RET_ERROR_S()));
                         
-                        String_AddValue(&tempMergedOperator, opChar.Data[0]);
+                        SmallString_AddValue(&tempMergedOperator, opChar.Data[0]);
                     }
                     
                     //If the merged tokens are valid, modify the first (continuous) token to be merged
-                    ConstStringView mergedView = 
-                        ConstStringView_Create(tempMergedOperator.Data, 
-                                                    tempMergedOperator.Length);
+                    ConstStringView mergedView = SmallString_ConstView(&tempMergedOperator);
                     if(ModC_IsValidComplexOperator(mergedView))
                     {
                         skipped = true;
@@ -615,17 +616,16 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                         {
                             String* tokenStr = &minLookBackToken->TokenText.TU_DATA(StringUnion, 
                                                                                     String);
-                            String_AddRange(tokenStr, 
-                                            &tempMergedOperator.Data[1], 
-                                            tempMergedOperator.Length - 1);
+                            String_AddRange(tokenStr, &mergedView.Data[1], mergedView.Length - 1);
                         }
+                        //Merged operators are at most a few chars, so this doesn't allocate
                         else
                         {
-                            String tokenStr = String_FromData(  tokensAllcoator, 
-                                                                tempMergedOperator.Data, 
-                                                                tempMergedOperator.Length);
+                            SmallString tokenStr = SmallString_FromData(tokensAllcoator, 
+                                                                        mergedView.Data, 
+                                                                        mergedView.Length);
                             minLookBackToken->TokenText = TU_INIT(  StringUnion, 
-                                                                    String, 
+                                                                    SmallString, 
                                                                     tokenStr);
                         }
                         
@@ -635,7 +635,7 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                         uint32_t minLookBackTokenIndex = *RESULT_TRY(   uint32Result, 
                                                                         DEFER_BREAK(0, RET_ERROR_S()));
                         
-                        Uint32List_AddValue(&tokenIndices, minLookBackTokenIndex);
+                        SmallUint32List_AddValue(&tokenIndices, minLookBackTokenIndex);
                     }
                     //Otherwise just add the tokens as they are
                     else
@@ -648,7 +648,7 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                                                                                     j);
                             uint32_t lookBackTokenIndex = *RESULT_TRY(  uint32Result, 
                                                                         DEFER_BREAK(0, RET_ERROR_S()));
-                            Uint32List_AddValue(&tokenIndices, lookBackTokenIndex);
+                            SmallUint32List_AddValue(&tokenIndices, lookBackTokenIndex);
                         }
                     }
                 } //if(!operatorNext && minLookBack != i)
@@ -657,7 +657,7 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                     Result_Uint32 uint32Result = Statement_GetTokenIndexAt(statement, tokens, i);
                     uint32_t currentTokenIndex = *RESULT_TRY(   uint32Result, 
                                                                 DEFER_BREAK(0, RET_ERROR_S()));
-                    Uint32List_AddValue(&tokenIndices, currentTokenIndex);
+                    SmallUint32List_AddValue(&tokenIndices, currentTokenIndex);
                 }
             } //if(currentToken->TokenType == TokenType_Operator)
             //Skip all comments, spaces, newlines, etc...
@@ -674,7 +674,7 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
                 Result_Uint32 uint32Result = Statement_GetTokenIndexAt(statement, tokens, i);
                 uint32_t currentTokenIndex = *RESULT_TRY(   uint32Result, 
                                                             DEFER_BREAK(0, RET_ERROR_S()));
-                Uint32List_AddValue(&tokenIndices, currentTokenIndex);
+                SmallUint32List_AddValue(&tokenIndices, currentTokenIndex);
             }
         } //for(uint32_t i = 0; i < tokensCount; ++i)
         
@@ -683,10 +683,11 @@ static inline Result_Void Statement_Normalize(  Statement* statement,
         if(skipped)
         {
             statement->Tokens = TU_INIT_S(  TokenIndexList, 
-                                            Uint32List_Create( statementsArena, tokenIndices.Length));
-            Uint32List_AddRange(&statement->Tokens.TU_DATA_S(TokenIndexList),
-                                tokenIndices.Data,
-                                tokenIndices.Length);
+                                            SmallUint32List_Create( statementsArena, 
+                                                                    tokenIndices.Length));
+            SmallUint32List_AddRange(   &statement->Tokens.TU_DATA_S(TokenIndexList),
+                                        SmallUint32List_ConstData(&tokenIndices),
+                                        tokenIndices.Length);
         }
     }
     DEFER_SCOPE_END(0)
@@ -725,10 +726,9 @@ static inline Result_Uint32 Statement_Next( const Statement* statement,
                 return RESULT_VALUE_S(0);
             }
             
-            return RESULT_VALUE_S(statement ->Tokens
-                                            .TU_DATA_S(CompoundStatement)
-                                            .ChildStatements
-                                            .Data[0]);
+            const StatementIndexList* children = 
+                &statement->Tokens.TU_DATA_S(CompoundStatement).ChildStatements;
+            return RESULT_VALUE_S(SmallUint32List_ConstData(children)[0]);
         }
         
         //If compound and we are not going up, go to first child if any
@@ -736,13 +736,13 @@ static inline Result_Uint32 Statement_Next( const Statement* statement,
             prevStatement->ParentIndex != statement->Index &&
             statement->Tokens.TU_DATA_S(CompoundStatement).ChildStatements.Length != 0)
         {
-            return RESULT_VALUE_S(statement ->Tokens
-                                            .TU_DATA_S(CompoundStatement)
-                                            .ChildStatements
-                                            .Data[0]);
+            const StatementIndexList* children = 
+                &statement->Tokens.TU_DATA_S(CompoundStatement).ChildStatements;
+            return RESULT_VALUE_S(SmallUint32List_ConstData(children)[0]);
         }
         
-        const Statement* parentStatement = &statements->Data[statement->ParentIndex];
+        const Statement* parentStatement = 
+            StatementList_ConstAt(statements, statement->ParentIndex);
         CHECK(  parentStatement->StatementType == StatementType_Compound, 
                 ("Parent statement must be compound statement"), 
                 RET_ERROR_S());
@@ -750,14 +750,17 @@ static inline Result_Uint32 Statement_Next( const Statement* statement,
         const CompoundStatement* parentCompound = 
             &parentStatement->Tokens.TU_DATA_S(CompoundStatement);
         
-        uint32_t childIndex = Uint32List_Find(&parentCompound->ChildStatements, &statement->Index);
+        uint32_t childIndex = SmallUint32List_Find(&parentCompound->ChildStatements, &statement->Index);
         CHECK(  childIndex != parentCompound->ChildStatements.Length, 
                 ("Failed to find child in parent. Corrupted Tree?"), 
                 RET_ERROR_S());
         
         //Continue to the next child if we are not at the end
         if(childIndex < parentCompound->ChildStatements.Length - 1)
-            return RESULT_VALUE_S(parentCompound->ChildStatements.Data[childIndex + 1]);
+        {
+            return RESULT_VALUE_S(SmallUint32List_ConstData(&parentCompound->ChildStatements)
+                                    [childIndex + 1]);
+        }
         //Otherwise go up if we are not under root
         else if(parentStatement->Index != parentStatement->ParentIndex)
             return RESULT_VALUE_S(parentStatement->Index);
@@ -795,7 +798,7 @@ static inline Result_Uint32 EndCurrentStatement(bool countCurrentToken,
             break;
         }
     }
-
+    
     if(allWhiteSpaceOrNewline)
     {
         *startTokenIndex = countCurrentToken ? ++i : i;
@@ -847,7 +850,7 @@ static inline Result_Uint32 EndCurrentStatement(bool countCurrentToken,
     Result_Void voidResult = AddStatementToParent(  statementList->Length - 1, 
                                                     currentParentIndex, 
                                                     statementList);
-
+    
     (void)RESULT_TRY(voidResult, RET_ERROR_S());
     return RESULT_VALUE_S(i);
 }
@@ -896,20 +899,21 @@ static inline Result_StatementList CreateStatements(const TokenList* tokens,
             if(!(cond)) \
             { \
                 String visualizeStr = Token_VisualizeLocation(  &tokens->Data[i], \
-                                                                CreateHeapAllocator(), \
+                                                                Result_ErrorAllocator(), \
                                                                 false, \
                                                                 source); \
                 \
-                return ERROR_STR_FMT_S((msg "\n%.*s", \
-                                        visualizeStr.Length, \
-                                        visualizeStr.Data)); \
+                return ERROR_STR_FMT_ALLOC_S(   Result_ErrorAllocator(), \
+                                                (msg "\n%.*s", \
+                                                visualizeStr.Length, \
+                                                visualizeStr.Data)); \
             } \
         } \
         while(0)
     
     uint32_t startTokenIndex = 0;
     uint32_t currentParentIndex = 0;
-    BoolList blockStartComplex = BoolList_Create(scratchAllocator, 16);
+    BitList blockStartComplex = BitList_Create(scratchAllocator, 64);
     for(uint32_t i = 0; i < tokens->Length; ++i)
     {
         static_assert(TokenType_Count == 19, "");
@@ -960,28 +964,29 @@ static inline Result_StatementList CreateStatements(const TokenList* tokens,
                     lastTokenIndex = j;
                     break;
                 }
-
+                
                 if(lastTokenIndex != i)
                 {
                     //Not complex statement
                     if( tokens->Data[lastTokenIndex].TokenType != TokenType_Identifier &&
                         tokens->Data[lastTokenIndex].TokenType != TokenType_InvokeEnd)
                     {
-                        BoolList_AddValue(&blockStartComplex, false);
+                        BitList_Push(&blockStartComplex, false);
                         break;
                     }
                     
                     END_CURRENT_STATEMENT(false);
                 }
                 
-                BoolList_AddValue(&blockStartComplex, true);
+                BitList_Push(&blockStartComplex, true);
                 
                 //Create compound as parent
+                //Most blocks only have a few statements, which fit inline
                 statementPtrResult = Statement_CreateCompound(  sharedArena, 
                                                                 &statementList, 
                                                                 currentParentIndex,
                                                                 false,
-                                                                32);
+                                                                0);
                 Statement* newStatement = *RESULT_TRY(statementPtrResult, RET_ERROR_S());
                 CHECK_AND_VISUALIZE_ERROR(  newStatement->Tokens.Type == 
                                             TU_TYPE_S(CompoundStatement),
@@ -1001,16 +1006,12 @@ static inline Result_StatementList CreateStatements(const TokenList* tokens,
                 if(blockStartComplex.Length == 0)   //Mismatching number of block start and ends
                     break;
                 
-                if(!blockStartComplex.Data[blockStartComplex.Length - 1])
-                {
-                    BoolList_Resize(&blockStartComplex, blockStartComplex.Length - 1);
+                if(!BitList_Pop(&blockStartComplex))
                     break;
-                }
-                BoolList_Resize(&blockStartComplex, blockStartComplex.Length - 1);
                 
                 //Finish compound parent
                 END_CURRENT_STATEMENT(false);
-                Statement* parentStatement = &statementList.Data[currentParentIndex];
+                Statement* parentStatement = StatementList_At(&statementList, currentParentIndex);
                 CHECK_AND_VISUALIZE_ERROR(  parentStatement->Tokens.Type == 
                                             TU_TYPE_S(CompoundStatement), 
                                             "Unexpected type");
@@ -0,0 +1,452 @@
+#ifndef MODC_STRINGS_NUMBER_FORMAT_H
+#define MODC_STRINGS_NUMBER_FORMAT_H
+
+/* Docs
+Locale independent number formatting without going through printf.
+
+Each function writes into `outBuffer`, which needs at least `NUMBER_FORMAT_MAX_LENGTH` bytes, and
+returns the number of chars written. The output is not null terminated.
+
+- `NumberFormat_UInt()` / `NumberFormat_Int()`: decimal, using a table of digit pairs
+- `NumberFormat_Hex()`: lowercase hex without prefix, like "%" PRIx64
+- `NumberFormat_Double()`: shortest digits that round trip (Grisu2), laid out like JavaScript's 
+  number to string: "0.001", "123.5", "1e+21", "1.5e-7". "nan", "inf" and "-inf" otherwise.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define NUMBER_FORMAT_MAX_LENGTH 32
+
+static inline uint32_t NumberFormat_UInt(char* outBuffer, uint64_t value);
+static inline uint32_t NumberFormat_Int(char* outBuffer, int64_t value);
+static inline uint32_t NumberFormat_Hex(char* outBuffer, uint64_t value);
+static inline uint32_t NumberFormat_Double(char* outBuffer, double value);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+static const char NumberFormat_DigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline uint32_t NumberFormat_UInt(char* outBuffer, uint64_t value)
+{
+    //Write backwards two digits at a time, then move to the front
+    char digits[20];
+    char* digitsStart = digits + sizeof(digits);
+    while(value >= 100)
+    {
+        const char* pair = &NumberFormat_DigitPairs[(value % 100) * 2];
+        value /= 100;
+        *--digitsStart = pair[1];
+        *--digitsStart = pair[0];
+    }
+    
+    if(value >= 10)
+    {
+        *--digitsStart = NumberFormat_DigitPairs[value * 2 + 1];
+        *--digitsStart = NumberFormat_DigitPairs[value * 2];
+    }
+    else
+        *--digitsStart = (char)('0' + value);
+    
+    uint32_t length = (uint32_t)(digits + sizeof(digits) - digitsStart);
+    memcpy(outBuffer, digitsStart, length);
+    return length;
+}
+
+static inline uint32_t NumberFormat_Int(char* outBuffer, int64_t value)
+{
+    if(value >= 0)
+        return NumberFormat_UInt(outBuffer, (uint64_t)value);
+    
+    //Negate as unsigned so INT64_MIN works
+    outBuffer[0] = '-';
+    return 1 + NumberFormat_UInt(outBuffer + 1, 0 - (uint64_t)value);
+}
+
+static inline uint32_t NumberFormat_Hex(char* outBuffer, uint64_t value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    
+    uint32_t length = 1;
+    for(uint64_t remaining = value >> 4; remaining; remaining >>= 4)
+        ++length;
+    
+    for(uint32_t i = length; i > 0; --i, value >>= 4)
+        outBuffer[i - 1] = hexDigits[value & 0xf];
+    return length;
+}
+
+//Grisu2, see "Printing Floating-Point Numbers Quickly and Accurately with Integers" by Florian 
+//Loitsch. Produces the shortest digits that round trip in the vast majority of cases, and digits 
+//that round trip in all cases.
+typedef struct
+{
+    uint64_t F;
+    int E;
+} NumberFormat_DiyFp;
+
+typedef struct
+{
+    uint64_t F;
+    int E;
+    int K;
+} NumberFormat_CachedPower;
+
+//Range of the binary exponent of the scaled value, so the integral part fits in 32 bits
+#define INTERN_NUMBER_FORMAT_ALPHA -60
+#define INTERN_NUMBER_FORMAT_GAMMA -32
+
+static inline NumberFormat_DiyFp NumberFormat_DiyFpMul(NumberFormat_DiyFp x, NumberFormat_DiyFp y)
+{
+    //Upper 64 bits of the 128 bits product, rounded
+    const uint64_t xLo = x.F & 0xffffffffu;
+    const uint64_t xHi = x.F >> 32;
+    const uint64_t yLo = y.F & 0xffffffffu;
+    const uint64_t yHi = y.F >> 32;
+    
+    const uint64_t p0 = xLo * yLo;
+    const uint64_t p1 = xLo * yHi;
+    const uint64_t p2 = xHi * yLo;
+    const uint64_t p3 = xHi * yHi;
+    
+    uint64_t mid = (p0 >> 32) + (p1 & 0xffffffffu) + (p2 & 0xffffffffu);
+    mid += 1u << 31;
+    
+    return (NumberFormat_DiyFp){ p3 + (p2 >> 32) + (p1 >> 32) + (mid >> 32), x.E + y.E + 64 };
+}
+
+static inline NumberFormat_DiyFp NumberFormat_DiyFpNormalize(NumberFormat_DiyFp x)
+{
+    while(!(x.F >> 63))
+    {
+        x.F <<= 1;
+        --x.E;
+    }
+    return x;
+}
+
+static inline NumberFormat_CachedPower NumberFormat_GetCachedPower(int binaryExponent)
+{
+    //10^K for K = -348, -340, ..., 340, as 64 bits normalized F * 2^E
+    static const NumberFormat_CachedPower cachedPowers[] =
+    {
+        { 0xFA8FD5A0081C0288ull, -1220, -348 },
+        { 0xBAAEE17FA23EBF76ull, -1193, -340 },
+        { 0x8B16FB203055AC76ull, -1166, -332 },
+        { 0xCF42894A5DCE35EAull, -1140, -324 },
+        { 0x9A6BB0AA55653B2Dull, -1113, -316 },
+        { 0xE61ACF033D1A45DFull, -1087, -308 },
+        { 0xAB70FE17C79AC6CAull, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4Full, -1034, -292 },
+        { 0xBE5691EF416BD60Cull, -1007, -284 },
+        { 0x8DD01FAD907FFC3Cull,  -980, -276 },
+        { 0xD3515C2831559A83ull,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5ull,  -927, -260 },
+        { 0xEA9C227723EE8BCBull,  -901, -252 },
+        { 0xAECC49914078536Dull,  -874, -244 },
+        { 0x823C12795DB6CE57ull,  -847, -236 },
+        { 0xC21094364DFB5637ull,  -821, -228 },
+        { 0x9096EA6F3848984Full,  -794, -220 },
+        { 0xD77485CB25823AC7ull,  -768, -212 },
+        { 0xA086CFCD97BF97F4ull,  -741, -204 },
+        { 0xEF340A98172AACE5ull,  -715, -196 },
+        { 0xB23867FB2A35B28Eull,  -688, -188 },
+        { 0x84C8D4DFD2C63F3Bull,  -661, -180 },
+        { 0xC5DD44271AD3CDBAull,  -635, -172 },
+        { 0x936B9FCEBB25C996ull,  -608, -164 },
+        { 0xDBAC6C247D62A584ull,  -582, -156 },
+        { 0xA3AB66580D5FDAF6ull,  -555, -148 },
+        { 0xF3E2F893DEC3F126ull,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8ull,  -502, -132 },
+        { 0x87625F056C7C4A8Bull,  -475, -124 },
+        { 0xC9BCFF6034C13053ull,  -449, -116 },
+        { 0x964E858C91BA2655ull,  -422, -108 },
+        { 0xDFF9772470297EBDull,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88Full,  -369,  -92 },
+        { 0xF8A95FCF88747D94ull,  -343,  -84 },
+        { 0xB94470938FA89BCFull,  -316,  -76 },
+        { 0x8A08F0F8BF0F156Bull,  -289,  -68 },
+        { 0xCDB02555653131B6ull,  -263,  -60 },
+        { 0x993FE2C6D07B7FACull,  -236,  -52 },
+        { 0xE45C10C42A2B3B06ull,  -210,  -44 },
+        { 0xAA242499697392D3ull,  -183,  -36 },
+        { 0xFD87B5F28300CA0Eull,  -157,  -28 },
+        { 0xBCE5086492111AEBull,  -130,  -20 },
+        { 0x8CBCCC096F5088CCull,  -103,  -12 },
+        { 0xD1B71758E219652Cull,   -77,   -4 },
+        { 0x9C40000000000000ull,   -50,    4 },
+        { 0xE8D4A51000000000ull,   -24,   12 },
+        { 0xAD78EBC5AC620000ull,     3,   20 },
+        { 0x813F3978F8940984ull,    30,   28 },
+        { 0xC097CE7BC90715B3ull,    56,   36 },
+        { 0x8F7E32CE7BEA5C70ull,    83,   44 },
+        { 0xD5D238A4ABE98068ull,   109,   52 },
+        { 0x9F4F2726179A2245ull,   136,   60 },
+        { 0xED63A231D4C4FB27ull,   162,   68 },
+        { 0xB0DE65388CC8ADA8ull,   189,   76 },
+        { 0x83C7088E1AAB65DBull,   216,   84 },
+        { 0xC45D1DF942711D9Aull,   242,   92 },
+        { 0x924D692CA61BE758ull,   269,  100 },
+        { 0xDA01EE641A708DEAull,   295,  108 },
+        { 0xA26DA3999AEF774Aull,   322,  116 },
+        { 0xF209787BB47D6B85ull,   348,  124 },
+        { 0xB454E4A179DD1877ull,   375,  132 },
+        { 0x865B86925B9BC5C2ull,   402,  140 },
+        { 0xC83553C5C8965D3Dull,   428,  148 },
+        { 0x952AB45CFA97A0B3ull,   455,  156 },
+        { 0xDE469FBD99A05FE3ull,   481,  164 },
+        { 0xA59BC234DB398C25ull,   508,  172 },
+        { 0xF6C69A72A3989F5Cull,   534,  180 },
+        { 0xB7DCBF5354E9BECEull,   561,  188 },
+        { 0x88FCF317F22241E2ull,   588,  196 },
+        { 0xCC20CE9BD35C78A5ull,   614,  204 },
+        { 0x98165AF37B2153DFull,   641,  212 },
+        { 0xE2A0B5DC971F303Aull,   667,  220 },
+        { 0xA8D9D1535CE3B396ull,   694,  228 },
+        { 0xFB9B7CD9A4A7443Cull,   720,  236 },
+        { 0xBB764C4CA7A44410ull,   747,  244 },
+        { 0x8BAB8EEFB6409C1Aull,   774,  252 },
+        { 0xD01FEF10A657842Cull,   800,  260 },
+        { 0x9B10A4E5E9913129ull,   827,  268 },
+        { 0xE7109BFBA19C0C9Dull,   853,  276 },
+        { 0xAC2820D9623BF429ull,   880,  284 },
+        { 0x80444B5E7AA7CF85ull,   907,  292 },
+        { 0xBF21E44003ACDD2Dull,   933,  300 },
+        { 0x8E679C2F5E44FF8Full,   960,  308 },
+        { 0xD433179D9C8CB841ull,   986,  316 },
+        { 0x9E19DB92B4E31BA9ull,  1013,  324 },
+        { 0xEB96BF6EBADF77D9ull,  1039,  332 },
+        { 0xAF87023B9BF0EE6Bull,  1066,  340 }
+    };
+    
+    //Smallest K with 10^K >= 2^(ALPHA - binaryExponent - 1), 78913 / 2^18 is log10(2) rounded up
+    const int minPow2 = INTERN_NUMBER_FORMAT_ALPHA - binaryExponent - 1;
+    const int k = minPow2 * 78913 / (1 << 18) + (minPow2 > 0);
+    const int index = (348 + k + 7) / 8;
+    return cachedPowers[index];
+}
+
+//Moves the last digit towards `distance` while staying inside the rounding interval
+static inline void NumberFormat_Grisu2Round(char* digits, 
+                                            int length, 
+                                            uint64_t distance, 
+                                            uint64_t delta, 
+                                            uint64_t rest, 
+                                            uint64_t tenK)
+{
+    while(  rest < distance && 
+            delta - rest >= tenK && 
+            (rest + tenK < distance || distance - rest > rest + tenK - distance))
+    {
+        --digits[length - 1];
+        rest += tenK;
+    }
+}
+
+static inline void NumberFormat_Grisu2DigitGen(char* outDigits,
+                                                int* outLength,
+                                                int* inOutDecimalExponent,
+                                                NumberFormat_DiyFp low,
+                                                NumberFormat_DiyFp value,
+                                                NumberFormat_DiyFp high)
+{
+    uint64_t delta = high.F - low.F;
+    uint64_t distance = high.F - value.F;
+    
+    //Split `high` into its integral part, which fits in 32 bits, and its fractional part
+    const int shift = -high.E;
+    const uint64_t one = 1ull << shift;
+    uint32_t integral = (uint32_t)(high.F >> shift);
+    uint64_t fractional = high.F & (one - 1);
+    
+    uint32_t pow10 = 1000000000;
+    int pow10Digits = 10;
+    while(pow10Digits > 1 && integral < pow10)
+    {
+        pow10 /= 10;
+        --pow10Digits;
+    }
+    
+    int length = 0;
+    while(pow10Digits > 0)
+    {
+        outDigits[length++] = (char)('0' + integral / pow10);
+        integral %= pow10;
+        --pow10Digits;
+        
+        uint64_t rest = ((uint64_t)integral << shift) + fractional;
+        if(rest <= delta)
+        {
+            *inOutDecimalExponent += pow10Digits;
+            NumberFormat_Grisu2Round(   outDigits, 
+                                        length, 
+                                        distance, 
+                                        delta, 
+                                        rest, 
+                                        (uint64_t)pow10 << shift);
+            *outLength = length;
+            return;
+        }
+        pow10 /= 10;
+    }
+    
+    int fractionalDigits = 0;
+    while(true)
+    {
+        fractional *= 10;
+        outDigits[length++] = (char)('0' + (fractional >> shift));
+        fractional &= one - 1;
+        ++fractionalDigits;
+        delta *= 10;
+        distance *= 10;
+        if(fractional <= delta)
+            break;
+    }
+    
+    *inOutDecimalExponent -= fractionalDigits;
+    NumberFormat_Grisu2Round(outDigits, length, distance, delta, fractional, one);
+    *outLength = length;
+}
+
+//`value` must be finite and positive. The result is `outDigits * 10^outDecimalExponent`
+static inline void NumberFormat_Grisu2(  char* outDigits, 
+                                        int* outLength, 
+                                        int* outDecimalExponent, 
+                                        double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    
+    const uint64_t hiddenBit = 1ull << 52;
+    const uint64_t fraction = bits & (hiddenBit - 1);
+    const int biasedExponent = (int)(bits >> 52);
+    
+    //Subnormals have no hidden bit and the same exponent as the smallest normal
+    NumberFormat_DiyFp diyValue = { fraction, 1 - 1075 };
+    if(biasedExponent != 0)
+        diyValue = (NumberFormat_DiyFp){ fraction + hiddenBit, biasedExponent - 1075 };
+    
+    //Boundaries halfway to the neighbouring doubles. The lower one is closer at powers of 2
+    const bool lowerIsCloser = fraction == 0 && biasedExponent > 1;
+    NumberFormat_DiyFp high = { diyValue.F * 2 + 1, diyValue.E - 1 };
+    NumberFormat_DiyFp low =    lowerIsCloser ? 
+                                (NumberFormat_DiyFp){ diyValue.F * 4 - 1, diyValue.E - 2 } :
+                                (NumberFormat_DiyFp){ diyValue.F * 2 - 1, diyValue.E - 1 };
+    
+    high = NumberFormat_DiyFpNormalize(high);
+    low.F <<= low.E - high.E;
+    low.E = high.E;
+    diyValue = NumberFormat_DiyFpNormalize(diyValue);
+    
+    const NumberFormat_CachedPower cached = NumberFormat_GetCachedPower(high.E);
+    const NumberFormat_DiyFp cachedDiy = { cached.F, cached.E };
+    NumberFormat_DiyFp scaledValue = NumberFormat_DiyFpMul(diyValue, cachedDiy);
+    NumberFormat_DiyFp scaledLow = NumberFormat_DiyFpMul(low, cachedDiy);
+    NumberFormat_DiyFp scaledHigh = NumberFormat_DiyFpMul(high, cachedDiy);
+    
+    //Shrink the interval by 1 ulp on each side to account for the rounding of the multiplications
+    ++scaledLow.F;
+    --scaledHigh.F;
+    
+    *outDecimalExponent = -cached.K;
+    NumberFormat_Grisu2DigitGen(outDigits, 
+                                outLength, 
+                                outDecimalExponent, 
+                                scaledLow, 
+                                scaledValue, 
+                                scaledHigh);
+}
+
+static inline uint32_t NumberFormat_Double(char* outBuffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    
+    char* out = outBuffer;
+    if((bits >> 52 & 0x7ff) == 0x7ff)
+    {
+        if(bits & ((1ull << 52) - 1))
+        {
+            memcpy(out, "nan", 3);
+            return 3;
+        }
+        if(bits >> 63)
+            *out++ = '-';
+        memcpy(out, "inf", 3);
+        return (uint32_t)(out - outBuffer) + 3;
+    }
+    
+    if(bits >> 63)
+    {
+        *out++ = '-';
+        value = -value;
+    }
+    
+    if(value == 0)
+    {
+        *out++ = '0';
+        return (uint32_t)(out - outBuffer);
+    }
+    
+    char digits[18];
+    int digitCount = 0;
+    int decimalExponent = 0;
+    NumberFormat_Grisu2(digits, &digitCount, &decimalExponent, value);
+    
+    //Position of the decimal point relative to the start of the digits
+    const int pointIndex = digitCount + decimalExponent;
+    if(digitCount <= pointIndex && pointIndex <= 21)
+    {
+        //Integer: 1230
+        memcpy(out, digits, digitCount);
+        memset(out + digitCount, '0', pointIndex - digitCount);
+        out += pointIndex;
+    }
+    else if(0 < pointIndex && pointIndex <= 21)
+    {
+        //Fixed: 12.3
+        memcpy(out, digits, pointIndex);
+        out[pointIndex] = '.';
+        memcpy(out + pointIndex + 1, digits + pointIndex, digitCount - pointIndex);
+        out += digitCount + 1;
+    }
+    else if(-6 < pointIndex && pointIndex <= 0)
+    {
+        //Small: 0.00123
+        out[0] = '0';
+        out[1] = '.';
+        memset(out + 2, '0', -pointIndex);
+        memcpy(out + 2 - pointIndex, digits, digitCount);
+        out += 2 - pointIndex + digitCount;
+    }
+    else
+    {
+        //Scientific: 1.23e+25
+        *out++ = digits[0];
+        if(digitCount > 1)
+        {
+            *out++ = '.';
+            memcpy(out, digits + 1, digitCount - 1);
+            out += digitCount - 1;
+        }
+        *out++ = 'e';
+        *out++ = pointIndex - 1 < 0 ? '-' : '+';
+        out += NumberFormat_UInt(out, pointIndex - 1 < 0 ? 1 - pointIndex : pointIndex - 1);
+    }
+    return (uint32_t)(out - outBuffer);
+}
+
+#endif
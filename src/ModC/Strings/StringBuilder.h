@@ -0,0 +1,343 @@
+#ifndef MODC_STRINGS_STRING_BUILDER_H
+#define MODC_STRINGS_STRING_BUILDER_H
+
+/* Docs
+StringBuilder appends into a chain of fixed size chunks, so growing never copies what is already
+written. Formatted appends write directly into the spare space of the last chunk and only format
+again if it didn't fit.
+
+Write the result out with `StringBuilder_WriteToFile()` (or `StringBuilder_WriteToFd()` on POSIX),
+or join it into a contiguous String with `StringBuilder_ToString()`.
+
+Numbers appended with `StringBuilder_AppendInt()` and friends are formatted with NumberFormat.h 
+straight into the tail chunk.
+
+Just read the code to see what the functions are
+*/
+
+#include "ModC/Allocator.h"
+#include "ModC/Strings/Strings.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+    #define INTERN_STRING_BUILDER_HAS_FD 1
+#endif
+
+#define STRING_BUILDER_DEFAULT_CHUNK_SIZE 4096
+
+typedef struct StringBuilderChunk StringBuilderChunk;
+struct StringBuilderChunk
+{
+    StringBuilderChunk* Next;
+    uint64_t Length;
+    uint64_t Cap;
+    char Data[];
+};
+
+typedef struct StringBuilder
+{
+    Allocator Allocator;
+    StringBuilderChunk* Head;
+    StringBuilderChunk* Tail;       //Chunk being appended to. Chunks after it are kept for reuse
+    uint64_t Length;
+    uint64_t ChunkSize;
+} StringBuilder;
+
+//`chunkSize` of 0 uses `STRING_BUILDER_DEFAULT_CHUNK_SIZE`
+static inline StringBuilder StringBuilder_Create(Allocator allocator, uint64_t chunkSize);
+static inline void StringBuilder_Free(StringBuilder* this);
+
+//Empties the builder but keeps the chunks for reuse
+static inline void StringBuilder_Clear(StringBuilder* this);
+
+static inline StringBuilder*
+StringBuilder_AppendData(StringBuilder* this, const char* data, uint64_t length);
+static inline StringBuilder* StringBuilder_AppendChar(StringBuilder* this, char c);
+
+#define StringBuilder_AppendLiteral(this, cstr) \
+    StringBuilder_AppendData(this, cstr, sizeof(cstr) - 1)
+
+#define StringBuilder_AppendView(this, view) \
+    StringBuilder_AppendData(this, (view).Data, (view).Length)
+
+static inline StringBuilder* 
+StringBuilder_AppendFormat(StringBuilder* this, const char* format, ...);
+static inline StringBuilder*
+StringBuilder_AppendVFormat(StringBuilder* this, const char* format, va_list args);
+
+static inline StringBuilder* StringBuilder_AppendInt(StringBuilder* this, int64_t value);
+static inline StringBuilder* StringBuilder_AppendUInt(StringBuilder* this, uint64_t value);
+static inline StringBuilder* StringBuilder_AppendHex(StringBuilder* this, uint64_t value);
+static inline StringBuilder* StringBuilder_AppendDouble(StringBuilder* this, double value);
+
+//Returns false if writing failed
+static inline bool StringBuilder_WriteToFile(const StringBuilder* this, FILE* file);
+
+#if INTERN_STRING_BUILDER_HAS_FD
+    //Returns false if writing failed
+    static inline bool StringBuilder_WriteToFd(const StringBuilder* this, int fd);
+#endif
+
+//Joins all the chunks into one String allocated with `allocator`
+static inline String StringBuilder_ToString(const StringBuilder* this, Allocator allocator);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+static inline StringBuilder StringBuilder_Create(Allocator allocator, uint64_t chunkSize)
+{
+    return  (StringBuilder)
+            {
+                .Allocator = allocator,
+                .ChunkSize = chunkSize == 0 ? STRING_BUILDER_DEFAULT_CHUNK_SIZE : chunkSize
+            };
+}
+
+static inline void StringBuilder_Free(StringBuilder* this)
+{
+    if(!this)
+        return;
+    
+    StringBuilderChunk* chunk = this->Head;
+    while(chunk)
+    {
+        StringBuilderChunk* nextChunk = chunk->Next;
+        Allocator_Free(&this->Allocator, chunk);
+        chunk = nextChunk;
+    }
+    Allocator_Destroy(&this->Allocator);
+    *this = (StringBuilder){0};
+}
+
+static inline void StringBuilder_Clear(StringBuilder* this)
+{
+    if(!this)
+        return;
+    
+    for(StringBuilderChunk* chunk = this->Head; chunk; chunk = chunk->Next)
+        chunk->Length = 0;
+    this->Tail = this->Head;
+    this->Length = 0;
+}
+
+//Makes sure the tail chunk has at least `minSpare` bytes free. Returns NULL if allocation failed
+static inline StringBuilderChunk*
+StringBuilder_InternReserveTail(StringBuilder* this, uint64_t minSpare)
+{
+    StringBuilderChunk* tail = this->Tail;
+    if(tail && tail->Cap - tail->Length >= minSpare)
+        return tail;
+    
+    //Reuse the chunks kept by `StringBuilder_Clear()` if they are large enough
+    if(tail && tail->Next && tail->Next->Cap >= minSpare)
+    {
+        this->Tail = tail->Next;
+        return this->Tail;
+    }
+    
+    uint64_t chunkCap = minSpare > this->ChunkSize ? minSpare : this->ChunkSize;
+    StringBuilderChunk* newChunk =
+        Allocator_Malloc(&this->Allocator, sizeof(StringBuilderChunk) + chunkCap);
+    if(!newChunk)
+        return NULL;
+    
+    *newChunk = (StringBuilderChunk){ .Next = tail ? tail->Next : NULL, .Cap = chunkCap };
+    if(tail)
+        tail->Next = newChunk;
+    else
+        this->Head = newChunk;
+    this->Tail = newChunk;
+    return newChunk;
+}
+
+static inline StringBuilder*
+StringBuilder_AppendData(StringBuilder* this, const char* data, uint64_t length)
+{
+    if(!this || !data || length == 0)
+        return this;
+    
+    while(length > 0)
+    {
+        StringBuilderChunk* tail = StringBuilder_InternReserveTail(this, 1);
+        if(!tail)
+            return this;
+        
+        uint64_t copyLength = tail->Cap - tail->Length < length ? tail->Cap - tail->Length : length;
+        memcpy(tail->Data + tail->Length, data, copyLength);
+        tail->Length += copyLength;
+        this->Length += copyLength;
+        data += copyLength;
+        length -= copyLength;
+    }
+    return this;
+}
+
+static inline StringBuilder* StringBuilder_AppendChar(StringBuilder* this, char c)
+{
+    return StringBuilder_AppendData(this, &c, 1);
+}
+
+static inline StringBuilder* 
+StringBuilder_AppendFormat(StringBuilder* this, const char* format, ...)
+{
+    va_list args1;
+    va_start(args1, format);
+    StringBuilder_AppendVFormat(this, format, args1);
+    va_end(args1);
+    return this;
+}
+
+static inline StringBuilder*
+StringBuilder_AppendVFormat(StringBuilder* this, const char* format, va_list args)
+{
+    if(!this || !format)
+        return this;
+    
+    va_list args2;
+    va_copy(args2, args);
+    
+    //Format into the spare space of the tail first, vsnprintf needs room for the null terminator
+    StringBuilderChunk* tail = this->Tail;
+    uint64_t spare = tail ? tail->Cap - tail->Length : 0;
+    int writeLen = vsnprintf(tail ? tail->Data + tail->Length : NULL, spare, format, args);
+    if(writeLen <= 0)
+        goto exitPoint;
+    
+    if((uint64_t)writeLen < spare)
+    {
+        tail->Length += writeLen;
+        this->Length += writeLen;
+        goto exitPoint;
+    }
+    
+    //Didn't fit, the output is kept in one chunk so format again into a chunk with enough space
+    tail = StringBuilder_InternReserveTail(this, (uint64_t)writeLen + 1);
+    if(!tail)
+        goto exitPoint;
+    
+    vsnprintf(tail->Data + tail->Length, writeLen + 1, format, args2);
+    tail->Length += writeLen;
+    this->Length += writeLen;
+    
+    exitPoint:;
+    va_end(args2);
+    
+    return this;
+}
+
+//Reserves enough space in the tail for any number, and returns where to write it. NULL on failure
+static inline char* StringBuilder_InternNumberBuffer(StringBuilder* this)
+{
+    if(!this)
+        return NULL;
+    
+    StringBuilderChunk* tail = StringBuilder_InternReserveTail(this, NUMBER_FORMAT_MAX_LENGTH);
+    return tail ? tail->Data + tail->Length : NULL;
+}
+
+static inline StringBuilder* StringBuilder_InternCommitNumber(StringBuilder* this, uint32_t length)
+{
+    this->Tail->Length += length;
+    this->Length += length;
+    return this;
+}
+
+static inline StringBuilder* StringBuilder_AppendInt(StringBuilder* this, int64_t value)
+{
+    char* buffer = StringBuilder_InternNumberBuffer(this);
+    if(!buffer)
+        return this;
+    return StringBuilder_InternCommitNumber(this, NumberFormat_Int(buffer, value));
+}
+
+static inline StringBuilder* StringBuilder_AppendUInt(StringBuilder* this, uint64_t value)
+{
+    char* buffer = StringBuilder_InternNumberBuffer(this);
+    if(!buffer)
+        return this;
+    return StringBuilder_InternCommitNumber(this, NumberFormat_UInt(buffer, value));
+}
+
+static inline StringBuilder* StringBuilder_AppendHex(StringBuilder* this, uint64_t value)
+{
+    char* buffer = StringBuilder_InternNumberBuffer(this);
+    if(!buffer)
+        return this;
+    return StringBuilder_InternCommitNumber(this, NumberFormat_Hex(buffer, value));
+}
+
+static inline StringBuilder* StringBuilder_AppendDouble(StringBuilder* this, double value)
+{
+    char* buffer = StringBuilder_InternNumberBuffer(this);
+    if(!buffer)
+        return this;
+    return StringBuilder_InternCommitNumber(this, NumberFormat_Double(buffer, value));
+}
+
+static inline bool StringBuilder_WriteToFile(const StringBuilder* this, FILE* file)
+{
+    if(!this || !file)
+        return false;
+    
+    for(const StringBuilderChunk* chunk = this->Head; chunk; chunk = chunk->Next)
+    {
+        if(chunk->Length == 0)
+            continue;
+        if(fwrite(chunk->Data, 1, chunk->Length, file) != chunk->Length)
+            return false;
+    }
+    return true;
+}
+
+#if INTERN_STRING_BUILDER_HAS_FD
+    static inline bool StringBuilder_WriteToFd(const StringBuilder* this, int fd)
+    {
+        if(!this || fd < 0)
+            return false;
+        
+        for(const StringBuilderChunk* chunk = this->Head; chunk; chunk = chunk->Next)
+        {
+            if(chunk->Length == 0)
+                continue;
+            
+            const char* data = chunk->Data;
+            uint64_t length = chunk->Length;
+            while(length > 0)
+            {
+                ssize_t written = write(fd, data, length);
+                if(written <= 0)
+                    return false;
+                data += written;
+                length -= written;
+            }
+        }
+        return true;
+    }
+#endif
+
+static inline String StringBuilder_ToString(const StringBuilder* this, Allocator allocator)
+{
+    if(!this)
+        return (String){0};
+    
+    String retStr = String_Create(allocator, this->Length);
+    if(retStr.Cap < this->Length)
+        return retStr;
+    
+    for(const StringBuilderChunk* chunk = this->Head; chunk; chunk = chunk->Next)
+    {
+        if(chunk->Length == 0)
+            continue;
+        String_AddRange(&retStr, chunk->Data, chunk->Length);
+    }
+    return retStr;
+}
+
+#endif
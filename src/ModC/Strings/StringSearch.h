@@ -0,0 +1,268 @@
+#ifndef MODC_STRINGS_STRING_SEARCH_H
+#define MODC_STRINGS_STRING_SEARCH_H
+
+/* Docs
+Searching and comparing of char ranges, 16 bytes at a time with SSE2 (and SSSE3 for char sets)
+when available, scalar otherwise. Nothing is read outside of the given ranges, so these work on
+any view and not just padded buffers.
+
+Find functions return the index of the first match, `length` if nothing is found.
+
+- `StringSearch_FindChar()`
+- `StringSearch_FindAnyOf()`: Any char in a `StringCharSet`, created with `StringCharSet_Create()`
+- `StringSearch_FindSubstring()`: Compares the first and last char of the needle for 16 positions
+  at once, and only the candidates with memcmp
+- `StringSearch_Equals()`: Up to 16 bytes are compared with 2 overlapping loads, without memcmp
+
+The ConstStringView versions of these are in Strings.h
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__)
+    #include <tmmintrin.h>
+#endif
+
+//A set of chars looked up with the low and high nibble of each char (Shufti). A char is in the
+//set if `LowNibbleMasks[c & 0xf] & HighNibbleMasks[c >> 4]` is not 0. Each distinct high nibble
+//gets its own bit, so this is exact for up to 8 of them. Otherwise hits are checked with `Bitmap`
+typedef struct
+{
+    uint8_t LowNibbleMasks[16];
+    uint8_t HighNibbleMasks[16];
+    uint64_t Bitmap[4];
+    bool NibblesExact;
+} StringCharSet;
+
+static inline StringCharSet StringCharSet_Create(const char* chars, uint64_t charsLength);
+
+#define StringCharSet_FromLiteral(cstr) StringCharSet_Create(cstr, sizeof(cstr) - 1)
+
+static inline bool StringCharSet_Contains(const StringCharSet* this, char c);
+
+static inline uint64_t StringSearch_FindChar(const char* data, uint64_t length, char c);
+
+static inline uint64_t
+StringSearch_FindAnyOf(const char* data, uint64_t length, const StringCharSet* charSet);
+
+static inline uint64_t StringSearch_FindSubstring( const char* data,
+                                                    uint64_t length,
+                                                    const char* needle,
+                                                    uint64_t needleLength);
+
+static inline bool
+StringSearch_Equals(const char* dataA, uint64_t lengthA, const char* dataB, uint64_t lengthB);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+static inline StringCharSet StringCharSet_Create(const char* chars, uint64_t charsLength)
+{
+    StringCharSet retSet = { .NibblesExact = true };
+    
+    //Bit assigned to each high nibble, 0 if not assigned yet
+    uint8_t highNibbleBits[16] = {0};
+    int usedBits = 0;
+    for(uint64_t i = 0; i < charsLength; ++i)
+    {
+        const uint8_t c = (uint8_t)chars[i];
+        retSet.Bitmap[c >> 6] |= 1ull << (c & 63);
+        
+        if(!highNibbleBits[c >> 4])
+        {
+            if(usedBits == 8)
+                retSet.NibblesExact = false;
+            highNibbleBits[c >> 4] = (uint8_t)(1u << (usedBits++ % 8));
+        }
+        
+        retSet.LowNibbleMasks[c & 0xf] |= highNibbleBits[c >> 4];
+        retSet.HighNibbleMasks[c >> 4] = highNibbleBits[c >> 4];
+    }
+    return retSet;
+}
+
+static inline bool StringCharSet_Contains(const StringCharSet* this, char c)
+{
+    const uint8_t byte = (uint8_t)c;
+    return (this->Bitmap[byte >> 6] >> (byte & 63)) & 1;
+}
+
+static inline int StringSearch_LowestBit(uint32_t mask)
+{
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(mask);
+    #else
+        int retIndex = 0;
+        while(!(mask & 1))
+        {
+            mask >>= 1;
+            ++retIndex;
+        }
+        return retIndex;
+    #endif
+}
+
+static inline uint64_t StringSearch_FindChar(const char* data, uint64_t length, char c)
+{
+    if(!data)
+        return length;
+    
+    uint64_t i = 0;
+    #if defined(__SSE2__)
+        const __m128i target = _mm_set1_epi8(c);
+        for(; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(data + i));
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, target));
+            if(mask)
+                return i + StringSearch_LowestBit(mask);
+        }
+    #endif
+    
+    for(; i < length; ++i)
+    {
+        if(data[i] == c)
+            return i;
+    }
+    return length;
+}
+
+static inline uint64_t
+StringSearch_FindAnyOf(const char* data, uint64_t length, const StringCharSet* charSet)
+{
+    if(!data || !charSet)
+        return length;
+    
+    uint64_t i = 0;
+    #if defined(__SSSE3__)
+        const __m128i lowTable =
+            _mm_loadu_si128((const __m128i*)(const void*)charSet->LowNibbleMasks);
+        const __m128i highTable =
+            _mm_loadu_si128((const __m128i*)(const void*)charSet->HighNibbleMasks);
+        const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+        for(; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(data + i));
+            __m128i lowMatch = _mm_shuffle_epi8(lowTable, _mm_and_si128(block, nibbleMask));
+            __m128i highMatch =
+                _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask));
+            __m128i noMatch = _mm_cmpeq_epi8(   _mm_and_si128(lowMatch, highMatch),
+                                                _mm_setzero_si128());
+            uint32_t mask = ~(uint32_t)_mm_movemask_epi8(noMatch) & 0xffff;
+            
+            //Shared nibble bits can give false positives, check them with the bitmap
+            while(mask)
+            {
+                int bitIndex = StringSearch_LowestBit(mask);
+                if(charSet->NibblesExact || StringCharSet_Contains(charSet, data[i + bitIndex]))
+                    return i + bitIndex;
+                mask &= mask - 1;
+            }
+        }
+    #endif
+    
+    for(; i < length; ++i)
+    {
+        if(StringCharSet_Contains(charSet, data[i]))
+            return i;
+    }
+    return length;
+}
+
+static inline uint64_t StringSearch_FindSubstring( const char* data,
+                                                    uint64_t length,
+                                                    const char* needle,
+                                                    uint64_t needleLength)
+{
+    if(needleLength == 0)
+        return 0;
+    if(!data || !needle || needleLength > length)
+        return length;
+    if(needleLength == 1)
+        return StringSearch_FindChar(data, length, needle[0]);
+    
+    const uint64_t lastStart = length - needleLength;
+    uint64_t i = 0;
+    #if defined(__SSE2__)
+        const __m128i firstChar = _mm_set1_epi8(needle[0]);
+        const __m128i lastChar = _mm_set1_epi8(needle[needleLength - 1]);
+        for(; i + 16 <= lastStart + 1; i += 16)
+        {
+            __m128i firstBlock = _mm_loadu_si128((const __m128i*)(const void*)(data + i));
+            __m128i lastBlock =
+                _mm_loadu_si128((const __m128i*)(const void*)(data + i + needleLength - 1));
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(firstBlock, firstChar),
+                              _mm_cmpeq_epi8(lastBlock, lastChar)));
+            while(mask)
+            {
+                int bitIndex = StringSearch_LowestBit(mask);
+                if(memcmp(data + i + bitIndex + 1, needle + 1, needleLength - 2) == 0)
+                    return i + bitIndex;
+                mask &= mask - 1;
+            }
+        }
+    #endif
+    
+    for(; i <= lastStart; ++i)
+    {
+        if( data[i] == needle[0] &&
+            data[i + needleLength - 1] == needle[needleLength - 1] &&
+            memcmp(data + i + 1, needle + 1, needleLength - 2) == 0)
+        {
+            return i;
+        }
+    }
+    return length;
+}
+
+static inline bool
+StringSearch_Equals(const char* dataA, uint64_t lengthA, const char* dataB, uint64_t lengthB)
+{
+    if(lengthA != lengthB)
+        return false;
+    if(lengthA == 0)
+        return true;
+    
+    //Short strings, which is what most tokens and literals are. Load the first and last bytes
+    //of the string, which overlap if shorter than 2 loads
+    if(lengthA >= 8 && lengthA <= 16)
+    {
+        uint64_t headA, headB, tailA, tailB;
+        memcpy(&headA, dataA, 8);
+        memcpy(&headB, dataB, 8);
+        memcpy(&tailA, dataA + lengthA - 8, 8);
+        memcpy(&tailB, dataB + lengthA - 8, 8);
+        return ((headA ^ headB) | (tailA ^ tailB)) == 0;
+    }
+    
+    if(lengthA >= 4 && lengthA < 8)
+    {
+        uint32_t headA, headB, tailA, tailB;
+        memcpy(&headA, dataA, 4);
+        memcpy(&headB, dataB, 4);
+        memcpy(&tailA, dataA + lengthA - 4, 4);
+        memcpy(&tailB, dataB + lengthA - 4, 4);
+        return ((headA ^ headB) | (tailA ^ tailB)) == 0;
+    }
+    
+    //1 to 3 bytes, first, middle and last cover all of them
+    if(lengthA < 4)
+    {
+        return  dataA[0] == dataB[0] &&
+                dataA[lengthA / 2] == dataB[lengthA / 2] &&
+                dataA[lengthA - 1] == dataB[lengthA - 1];
+    }
+    
+    return memcmp(dataA, dataB, lengthA) == 0;
+}
+
+#endif
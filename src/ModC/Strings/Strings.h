@@ -4,31 +4,66 @@
 /* Docs
 Creates String using List.h and StringView/ConstStringView using View.h
 
+Creates AlignedString using List.h, a String whose data is aligned to `ALIGNED_STRING_ALIGNMENT`
+and followed by readable padding, for buffers scanned with vector loads like the source file.
+
+Creates SmallString using SmallList.h, which stores up to `SMALL_STRING_INLINE_CAP` chars without 
+allocating. It has the same size as String, use it for short strings like identifiers and operators.
+Use `SmallString_ConstView()` to read it since the data can be inline.
+
 Also creates a tagged union StringUnion which is an union of all of the types above using 
 TaggedUnion.h
 
+Searching, comparing and splitting of ConstStringView (`ConstStringView_FindChar()`, 
+`ConstStringView_StartsWith()`, `StringSplitter` and so on) use StringSearch.h.
+
+Number appending functions (`String_AppendInt()` and friends) use NumberFormat.h instead of 
+printf, see there for the output format.
+
 Other than that, this also contains various helper functions. Just read the code to see what they are
 */
 
 #include "ModC/Allocator.h"
 
+#include "static_assert.h/assert.h"
+
 #define LIST_NAME String
 #define VALUE_TYPE char
 #include "ModC/List.h"
 
+#define ALIGNED_STRING_ALIGNMENT 64
+
+#define LIST_NAME AlignedString
+#define VALUE_TYPE char
+#define LIST_ALIGNMENT ALIGNED_STRING_ALIGNMENT
+#include "ModC/List.h"
+
 
 #define VIEW_NAME StringView
 #define CONST_VIEW_NAME ConstStringView
 #define VALUE_TYPE char
 #include "ModC/View.h"
 
+#define SMALL_STRING_INLINE_CAP 16
+
+#define LIST_NAME SmallString
+#define VALUE_TYPE char
+#define INLINE_CAP SMALL_STRING_INLINE_CAP
+#include "ModC/SmallList.h"
+
+static_assert(sizeof(SmallString) == sizeof(String), "SmallString grew");
+
+#include "ModC/Strings/NumberFormat.h"
+#include "ModC/Strings/StringSearch.h"
+
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #define TU_NAME StringUnion
-#define VALUE_TYPES String,StringView,ConstStringView
+#define VALUE_TYPES String,StringView,ConstStringView,SmallString
 #include "ModC/TaggedUnion.h"
 
 #define StringUnion_ViewFromLiteral(cstr) \
@@ -44,15 +79,34 @@ static inline ConstStringView StringUnion_GetConstView(const StringUnion* this);
 static inline String String_FromData(Allocator allocator, const char* data, uint64_t length);
 
 #define String_FromLiteral(allocator, cstr) String_FromData(allocator, cstr, sizeof(cstr) - 1)
-    
+
 static inline String String_FromFormat(Allocator allocator, const char* format, ...);
 static inline String* String_AppendFormat(String* this, const char* format, ...);
 
 static inline String String_FromVFormat(Allocator allocator, const char* format, va_list args);
 static inline String* String_AppendVFormat(String* this, const char* format, va_list args);
 
+static inline String* String_AppendInt(String* this, int64_t value);
+static inline String* String_AppendUInt(String* this, uint64_t value);
+static inline String* String_AppendHex(String* this, uint64_t value);
+static inline String* String_AppendDouble(String* this, double value);
+
+static inline SmallString 
+SmallString_FromData(Allocator allocator, const char* data, uint64_t length);
+
+#define SmallString_FromLiteral(allocator, cstr) \
+    SmallString_FromData(allocator, cstr, sizeof(cstr) - 1)
+
+#define SmallString_AppendLiteral(stringObj, cstr) \
+    SmallString_AddRange((stringObj), cstr, sizeof(cstr) - 1)
+
+static inline ConstStringView SmallString_ConstView(const SmallString* this);
+static inline SmallString* SmallString_AppendFormat(SmallString* this, const char* format, ...);
+static inline SmallString* 
+SmallString_AppendVFormat(SmallString* this, const char* format, va_list args);
+
 #define String_IsEqualLiteral(this, cstr) \
-    ((this)->Length == sizeof(cstr) - 1 && memcmp((this)->Data, cstr, sizeof(cstr) - 1) == 0)
+    StringSearch_Equals((this)->Data, (this)->Length, cstr, sizeof(cstr) - 1)
 
 #define StringView_IsEqualLiteral(this, cstr) String_IsEqualLiteral(this, cstr)
 #define ConstStringView_IsEqualLiteral(this, cstr) String_IsEqualLiteral(this, cstr)
@@ -60,7 +114,42 @@ static inline String* String_AppendVFormat(String* this, const char* format, va_
 #define ConstStringView_FromLiteral(cstr) ConstStringView_Create(cstr, sizeof(cstr) - 1)
 
 #define StringLikeEqual(strA, strB) \
-    ((strA).Length == (strB).Length && memcmp((strA).Data, (strB).Data, (strA).Length) == 0)
+    StringSearch_Equals((strA).Data, (strA).Length, (strB).Data, (strB).Length)
+
+//Find functions return the index of the first match, `this->Length` if not found
+static inline uint64_t ConstStringView_FindChar(const ConstStringView* this, char c);
+static inline uint64_t 
+ConstStringView_FindAnyOf(const ConstStringView* this, const StringCharSet* charSet);
+static inline uint64_t 
+ConstStringView_FindSubstring(const ConstStringView* this, ConstStringView needle);
+
+static inline bool ConstStringView_Equals(const ConstStringView* this, ConstStringView other);
+static inline bool ConstStringView_StartsWith(const ConstStringView* this, ConstStringView prefix);
+static inline bool ConstStringView_EndsWith(const ConstStringView* this, ConstStringView suffix);
+
+#define ConstStringView_StartsWithLiteral(this, cstr) \
+    ConstStringView_StartsWith(this, ConstStringView_FromLiteral(cstr))
+
+#define ConstStringView_EndsWithLiteral(this, cstr) \
+    ConstStringView_EndsWith(this, ConstStringView_FromLiteral(cstr))
+
+//Iterates the fields of a view separated by `Delimiter`. A delimiter at the very end doesn't 
+//produce an empty field, so "a,b," and "a,b" both give "a" and "b". 
+//With `TrimCarriageReturn`, a '\r' before each delimiter is dropped, for splitting "\r\n" lines.
+typedef struct
+{
+    ConstStringView Remaining;
+    char Delimiter;
+    bool TrimCarriageReturn;
+} StringSplitter;
+
+static inline StringSplitter StringSplitter_Create(ConstStringView view, char delimiter);
+
+//Splits on '\n' and trims '\r' before it
+static inline StringSplitter StringSplitter_CreateLines(ConstStringView view);
+
+//Returns false when there are no more fields
+static inline bool StringSplitter_Next(StringSplitter* this, ConstStringView* outField);
 
 
 //=======================================================================================
@@ -73,6 +162,9 @@ static inline ConstStringView StringUnion_GetConstView(const StringUnion* this)
     if(!this)
         return (ConstStringView){0};
     
+    if(this->Type == TU_TYPE_S(SmallString))
+        return SmallString_ConstView(&this->TU_DATA_S(SmallString));
+    
     return  this->Type == TU_TYPE_S(String) ?
             ConstStringView_Create(this->TU_DATA_S(String).Data, this->TU_DATA_S(String).Length) :
             this->TU_DATA_S(ConstStringView);
@@ -118,11 +210,19 @@ static inline String* String_AppendVFormat(String* this, const char* format, va_
     va_list args2;
     va_copy(args2, args);
     
-    int writeLen = vsnprintf(NULL, 0, format, args);
+    //Format straight into the spare capacity first and only format again if it didn't fit
+    uint64_t oldLen = this->Length;
+    uint64_t spare = this->Data ? this->Cap - oldLen : 0;
+    int writeLen = vsnprintf(this->Data ? this->Data + oldLen : NULL, spare, format, args);
     if(writeLen <= 0)
         goto exitPoint;
     
-    uint32_t oldLen = this->Length;
+    if((uint64_t)writeLen < spare)
+    {
+        this->Length = oldLen + writeLen;
+        goto exitPoint;
+    }
+    
     String_Resize(this, this->Length + writeLen + 1);
     if(!this->Data || this->Length == oldLen)
         goto exitPoint;
@@ -136,4 +236,169 @@ static inline String* String_AppendVFormat(String* this, const char* format, va_
     return this;
 }
 
+static inline String* String_AppendInt(String* this, int64_t value)
+{
+    char buffer[NUMBER_FORMAT_MAX_LENGTH];
+    return String_AddRange(this, buffer, NumberFormat_Int(buffer, value));
+}
+
+static inline String* String_AppendUInt(String* this, uint64_t value)
+{
+    char buffer[NUMBER_FORMAT_MAX_LENGTH];
+    return String_AddRange(this, buffer, NumberFormat_UInt(buffer, value));
+}
+
+static inline String* String_AppendHex(String* this, uint64_t value)
+{
+    char buffer[NUMBER_FORMAT_MAX_LENGTH];
+    return String_AddRange(this, buffer, NumberFormat_Hex(buffer, value));
+}
+
+static inline String* String_AppendDouble(String* this, double value)
+{
+    char buffer[NUMBER_FORMAT_MAX_LENGTH];
+    return String_AddRange(this, buffer, NumberFormat_Double(buffer, value));
+}
+
+static inline SmallString 
+SmallString_FromData(Allocator allocator, const char* data, uint64_t length)
+{
+    SmallString retStr = SmallString_Create(allocator, length);
+    SmallString_AddRange(&retStr, data, length);
+    return retStr;
+}
+
+static inline ConstStringView SmallString_ConstView(const SmallString* this)
+{
+    if(!this)
+        return (ConstStringView){0};
+    return ConstStringView_Create(SmallString_ConstData(this), this->Length);
+}
+
+static inline SmallString* SmallString_AppendFormat(SmallString* this, const char* format, ...)
+{
+    va_list args1;
+    va_start(args1, format);
+    SmallString_AppendVFormat(this, format, args1);
+    va_end(args1);
+    return this;
+}
+
+static inline SmallString* 
+SmallString_AppendVFormat(SmallString* this, const char* format, va_list args)
+{
+    if(!this)
+        return this;
+    
+    va_list args2;
+    va_copy(args2, args);
+    
+    //Format straight into the spare capacity, which is usually enough for short strings
+    uint64_t oldLen = this->Length;
+    uint64_t cap = SmallString_IsInline(this) ? SMALL_STRING_INLINE_CAP : this->Cap;
+    int writeLen = vsnprintf(SmallString_Data(this) + oldLen, cap - oldLen, format, args);
+    if(writeLen <= 0)
+        goto exitPoint;
+    
+    if(oldLen + writeLen < cap)
+    {
+        this->Length = oldLen + writeLen;
+        goto exitPoint;
+    }
+    
+    //Didn't fit (vsnprintf also needs space for the null terminator), grow and format again
+    SmallString_Resize(this, oldLen + writeLen + 1);
+    if(this->Length == oldLen)
+        goto exitPoint;
+    
+    vsnprintf(SmallString_Data(this) + oldLen, writeLen + 1, format, args2);
+    SmallString_Resize(this, this->Length - 1);
+    
+    exitPoint:;
+    va_end(args2);
+    
+    return this;
+}
+
+static inline uint64_t ConstStringView_FindChar(const ConstStringView* this, char c)
+{
+    if(!this)
+        return 0;
+    return StringSearch_FindChar(this->Data, this->Length, c);
+}
+
+static inline uint64_t 
+ConstStringView_FindAnyOf(const ConstStringView* this, const StringCharSet* charSet)
+{
+    if(!this)
+        return 0;
+    return StringSearch_FindAnyOf(this->Data, this->Length, charSet);
+}
+
+static inline uint64_t 
+ConstStringView_FindSubstring(const ConstStringView* this, ConstStringView needle)
+{
+    if(!this)
+        return 0;
+    return StringSearch_FindSubstring(this->Data, this->Length, needle.Data, needle.Length);
+}
+
+static inline bool ConstStringView_Equals(const ConstStringView* this, ConstStringView other)
+{
+    if(!this)
+        return false;
+    return StringSearch_Equals(this->Data, this->Length, other.Data, other.Length);
+}
+
+static inline bool ConstStringView_StartsWith(const ConstStringView* this, ConstStringView prefix)
+{
+    if(!this || this->Length < prefix.Length)
+        return false;
+    return StringSearch_Equals(this->Data, prefix.Length, prefix.Data, prefix.Length);
+}
+
+static inline bool ConstStringView_EndsWith(const ConstStringView* this, ConstStringView suffix)
+{
+    if(!this || this->Length < suffix.Length)
+        return false;
+    return StringSearch_Equals( this->Data + this->Length - suffix.Length, 
+                                suffix.Length, 
+                                suffix.Data, 
+                                suffix.Length);
+}
+
+static inline StringSplitter StringSplitter_Create(ConstStringView view, char delimiter)
+{
+    return (StringSplitter){ .Remaining = view, .Delimiter = delimiter };
+}
+
+static inline StringSplitter StringSplitter_CreateLines(ConstStringView view)
+{
+    return (StringSplitter){ .Remaining = view, .Delimiter = '\n', .TrimCarriageReturn = true };
+}
+
+static inline bool StringSplitter_Next(StringSplitter* this, ConstStringView* outField)
+{
+    if(!this || !outField || this->Remaining.Length == 0)
+        return false;
+    
+    const char* fieldStart = this->Remaining.Data;
+    uint64_t fieldLength = ConstStringView_FindChar(&this->Remaining, this->Delimiter);
+    
+    //Skip the delimiter as well if there is one
+    if(fieldLength < this->Remaining.Length)
+    {
+        this->Remaining.Data += fieldLength + 1;
+        this->Remaining.Length -= fieldLength + 1;
+    }
+    else
+        this->Remaining = (ConstStringView){0};
+    
+    if(this->TrimCarriageReturn && fieldLength > 0 && fieldStart[fieldLength - 1] == '\r')
+        --fieldLength;
+    
+    *outField = (ConstStringView){ .Data = fieldStart, .Length = fieldLength };
+    return true;
+}
+
 #endif
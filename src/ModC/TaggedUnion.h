@@ -12,6 +12,12 @@ Define `TU_NAME` for the name of the tagged union.
 Define `VALUE_TYPES` for types of the tagged union. This is comma separated.
 Pointers need to be typedef to be passed to `VALUE_TYPES`.
 
+Define `TU_TAG_TYPE` optionally for the integer type of `.Type`, like `uint8_t`. Default is 
+`<TU_NAME>Index`. Switches on a non enum tag don't get the missing case warnings.
+
+A smaller tag only saves memory if the union doesn't round back up to the alignment of its values.
+Unions of 8 byte aligned values like StringUnion stay the same size, check with the macros below.
+
 Then include this file
 
 #### Definitions
@@ -81,6 +87,15 @@ Macro:
 MyUnion myUnion = TU_INIT(MyUnion, int, 5);
 ```
 
+Macro:
+    Use these macros to check the layout
+```c
+//TU_PADDING_SIZE(TaggedUnionName): Bytes that are neither the tag nor the largest value
+//TU_STATIC_ASSERT_SIZE(TaggedUnionName, size): Needs static_assert to be available
+
+TU_STATIC_ASSERT_SIZE(MyUnion, 8);
+```
+
 */
 
 
@@ -98,6 +113,10 @@ MyUnion myUnion = TU_INIT(MyUnion, int, 5);
 
 #define INTERNAL_MODC_FIELD_COUNT MPT_ARGS_COUNT(VALUE_TYPES)
 
+#ifndef TU_TAG_TYPE
+    #define TU_TAG_TYPE MPT_DELAYED_CONCAT( TU_NAME, Index )
+#endif
+
 /*
 Expands to: 
 ```c
@@ -126,6 +145,14 @@ typedef enum MPT_DELAYED_CONCAT( TU_NAME, Index )
     MPT_DELAYED_CONCAT(TU_NAME, _CountIndex)
 } MPT_DELAYED_CONCAT( TU_NAME, Index );
 
+//Fails to compile (division by 0) if the last index doesn't fit in `TU_TAG_TYPE`
+enum
+{
+    MPT_DELAYED_CONCAT(TU_NAME, _TagTypeCheck) = 
+        1 / (int)(  (TU_TAG_TYPE)(MPT_DELAYED_CONCAT(TU_NAME, _CountIndex) - 1) == 
+                    MPT_DELAYED_CONCAT(TU_NAME, _CountIndex) - 1)
+};
+
 
 /*
 Expands to: 
@@ -146,7 +173,7 @@ typedef struct <TU_NAME>
 */
 typedef struct TU_NAME
 {
-    MPT_DELAYED_CONCAT( TU_NAME, Index ) Type;
+    TU_TAG_TYPE Type;
     
     union
     {
@@ -211,8 +238,19 @@ typedef struct TU_NAME
 #define TU_INIT_S(typeName, ... /* value */) \
     TU_INIT(TaggedUnionNameState, typeName, __VA_ARGS__)
 
+#undef TU_PADDING_SIZE
+#define TU_PADDING_SIZE(TaggedUnionName) \
+    (   sizeof(TaggedUnionName) - \
+        sizeof(((TaggedUnionName*)0)->Data) - \
+        sizeof(((TaggedUnionName*)0)->Type))
+
+#undef TU_STATIC_ASSERT_SIZE
+#define TU_STATIC_ASSERT_SIZE(TaggedUnionName, size) \
+    static_assert(sizeof(TaggedUnionName) == (size), #TaggedUnionName " size changed")
+
 
 #undef TU_NAME
 #undef VALUE_TYPES
+#undef TU_TAG_TYPE
 #undef INTERNAL_MODC_FIELD_NAMES
 #undef INTERNAL_MODC_FIELD_COUNT
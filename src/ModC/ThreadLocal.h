@@ -0,0 +1,14 @@
+#ifndef MODC_THREAD_LOCAL_H
+#define MODC_THREAD_LOCAL_H
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+    #define MODC_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+    #define MODC_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+    #define MODC_THREAD_LOCAL __declspec(thread)
+#else
+    #error "Thread local storage needs to be supported"
+#endif
+
+#endif
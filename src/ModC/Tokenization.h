@@ -13,6 +13,7 @@
 #include "static_assert.h/assert.h"
 
 #include <ctype.h>
+#include <inttypes.h>
 #include <stdbool.h>
 
 typedef enum TokenType
@@ -56,15 +57,18 @@ typedef enum CharTokenType
     CharTokenType_Undef = TokenType_Undef,
 } CharTokenType;
 
+//TokenText first so the 4 byte fields pack together after it instead of being padded around it
 typedef struct Token
 {
-    TokenType TokenType;
     StringUnion TokenText;
+    TokenType TokenType;
     int LineIndex;
     int ColumnIndex;
     int SourceIndex;
 } Token;
 
+static_assert(sizeof(Token) == sizeof(StringUnion) + 4 * sizeof(int), "Token has padding");
+
 static inline void Token_Free(Token* this);
 
 #define LIST_NAME TokenList
@@ -102,13 +106,12 @@ static inline String Token_VisualizeLocation(   const Token* this,
     int sourceIndex =   source.Data[this->SourceIndex] == '\n' ? 
                         this->SourceIndex - 1 :
                         this->SourceIndex;
-
+    
     int charAfter = 0;
-    for(int i = sourceIndex; i < source.Length; ++i)
+    if(sourceIndex >= 0)
     {
-        if(source.Data[i] == '\n')
-            break;
-        ++charAfter;
+        ConstStringView lineRest = ConstStringView_Slice(&source, sourceIndex, source.Length);
+        charAfter = ConstStringView_FindChar(&lineRest, '\n');
     }
     
     int charBefore = 0;
@@ -151,6 +154,11 @@ static inline void Token_Free(Token* this)
 {
     if(!this)
         return;
+    if(this->TokenText.Type == TU_TYPE_S(SmallString))
+    {
+        SmallString_Free(&this->TokenText.TU_DATA_S(SmallString));
+        return;
+    }
     if(this->TokenText.Type != TU_TYPE_S(String))
     {
         *this = (Token){0};
@@ -249,6 +257,12 @@ static inline Result_Void Token_AppendChar( Token* this,
         return RESULT_VALUE_S(0);
     }
     
+    if(this->TokenText.Type == TU_TYPE_S(SmallString))
+    {
+        SmallString_AddValue(&this->TokenText.TU_DATA_S(SmallString), c);
+        return RESULT_VALUE_S(0);
+    }
+    
     ConstStringView* tokenView = &this->TokenText.TU_DATA_S(ConstStringView);
     CHECK(  source.Data <= tokenView->Data, 
             ("source: %p, token: %p", source.Data, tokenView->Data),
@@ -268,7 +282,7 @@ static inline Result_Void Token_AppendChar( Token* this,
         String tokenStr = String_Create(allocator, tokenView->Length + 1);
         String_AddRange(&tokenStr, tokenView->Data, tokenView->Length);
         String_AddValue(&tokenStr, c);
-        this->TokenText.TU_DATA_S(String) = tokenStr;
+        this->TokenText = TU_INIT(StringUnion, String, tokenStr);
         return RESULT_VALUE_S(0);
     }
     
@@ -276,6 +290,49 @@ static inline Result_Void Token_AppendChar( Token* this,
     return RESULT_VALUE_S(0);
 }
 
+//Appends `length` chars of `source` starting at `sourceIndex`, the token stays a view if it ends 
+//right before them
+static inline Result_Void Token_AppendSourceRange(  Token* this, 
+                                                    const ConstStringView source, 
+                                                    uint64_t sourceIndex,
+                                                    uint64_t length,
+                                                    Allocator allocator)
+{
+    #undef ResultNameState
+    #define ResultNameState Result_Void
+    
+    CHECK(this != NULL, (""), RET_ERROR_S());
+    CHECK(  sourceIndex + length <= source.Length, 
+            ("sourceIndex: %"PRIu64", length: %"PRIu64, sourceIndex, length),
+            RET_ERROR_S());
+    
+    const char* rangeData = source.Data + sourceIndex;
+    if(this->TokenText.Type == TU_TYPE_S(String))
+    {
+        String_AddRange(&this->TokenText.TU_DATA_S(String), rangeData, length);
+        return RESULT_VALUE_S(0);
+    }
+    
+    if(this->TokenText.Type == TU_TYPE_S(SmallString))
+    {
+        SmallString_AddRange(&this->TokenText.TU_DATA_S(SmallString), rangeData, length);
+        return RESULT_VALUE_S(0);
+    }
+    
+    ConstStringView* tokenView = &this->TokenText.TU_DATA_S(ConstStringView);
+    if(tokenView->Data + tokenView->Length == rangeData)
+    {
+        tokenView->Length += length;
+        return RESULT_VALUE_S(0);
+    }
+    
+    String tokenStr = String_Create(allocator, tokenView->Length + length);
+    String_AddRange(&tokenStr, tokenView->Data, tokenView->Length);
+    String_AddRange(&tokenStr, rangeData, length);
+    this->TokenText = TU_INIT(StringUnion, String, tokenStr);
+    return RESULT_VALUE_S(0);
+}
+
 static inline CharTokenType CharTokenType_FromChar(char c)
 {
     static_assert((int)TokenType_Count == 19, "");
@@ -437,10 +494,15 @@ static inline Result_TokenList Tokenization(const ConstStringView fileContent, A
             MOVE(TokenList, retList, tokenList);
             DEFER_BREAK(0, );
         }
-    
+        
         int currentLineIndex = fileContent.Data[0] == '\n';
         int currentColumnIndex = 1;
         bool lineComment = false;
+        
+        //Chars that need to go through the loop one by one inside comments, everything before 
+        //them is appended in one go. Backslashes are here because of `\<newline>`
+        const StringCharSet lineCommentStops = StringCharSet_FromLiteral("\n\\");
+        const StringCharSet blockCommentStops = StringCharSet_FromLiteral("*/\n\\");
         for(int i = 1; i < fileContent.Length; ++i)
         {
             CharTokenType charTokenType = CharTokenType_FromChar(fileContent.Data[i]);
@@ -468,6 +530,29 @@ static inline Result_TokenList Tokenization(const ConstStringView fileContent, A
                     currentToken.SourceIndex = i; \
                 } while(0)
             
+            //Appends the chars from `i` up to the next char in `stops` (at least 1), and moves `i` 
+            //to the last one appended. None of them are newlines so only the column changes.
+            #define APPEND_CHARS_UNTIL(stops) \
+                do \
+                { \
+                    ConstStringView restView = \
+                        ConstStringView_Slice(&fileContent, i, fileContent.Length); \
+                    uint64_t appendLength = ConstStringView_FindAnyOf(&restView, &(stops)); \
+                    if(appendLength <= 1) \
+                    { \
+                        APPEND_CHAR_TO_TOKEN(); \
+                        break; \
+                    } \
+                    Result_Void voidResult = Token_AppendSourceRange(   &currentToken, \
+                                                                        fileContent, \
+                                                                        i, \
+                                                                        appendLength, \
+                                                                        allocator); \
+                    (void)RESULT_TRY(voidResult, DEFER_BREAK(0, RET_ERROR_S())); \
+                    i += appendLength - 1; \
+                    currentColumnIndex += appendLength - 1; \
+                } while(0)
+            
             #define NEXT_CHAR() \
                 do \
                 { \
@@ -521,7 +606,7 @@ static inline Result_TokenList Tokenization(const ConstStringView fileContent, A
                         CREATE_NEW_TOKEN();
                     }
                     else
-                        APPEND_CHAR_TO_TOKEN();
+                        APPEND_CHARS_UNTIL(lineCommentStops);
                 }
                 //Block comment
                 else
@@ -535,7 +620,7 @@ static inline Result_TokenList Tokenization(const ConstStringView fileContent, A
                         CREATE_NEW_TOKEN();
                     }
                     else
-                        APPEND_CHAR_TO_TOKEN();
+                        APPEND_CHARS_UNTIL(blockCommentStops);
                 }
             }
             
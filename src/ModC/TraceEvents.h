@@ -0,0 +1,329 @@
+#ifndef MODC_TRACE_EVENTS_H
+#define MODC_TRACE_EVENTS_H
+
+/* Docs
+Records spans of work and writes them as Chrome trace events JSON, which can be opened in
+ui.perfetto.dev or chrome://tracing. Requires GCC/Clang `__atomic` builtins.
+
+Recording is off until `TraceEvents_Enable()` or `TraceEvents_WriteJsonAtExit()` is called.
+Until then a span is a load and a branch.
+
+```c
+TraceSpan span = TraceEvents_Begin();
+...
+TraceEvents_EndLiteral(span, "phase", "Tokenize");
+TraceEvents_End(span, "function", nameView.Data, nameView.Length);
+```
+
+Each thread records into its own chunks of events without locking, and only takes a new chunk
+every `TRACE_EVENTS_CHUNK_SIZE` spans. Names are copied and cut to `TRACE_EVENTS_NAME_SIZE - 1`
+chars, so they don't need to outlive the span. Categories need to be string literals.
+
+`PhaseTimer` in PhaseStats.h records a span for each phase as well.
+
+Timestamps use `CLOCK_MONOTONIC`, or `clock()` without it (strict C99 without `_POSIX_C_SOURCE`).
+
+Use `TraceEvents_WriteJson()` to write the spans of all threads, only once none of them are
+recording anymore. `TraceEvents_WriteJsonAtExit()` does that at exit.
+*/
+
+#include "ModC/ThreadLocal.h"
+#include "ModC/Strings/StringBuilder.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef TRACE_EVENTS_CHUNK_SIZE
+    #define TRACE_EVENTS_CHUNK_SIZE 1024
+#endif
+
+#ifndef TRACE_EVENTS_NAME_SIZE
+    #define TRACE_EVENTS_NAME_SIZE 48
+#endif
+
+typedef struct TraceSpan
+{
+    uint64_t StartNs;                   //0 if not recording
+} TraceSpan;
+
+typedef struct TraceEvent
+{
+    uint64_t StartNs;
+    uint64_t DurationNs;
+    const char* Category;
+    char Name[TRACE_EVENTS_NAME_SIZE];
+} TraceEvent;
+
+typedef struct TraceEventsChunk TraceEventsChunk;
+struct TraceEventsChunk
+{
+    TraceEventsChunk* Next;
+    uint32_t Count;
+    TraceEvent Events[TRACE_EVENTS_CHUNK_SIZE];
+};
+
+//Only accessed by the owning thread until written out
+typedef struct TraceEventsThread TraceEventsThread;
+struct TraceEventsThread
+{
+    TraceEventsThread* Next;            //All threads that recorded, push only
+    TraceEventsChunk* FirstChunk;
+    TraceEventsChunk* CurrentChunk;
+    uint32_t ThreadId;
+    char ThreadName[TRACE_EVENTS_NAME_SIZE];
+};
+
+static bool TraceEvents_Enabled = false;                //Atomic
+static uint64_t TraceEvents_OriginNs = 0;
+static TraceEventsThread* TraceEvents_Threads = NULL;   //Atomic
+static uint32_t TraceEvents_ThreadsCount = 0;           //Atomic
+static const char* TraceEvents_ExitPath = NULL;
+static MODC_THREAD_LOCAL TraceEventsThread* TraceEvents_CurrentThread = NULL;
+
+static inline uint64_t TraceEvents_NowNs(void);
+
+static inline void TraceEvents_Enable(void);
+static inline bool TraceEvents_IsEnabled(void);
+
+static inline TraceSpan TraceEvents_Begin(void);
+static inline void TraceEvents_End( TraceSpan span,
+                                    const char* category,
+                                    const char* name,
+                                    uint64_t nameLength);
+
+#define TraceEvents_EndLiteral(span, category, name) \
+    TraceEvents_End(span, category, name, sizeof(name) - 1)
+
+//Names the calling thread in the trace, instead of "Thread <id>". Does nothing if not recording
+static inline void TraceEvents_SetThreadName(const char* name);
+
+static inline bool TraceEvents_WriteJson(FILE* file);
+
+//`path` must outlive the program. Enables recording
+static inline void TraceEvents_WriteJsonAtExit(const char* path);
+
+
+//=======================================================================================
+//Implementations
+//=======================================================================================
+static inline uint64_t TraceEvents_NowNs(void)
+{
+    #if defined(CLOCK_MONOTONIC)
+        struct timespec currentTime;
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        return (uint64_t)currentTime.tv_sec * 1000000000ull + (uint64_t)currentTime.tv_nsec;
+    #else
+        return (uint64_t)((double)clock() * (1000000000.0 / (double)CLOCKS_PER_SEC));
+    #endif
+}
+
+static inline void TraceEvents_Enable(void)
+{
+    if(TraceEvents_IsEnabled())
+        return;
+    
+    //Timestamps start from here so the trace doesn't begin at the system uptime
+    TraceEvents_OriginNs = TraceEvents_NowNs() - 1;
+    __atomic_store_n(&TraceEvents_Enabled, true, __ATOMIC_RELEASE);
+}
+
+static inline bool TraceEvents_IsEnabled(void)
+{
+    return __atomic_load_n(&TraceEvents_Enabled, __ATOMIC_ACQUIRE);
+}
+
+static inline TraceSpan TraceEvents_Begin(void)
+{
+    if(!TraceEvents_IsEnabled())
+        return (TraceSpan){0};
+    
+    return (TraceSpan){ .StartNs = TraceEvents_NowNs() - TraceEvents_OriginNs };
+}
+
+static inline TraceEventsThread* TraceEvents_InternGetThread(void)
+{
+    if(TraceEvents_CurrentThread)
+        return TraceEvents_CurrentThread;
+    
+    TraceEventsThread* thread = calloc(1, sizeof(TraceEventsThread));
+    if(!thread)
+        return NULL;
+    
+    thread->ThreadId = __atomic_add_fetch(&TraceEvents_ThreadsCount, 1, __ATOMIC_RELAXED);
+    thread->Next = __atomic_load_n(&TraceEvents_Threads, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n( &TraceEvents_Threads,
+                                        &thread->Next,
+                                        thread,
+                                        true,
+                                        __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED))
+    {
+    }
+    
+    TraceEvents_CurrentThread = thread;
+    return thread;
+}
+
+static inline void TraceEvents_InternCopyName(  char* outName,
+                                                const char* name,
+                                                uint64_t nameLength)
+{
+    if(nameLength > TRACE_EVENTS_NAME_SIZE - 1)
+        nameLength = TRACE_EVENTS_NAME_SIZE - 1;
+    if(nameLength)
+        memcpy(outName, name, nameLength);
+    outName[nameLength] = '\0';
+}
+
+static inline void TraceEvents_End( TraceSpan span,
+                                    const char* category,
+                                    const char* name,
+                                    uint64_t nameLength)
+{
+    if(span.StartNs == 0)
+        return;
+    
+    const uint64_t endNs = TraceEvents_NowNs() - TraceEvents_OriginNs;
+    TraceEventsThread* thread = TraceEvents_InternGetThread();
+    if(!thread)
+        return;
+    
+    TraceEventsChunk* chunk = thread->CurrentChunk;
+    if(!chunk || chunk->Count == TRACE_EVENTS_CHUNK_SIZE)
+    {
+        TraceEventsChunk* newChunk = malloc(sizeof(TraceEventsChunk));
+        if(!newChunk)
+            return;
+        
+        newChunk->Next = NULL;
+        newChunk->Count = 0;
+        if(chunk)
+            chunk->Next = newChunk;
+        else
+            thread->FirstChunk = newChunk;
+        thread->CurrentChunk = chunk = newChunk;
+    }
+    
+    TraceEvent* event = &chunk->Events[chunk->Count++];
+    event->StartNs = span.StartNs;
+    event->DurationNs = endNs - span.StartNs;
+    event->Category = category;
+    TraceEvents_InternCopyName(event->Name, name, nameLength);
+}
+
+static inline void TraceEvents_SetThreadName(const char* name)
+{
+    if(!TraceEvents_IsEnabled())
+        return;
+    
+    TraceEventsThread* thread = TraceEvents_InternGetThread();
+    if(thread && name)
+        TraceEvents_InternCopyName(thread->ThreadName, name, strlen(name));
+}
+
+static inline void TraceEvents_InternAppendJsonString(StringBuilder* outBuilder, const char* str)
+{
+    StringBuilder_AppendChar(outBuilder, '"');
+    for(; *str; ++str)
+    {
+        const unsigned char c = (unsigned char)*str;
+        if(c == '"' || c == '\\')
+        {
+            StringBuilder_AppendChar(outBuilder, '\\');
+            StringBuilder_AppendChar(outBuilder, (char)c);
+        }
+        else if(c < 0x20)
+            StringBuilder_AppendFormat(outBuilder, "\\u%04x", (unsigned)c);
+        else
+            StringBuilder_AppendChar(outBuilder, (char)c);
+    }
+    StringBuilder_AppendChar(outBuilder, '"');
+}
+
+//Trace event timestamps are in microseconds
+static inline void TraceEvents_InternAppendMicroseconds(StringBuilder* outBuilder, uint64_t ns)
+{
+    StringBuilder_AppendUInt(outBuilder, ns / 1000);
+    StringBuilder_AppendFormat(outBuilder, ".%03u", (unsigned)(ns % 1000));
+}
+
+static inline bool TraceEvents_WriteJson(FILE* file)
+{
+    if(!file)
+        return false;
+    
+    StringBuilder builder = StringBuilder_Create(CreateHeapAllocator(), 0);
+    StringBuilder_AppendLiteral(&builder, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    
+    bool first = true;
+    TraceEventsThread* thread = __atomic_load_n(&TraceEvents_Threads, __ATOMIC_ACQUIRE);
+    for(; thread; thread = thread->Next)
+    {
+        //Thread name metadata
+        if(!first)
+            StringBuilder_AppendChar(&builder, ',');
+        StringBuilder_AppendChar(&builder, '\n');
+        first = false;
+        StringBuilder_AppendLiteral(&builder, "{\"name\": \"thread_name\", \"ph\": \"M\", ");
+        StringBuilder_AppendLiteral(&builder, "\"pid\": 1, \"tid\": ");
+        StringBuilder_AppendUInt(&builder, thread->ThreadId);
+        StringBuilder_AppendLiteral(&builder, ", \"args\": {\"name\": ");
+        if(thread->ThreadName[0])
+            TraceEvents_InternAppendJsonString(&builder, thread->ThreadName);
+        else
+            StringBuilder_AppendFormat(&builder, "\"Thread %u\"", (unsigned)thread->ThreadId);
+        StringBuilder_AppendLiteral(&builder, "}}");
+        
+        for(TraceEventsChunk* chunk = thread->FirstChunk; chunk; chunk = chunk->Next)
+        {
+            for(uint32_t i = 0; i < chunk->Count; ++i)
+            {
+                const TraceEvent* event = &chunk->Events[i];
+                StringBuilder_AppendLiteral(&builder, ",\n{\"name\": ");
+                TraceEvents_InternAppendJsonString(&builder, event->Name);
+                StringBuilder_AppendLiteral(&builder, ", \"cat\": ");
+                TraceEvents_InternAppendJsonString( &builder, 
+                                                    event->Category ? event->Category : "");
+                StringBuilder_AppendLiteral(&builder, ", \"ph\": \"X\", \"ts\": ");
+                TraceEvents_InternAppendMicroseconds(&builder, event->StartNs);
+                StringBuilder_AppendLiteral(&builder, ", \"dur\": ");
+                TraceEvents_InternAppendMicroseconds(&builder, event->DurationNs);
+                StringBuilder_AppendLiteral(&builder, ", \"pid\": 1, \"tid\": ");
+                StringBuilder_AppendUInt(&builder, thread->ThreadId);
+                StringBuilder_AppendChar(&builder, '}');
+            }
+        }
+    }
+    StringBuilder_AppendLiteral(&builder, "\n]}\n");
+    
+    bool succeeded = StringBuilder_WriteToFile(&builder, file);
+    StringBuilder_Free(&builder);
+    return succeeded;
+}
+
+static inline void TraceEvents_InternWriteJsonAtExit(void)
+{
+    FILE* file = fopen(TraceEvents_ExitPath, "w");
+    if(!file)
+        return;
+    TraceEvents_WriteJson(file);
+    fclose(file);
+}
+
+static inline void TraceEvents_WriteJsonAtExit(const char* path)
+{
+    if(!path)
+        return;
+    
+    bool registered = TraceEvents_ExitPath != NULL;
+    TraceEvents_ExitPath = path;
+    if(!registered)
+        atexit(TraceEvents_InternWriteJsonAtExit);
+    TraceEvents_Enable();
+}
+
+#endif
@@ -4,9 +4,10 @@ set -e
 ModCScriptDir="$(dirname "$0")"
 ModCRepoRoot="${ModCScriptDir}/../.."
 
-ModCFlags="-std=c99 -Wall -Wextra -Wpedantic -Werror -Wno-sign-compare -fsanitize=undefined -g3"
+# _DEFAULT_SOURCE exposes mmap() flags for virtual arenas
+ModCFlags="-std=c99 -D_DEFAULT_SOURCE -Wall -Wextra -Wpedantic -Werror -Wno-sign-compare -fsanitize=undefined -g3"
 
-ModCIncludes="-I${ModCRepoRoot}/External -I${ModCRepoRoot}/External/uthash/src -I${ModCRepoRoot}/src"
+ModCIncludes="-I${ModCRepoRoot}/External -I${ModCRepoRoot}/src"
 
 # Preprocessor output
 # gcc ${ModCFlags} -E -P ${ModCIncludes} "${ModCScriptDir}/main.c" -o "${ModCScriptDir}/main.i"
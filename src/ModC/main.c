@@ -4,8 +4,11 @@
 #include "ModC/Defer.h"
 #include "ModC/GenericContainers.h"
 #include "ModC/Strings/Strings.h"
+#include "ModC/Strings/StringBuilder.h"
 #include "ModC/Tokenization.h"
 #include "ModC/Classification.h"
+#include "ModC/PhaseStats.h"
+#include "ModC/TraceEvents.h"
 
 //Dependencies
 #include "static_assert.h/assert.h"
@@ -60,20 +63,53 @@ Result_Void Main(int argc, char* argv[])
     FILE* modcFile = NULL;
     Allocator mainArena;
     Allocator statementListArena;
-    String fileContent;
-    String printString;
+    Allocator scratchArena;
+    AlignedString fileContent;
+    StringBuilder printBuilder;
+    
+    //Time of each phase for `--stats`, written to stderr so the dump is unchanged
+    const char* pathArg = NULL;
+    bool printStats = false;
+    PhaseStatsFormat statsFormat = PhaseStatsFormat_Text;
+    PhaseStats phases[4];
+    uint32_t phasesCount = 0;
+    PhaseTimer phaseTimer;
     
     DEFER_SCOPE_START(0)
     {
-        if(argc == 1)
+        for(int i = 1; i < argc; ++i)
+        {
+            if(strcmp(argv[i], "--stats") == 0)
+                printStats = true;
+            else if(strcmp(argv[i], "--stats=json") == 0)
+            {
+                printStats = true;
+                statsFormat = PhaseStatsFormat_Json;
+            }
+            //Chrome trace events, written at exit
+            else if(strcmp(argv[i], "--trace") == 0)
+                TraceEvents_WriteJsonAtExit("trace.json");
+            else if(strncmp(argv[i], "--trace=", sizeof("--trace=") - 1) == 0)
+                TraceEvents_WriteJsonAtExit(argv[i] + sizeof("--trace=") - 1);
+            else
+                pathArg = argv[i];
+        }
+        
+        if(!pathArg)
         {
-            printf("Usage: %s <path>\n", argv[0]);
+            printf( "Usage: %s [--stats | --stats=json] [--trace | --trace=<path>] <path>\n", 
+                    argv[0]);
             DEFER_BREAK(0, return RESULT_VALUE_S(0));
         }
         
-        StringView filePath = StringView_Create(argv[1], strlen(argv[1]));
+        StringView filePath = StringView_Create((char*)pathArg, strlen(pathArg));
         printf("Compiling %s\n", filePath.Data);
         
+        TraceEvents_SetThreadName("Main");
+        TraceSpan fileSpan = TraceEvents_Begin();
+        DEFER(0, TraceEvents_End(fileSpan, "file", filePath.Data, filePath.Length));
+        
+        phaseTimer = PhaseTimer_Start();
         modcFile = fopen(filePath.Data, "r");
         if(!modcFile)
             DEFER_BREAK(0, return ERROR_STR_FMT_S(("Failed to open file: %s", strerror(errno))));
@@ -91,40 +127,72 @@ Result_Void Main(int argc, char* argv[])
         }
         
         fseek(modcFile, 0, 0);
-        mainArena = CreateArenaAllocator(fileSize);
+        //File content and tokens keep growing, so reserve plenty and let the pages commit as needed.
+        //Fall back to chained arenas if virtual memory is not available.
+        mainArena = CreateVirtualArenaAllocator((uint64_t)fileSize * 64 + (64 << 20), false);
+        if(!mainArena.Allocator)
+            mainArena = CreateArenaAllocator(fileSize);
+        CHECK(mainArena.Allocator != NULL, ("Failed to allocate"), DEFER_BREAK(0, RET_ERROR_S()));
         DEFER(0, Allocator_Destroy(&mainArena));
+        Allocator_SetProfileName(&mainArena, "Main");
         
-        fileContent = String_Create(Allocator_Share(&mainArena), fileSize);
-        String_Resize(&fileContent, fileSize);
+        //Aligned with readable tail padding so the lexer can scan with vector loads
+        fileContent = AlignedString_Create(Allocator_Share(&mainArena), fileSize);
+        AlignedString_Resize(&fileContent, fileSize);
         CHECK(fileContent.Length == fileSize, "", DEFER_BREAK(0, RET_ERROR_S()));
         
         uint32_t actuallyRead = fread(fileContent.Data, 1, fileSize, modcFile);
         CHECK(  actuallyRead == fileSize, 
                 (" actuallyRead: %"PRIu64", fileSize: %"PRIi64, actuallyRead, fileSize),
                 DEFER_BREAK(0, RET_ERROR_S()));
-    
+        
+        phases[phasesCount] = PhaseTimer_Stop(&phaseTimer, "Read");
+        phases[phasesCount++].InputBytes = fileSize;
+        phaseTimer = PhaseTimer_Start();
+        
         ConstStringView sourceView = ConstStringView_Create(fileContent.Data, fileContent.Length);
         Result_TokenList tokenListResult = Tokenization(sourceView, Allocator_Share(&mainArena));
         TokenList* tokenList = RESULT_TRY(tokenListResult, DEFER_BREAK(0, RET_ERROR_S()));
         
         DEFER(0, TokenList_Free(tokenList));
+        phases[phasesCount] = PhaseTimer_Stop(&phaseTimer, "Tokenize");
+        phases[phasesCount].InputBytes = fileSize;
+        phases[phasesCount].ItemsCount = tokenList->Length;
+        phases[phasesCount++].ItemsName = "tokens";
         
+        //Build the whole dump and write it out once, even if we fail halfway
+        printBuilder = StringBuilder_Create(Allocator_Share(&mainArena), 0);
+        DEFER(0, StringBuilder_WriteToFile(&printBuilder, stdout));
         for(int i = 0; i < tokenList->Length; ++i)
         {
             ConstStringView typeStr = TokenType_ToCStr(tokenList->Data[i].TokenType);
             ConstStringView tokenTextView = Token_TokenTextView(&tokenList->Data[i]);
-            printf( "Token: \"%.*s\", Token Type[%i]: %.*s\n", 
-                    (int)tokenTextView.Length, tokenTextView.Data,
-                    i, 
-                    (int)typeStr.Length, typeStr.Data);
+            StringBuilder_AppendLiteral(&printBuilder, "Token: \"");
+            StringBuilder_AppendView(&printBuilder, tokenTextView);
+            StringBuilder_AppendLiteral(&printBuilder, "\", Token Type[");
+            StringBuilder_AppendInt(&printBuilder, i);
+            StringBuilder_AppendLiteral(&printBuilder, "]: ");
+            StringBuilder_AppendView(&printBuilder, typeStr);
+            StringBuilder_AppendChar(&printBuilder, '\n');
         }
         
+        phaseTimer = PhaseTimer_Start();
         Result_StatementList statementListResult = CreateStatements(tokenList, 
                                                                     sourceView, 
                                                                     Allocator_Share(&mainArena), 
                                                                     &statementListArena);
         StatementList* statementList = RESULT_TRY(statementListResult, DEFER_BREAK(0, RET_ERROR_S()));
         DEFER(0, Allocator_Destroy(&statementListArena));
+        Allocator_SetProfileName(&statementListArena, "Statements");
+        phases[phasesCount] = PhaseTimer_Stop(&phaseTimer, "Statements");
+        phases[phasesCount].ItemsCount = statementList->Length;
+        phases[phasesCount++].ItemsName = "statements";
+        
+        phaseTimer = PhaseTimer_Start();
+        scratchArena = CreateArenaAllocator(4096);
+        CHECK(scratchArena.Allocator != NULL, ("Failed to allocate"), DEFER_BREAK(0, RET_ERROR_S()));
+        DEFER(0, Allocator_Destroy(&scratchArena));
+        Allocator_SetProfileName(&scratchArena, "Scratch");
         
         Result_Void voidResult = 
             CleanAndClassifyStatements( statementList, 
@@ -132,21 +200,34 @@ Result_Void Main(int argc, char* argv[])
                                         Allocator_Share(&statementListArena),
                                         tokenList,
                                         sourceView,
-                                        //TODO: Use scratch arena.
-                                        Allocator_Share(&mainArena));
+                                        Allocator_Share(&scratchArena));
         (void)RESULT_TRY(voidResult, DEFER_BREAK(0, RET_ERROR_S()));
+        phases[phasesCount] = PhaseTimer_Stop(&phaseTimer, "Classify");
+        phases[phasesCount].ItemsCount = statementList->Length;
+        phases[phasesCount++].ItemsName = "statements";
         
-        
-        printString = String_Create(Allocator_Share(&mainArena), 64);
         for(int i = 0; i < statementList->Length; ++i)
         {
-            voidResult = Statement_ToString(&statementList->Data[i], tokenList, &printString, false);
+            StringBuilder_AppendLiteral(&printBuilder, "statementList[");
+            StringBuilder_AppendInt(&printBuilder, i);
+            StringBuilder_AppendLiteral(&printBuilder, "]: ");
+            voidResult = Statement_ToString(StatementList_At(statementList, i), 
+                                            tokenList, 
+                                            &printBuilder);
             (void)RESULT_TRY(voidResult, DEFER_BREAK(0, RET_ERROR_S()));
-            printf("statementList[%i]: " "%.*s\n", i, (int)printString.Length, printString.Data);
+            StringBuilder_AppendChar(&printBuilder, '\n');
         }
     }
     DEFER_SCOPE_END(0)
     
+    if(printStats)
+    {
+        StringBuilder statsBuilder = StringBuilder_Create(CreateHeapAllocator(), 0);
+        PhaseStats_AppendReport(phases, phasesCount, statsFormat, &statsBuilder);
+        StringBuilder_WriteToFile(&statsBuilder, stderr);
+        StringBuilder_Free(&statsBuilder);
+    }
+    
     return RESULT_VALUE_S(0);
 }
 
@@ -154,6 +235,11 @@ int main(int argc, char* argv[])
 {
     (void)argc;
     (void)argv;
+    
+    //No-op unless built with ALLOCATOR_PROFILE
+    AllocatorProfile_WriteJsonAtExit("ModCAllocatorProfile.json");
+    //No-op unless built with ALLOCATOR_TRACE, Benchmarks/AllocReplay.c replays it
+    AllocatorTrace_Start("ModCAllocatorTrace.bin");
     #if 1
     {
         #undef ResultNameState
@@ -168,6 +254,7 @@ int main(int argc, char* argv[])
             String_Free(&resultStr);
         }
         RESULT_FREE_RESOURCE_S(&result);
+        Result_DestroyErrorArena();
     }
     #else
     {